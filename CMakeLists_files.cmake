@@ -51,8 +51,10 @@ list (APPEND MAIN_SOURCE_FILES
   opm/simulators/linalg/FlexibleSolver4.cpp
   opm/simulators/linalg/FlexibleSolver5.cpp
   opm/simulators/linalg/FlexibleSolver6.cpp
+  opm/simulators/linalg/LinearSolverAutoTuner.cpp
   opm/simulators/linalg/MILU.cpp
   opm/simulators/linalg/ParallelIstlInformation.cpp
+  opm/simulators/linalg/PreconditionerReusePolicy.cpp
   opm/simulators/linalg/PropertyTree.cpp
   opm/simulators/linalg/setupPropertyTree.cpp
   opm/simulators/utils/PartiallySupportedFlowKeywords.cpp
@@ -142,7 +144,9 @@ endif()
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
   tests/test_ALQState.cpp
+  tests/test_binarysystemfile.cpp
   tests/test_blackoil_amg.cpp
+  tests/test_blockspmv.cpp
   tests/test_convergencereport.cpp
   tests/test_deferredlogger.cpp
   tests/test_ecl_output.cc
@@ -154,14 +158,21 @@ list (APPEND TEST_SOURCE_FILES
   tests/test_GroupState.cpp
   tests/test_invert.cpp
   tests/test_keyword_validator.cpp
+  tests/test_linearsolverautotuner.cpp
   tests/test_milu.cpp
+  tests/test_mswellumfpack.cpp
   tests/test_multmatrixtransposed.cpp
   tests/test_norne_pvt.cpp
+  tests/test_packedstandardwells.cpp
   tests/test_parallelwellinfo.cpp
   tests/test_preconditionerfactory.cpp
+  tests/test_preconditionerreusepolicy.cpp
   tests/test_relpermdiagnostics.cpp
+  tests/test_reorderedlinearsystem.cpp
+  tests/test_segmenttreesolver.cpp
   tests/test_stoppedwells.cpp
   tests/test_timer.cpp
+  tests/test_trueimpesweights.cpp
   tests/test_vfpproperties.cpp
   tests/test_wellmodel.cpp
   tests/test_wellprodindexcalculator.cpp
@@ -285,6 +296,11 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/simulators/linalg/bda/MultisegmentWellContribution.hpp
   opm/simulators/linalg/bda/WellContributions.hpp
   opm/simulators/linalg/amgcpr.hh
+  opm/simulators/linalg/BISAI.hpp
+  opm/simulators/linalg/BinarySystemFile.hpp
+  opm/simulators/linalg/BlockJacobiILU0.hpp
+  opm/simulators/linalg/BlockSpMV.hpp
+  opm/simulators/linalg/ChowPatelILU0.hpp
   opm/simulators/linalg/twolevelmethodcpr.hh
   opm/simulators/linalg/ExtractParallelGridInformationToISTL.hpp
   opm/simulators/linalg/FlexibleSolver.hpp
@@ -292,18 +308,26 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/simulators/linalg/FlowLinearSolverParameters.hpp
   opm/simulators/linalg/GraphColoring.hpp
   opm/simulators/linalg/ISTLSolverEbos.hpp
+  opm/simulators/linalg/LinearSolverAutoTuner.hpp
   opm/simulators/linalg/MatrixBlock.hpp
   opm/simulators/linalg/MatrixMarketSpecializations.hpp
+  opm/simulators/linalg/MixedPrecisionSolver.hpp
   opm/simulators/linalg/OwningBlockPreconditioner.hpp
   opm/simulators/linalg/OwningTwoLevelPreconditioner.hpp
   opm/simulators/linalg/ParallelOverlappingILU0.hpp
   opm/simulators/linalg/ParallelRestrictedAdditiveSchwarz.hpp
+  opm/simulators/linalg/PersistentHaloExchange.hpp
   opm/simulators/linalg/ParallelIstlInformation.hpp
+  opm/simulators/linalg/PipelinedSolvers.hpp
   opm/simulators/linalg/PressureSolverPolicy.hpp
   opm/simulators/linalg/PressureTransferPolicy.hpp
+  opm/simulators/linalg/PressureTransferKernels.hpp
   opm/simulators/linalg/PreconditionerFactory.hpp
+  opm/simulators/linalg/PreconditionerReusePolicy.hpp
   opm/simulators/linalg/PreconditionerWithUpdate.hpp
   opm/simulators/linalg/PropertyTree.hpp
+  opm/simulators/linalg/RecyclingGMResSolver.hpp
+  opm/simulators/linalg/ReorderedLinearSystem.hpp
   opm/simulators/linalg/WellOperators.hpp
   opm/simulators/linalg/WriteSystemMatrixHelper.hpp
   opm/simulators/linalg/findOverlapRowsAndColumns.hpp
@@ -339,8 +363,10 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/simulators/wells/GlobalWellInfo.hpp
   opm/simulators/wells/GroupState.hpp
   opm/simulators/wells/MSWellHelpers.hpp
+  opm/simulators/wells/MSWellUMFPack.hpp
   opm/simulators/wells/MultisegmentWell.hpp
   opm/simulators/wells/MultisegmentWell_impl.hpp
+  opm/simulators/wells/PackedStandardWells.hpp
   opm/simulators/wells/ParallelWellInfo.hpp
   opm/simulators/wells/PerfData.hpp
   opm/simulators/wells/PerforationData.hpp
@@ -348,6 +374,7 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/simulators/utils/readDeck.hpp
   opm/simulators/wells/RegionAttributeHelpers.hpp
   opm/simulators/wells/RegionAverageCalculator.hpp
+  opm/simulators/wells/SegmentTreeSolver.hpp
   opm/simulators/wells/SingleWellState.hpp
   opm/simulators/wells/StandardWell.hpp
   opm/simulators/wells/StandardWell_impl.hpp
@@ -367,5 +394,9 @@ list (APPEND PUBLIC_HEADER_FILES
   )
 
 list (APPEND EXAMPLE_SOURCE_FILES
+  examples/benchmark_blockspmv.cpp
+  examples/benchmark_impesweights.cpp
+  examples/benchmark_pipelined_krylov.cpp
   examples/printvfp.cpp
+  examples/replay_linear_system.cpp
   )
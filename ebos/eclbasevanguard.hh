@@ -85,12 +85,10 @@ struct EdgeWeightsMethod {
     using type = UndefinedProperty;
 };
 
-#if HAVE_OPENCL
 template<class TypeTag, class MyTypeTag>
 struct NumJacobiBlocks {
     using type = UndefinedProperty;
 };
-#endif  // HAVE_OPENCL
 
 template<class TypeTag, class MyTypeTag>
 struct OwnerCellsFirst {
@@ -141,12 +139,10 @@ struct EdgeWeightsMethod<TypeTag, TTag::EclBaseVanguard> {
     static constexpr int value = 1;
 };
 
-#if HAVE_OPENCL
 template<class TypeTag>
 struct NumJacobiBlocks<TypeTag, TTag::EclBaseVanguard> {
     static constexpr int value = 0;
 };
-#endif // HAVE_OPENCL
 
 template<class TypeTag>
 struct OwnerCellsFirst<TypeTag, TTag::EclBaseVanguard> {
@@ -228,10 +224,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, EdgeWeightsMethod,
                              "Choose edge-weighing strategy: 0=uniform, 1=trans, 2=log(trans).");
 
-#if HAVE_OPENCL
         EWOMS_REGISTER_PARAM(TypeTag, int, NumJacobiBlocks,
-                             "Number of blocks to be created for the Block-Jacobi preconditioner.");
-#endif
+                             "Number of blocks to be created for the Block-Jacobi preconditioner, "
+                             "used by the OpenCL solver and the BlockJacobiILU0 preconditioner.");
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, OwnerCellsFirst,
                              "Order cells owned by rank before ghost/overlap cells.");
@@ -258,9 +253,7 @@ public:
         fileName_ = EWOMS_GET_PARAM(TypeTag, std::string, EclDeckFileName);
         edgeWeightsMethod_   = Dune::EdgeWeightMethod(EWOMS_GET_PARAM(TypeTag, int, EdgeWeightsMethod));
 
-#if HAVE_OPENCL
         numJacobiBlocks_ = EWOMS_GET_PARAM(TypeTag, int, NumJacobiBlocks);
-#endif
 
         ownersFirst_ = EWOMS_GET_PARAM(TypeTag, bool, OwnerCellsFirst);
         serialPartitioning_ = EWOMS_GET_PARAM(TypeTag, bool, SerialPartitioning);
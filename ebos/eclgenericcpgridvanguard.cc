@@ -144,14 +144,12 @@ doLoadBalance_(const Dune::EdgeWeightMethod            edgeWeightsMethod,
         // first cell of a well (e.g. for pressure).  Hence this is now
         // skipped.  Rank 0 had everything even before.
 
-#if HAVE_OPENCL
         if (partitionJacobiBlocks) {
             this->cell_part_ = this->grid_->
                 zoltanPartitionWithoutScatter(&wells, faceTrans.data(),
                                               numJacobiBlocks,
                                               zoltanImbalanceTol);
         }
-#endif // HAVE_OPENCL
     }
 }
 
@@ -205,11 +205,7 @@ public:
      */
     int numJacobiBlocks() const
     {
-#if HAVE_OPENCL
         return numJacobiBlocks_;
-#else
-        return 0;
-#endif
     }
 
     /*!
@@ -276,9 +272,7 @@ protected:
     std::string fileName_;
     Dune::EdgeWeightMethod edgeWeightsMethod_;
 
-#if HAVE_OPENCL
     int numJacobiBlocks_{0};
-#endif  // HAVE_OPENCL
 
     bool ownersFirst_;
     bool serialPartitioning_;
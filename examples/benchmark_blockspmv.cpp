@@ -0,0 +1,125 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Micro-benchmark comparing the block-CSR kernels used by the well model
+// matrix adapters with the generic BCRSMatrix::umv()/usmv() of dune-istl.
+//
+// Usage: benchmark_blockspmv [cells per direction] [repetitions]
+
+#include <config.h>
+
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/BlockSpMV.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+
+/// Build a 7-point stencil matrix on an n x n x n grid with non-trivial blocks.
+template <int N>
+Dune::BCRSMatrix<Opm::MatrixBlock<double, N, N>> buildMatrix(const int n)
+{
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, N, N>>;
+    const int numCells = n * n * n;
+    Matrix A(numCells, numCells, 7 * numCells, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const int cell = row.index();
+        const int i = cell % n;
+        const int j = (cell / n) % n;
+        const int k = cell / (n * n);
+        if (k > 0) row.insert(cell - n * n);
+        if (j > 0) row.insert(cell - n);
+        if (i > 0) row.insert(cell - 1);
+        row.insert(cell);
+        if (i < n - 1) row.insert(cell + 1);
+        if (j < n - 1) row.insert(cell + n);
+        if (k < n - 1) row.insert(cell + n * n);
+    }
+    for (auto row = A.begin(); row != A.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            for (int ii = 0; ii < N; ++ii) {
+                for (int jj = 0; jj < N; ++jj) {
+                    (*col)[ii][jj] = (col.index() == row.index() ? 6.0 : -1.0) + 0.01 * (ii - jj);
+                }
+            }
+        }
+    }
+    return A;
+}
+
+template <class Function>
+double timeIt(const int repetitions, Function&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        f();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repetitions;
+}
+
+template <int N>
+void benchmark(const int n, const int repetitions)
+{
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, N>>;
+    const auto A = buildMatrix<N>(n);
+    Vector x(A.N()), y1(A.N()), y2(A.N());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = 1.0 + 1e-3 * (i % 101);
+    }
+    y1 = 0.0;
+    y2 = 0.0;
+    const double alpha = -0.5;
+
+    const double duneTime = timeIt(repetitions, [&]() { A.usmv(alpha, x, y1); });
+    const double kernelTime = timeIt(repetitions, [&]() { Opm::blockSpMVScaleAdd(alpha, A, x, y2, A.N()); });
+
+    auto diff = y1;
+    diff -= y2;
+
+    std::cout << "block size " << N
+              << "  rows " << A.N()
+              << "  dune usmv " << std::setw(10) << duneTime * 1e3 << " ms"
+              << "  blockSpMVScaleAdd " << std::setw(10) << kernelTime * 1e3 << " ms"
+              << "  speedup " << std::setw(6) << duneTime / kernelTime
+              << "  max difference " << diff.infinity_norm() << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 60;
+    const int repetitions = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    benchmark<1>(n, repetitions);
+    benchmark<2>(n, repetitions);
+    benchmark<3>(n, repetitions);
+    benchmark<4>(n, repetitions);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Micro-benchmark comparing the cost of the quasi-IMPES weights used by
+// CPR with the cost of setting up an AMG hierarchy for the pressure system.
+//
+// Usage: benchmark_impesweights [cells per direction] [repetitions]
+
+#include <config.h>
+
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/getQuasiImpesWeights.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+/// Build a 7-point stencil matrix on an n x n x n grid with non-trivial blocks.
+template <class Block>
+Dune::BCRSMatrix<Block> buildMatrix(const int n)
+{
+    using Matrix = Dune::BCRSMatrix<Block>;
+    constexpr int N = Block::rows;
+    const int numCells = n * n * n;
+    Matrix A(numCells, numCells, 7 * numCells, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const int cell = row.index();
+        const int i = cell % n;
+        const int j = (cell / n) % n;
+        const int k = cell / (n * n);
+        if (k > 0) row.insert(cell - n * n);
+        if (j > 0) row.insert(cell - n);
+        if (i > 0) row.insert(cell - 1);
+        row.insert(cell);
+        if (i < n - 1) row.insert(cell + 1);
+        if (j < n - 1) row.insert(cell + n);
+        if (k < n - 1) row.insert(cell + n * n);
+    }
+    for (auto row = A.begin(); row != A.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            for (int ii = 0; ii < N; ++ii) {
+                for (int jj = 0; jj < N; ++jj) {
+                    (*col)[ii][jj] = (col.index() == row.index() ? 6.0 : -1.0) * (ii == jj ? 1.0 : 0.1)
+                        + 0.01 * (ii - jj) * (1 + row.index() % 5);
+                }
+            }
+        }
+    }
+    return A;
+}
+
+template <class Function>
+double timeIt(const int repetitions, Function&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        f();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repetitions;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 60;
+    const int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, 3, 3>>;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 3>>;
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1>>;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<double, 1>>;
+
+    const auto A = buildMatrix<Opm::MatrixBlock<double, 3, 3>>(n);
+    const auto P = buildMatrix<Dune::FieldMatrix<double, 1, 1>>(n);
+    const int pressureIndex = 1;
+
+    Vector weights(A.N());
+    std::vector<std::size_t> diagonalOffsets;
+    const double firstTime = timeIt(1, [&]() {
+        Opm::Amg::getQuasiImpesWeights(A, pressureIndex, false, weights, diagonalOffsets);
+    });
+    const double cachedTime = timeIt(repetitions, [&]() {
+        Opm::Amg::getQuasiImpesWeights(A, pressureIndex, false, weights, diagonalOffsets);
+    });
+
+    using Operator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using Smoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using Criterion = Dune::Amg::CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal>>;
+    Operator op(P);
+    Criterion criterion(15, 2000);
+    criterion.setDebugLevel(0);
+    typename Dune::Amg::SmootherTraits<Smoother>::Arguments smootherArgs;
+    smootherArgs.iterations = 1;
+    const double amgTime = timeIt(repetitions, [&]() {
+        Dune::Amg::AMG<Operator, PressureVector, Smoother> amg(op, criterion, smootherArgs);
+    });
+
+    std::cout << "cells " << A.N()
+              << "  weights (first call) " << std::setw(10) << firstTime * 1e3 << " ms"
+              << "  weights (cached) " << std::setw(10) << cachedTime * 1e3 << " ms"
+              << "  AMG setup " << std::setw(10) << amgTime * 1e3 << " ms"
+              << "  weights/AMG " << std::setw(8) << cachedTime / amgTime << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Scaling benchmark comparing the standard and the pipelined Krylov
+// solvers of FlexibleSolver. Every process owns an n x n x n block of
+// cells that is decoupled from the blocks of the other processes, so the
+// local work per iteration stays fixed and any growth of the time per
+// iteration with the number of processes is due to the global reductions.
+//
+// Usage: mpirun -np <procs> benchmark_pipelined_krylov [cells per direction] [repetitions]
+
+#include <config.h>
+
+#include <opm/simulators/linalg/FlexibleSolver.hpp>
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/PropertyTree.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/owneroverlapcopy.hh>
+#include <dune/istl/schwarz.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#if HAVE_MPI
+
+namespace
+{
+
+using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, 1, 1>>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 1>>;
+using Comm = Dune::OwnerOverlapCopyCommunication<int, int>;
+using Operator = Dune::OverlappingSchwarzOperator<Matrix, Vector, Vector, Comm>;
+
+/// Build a non-symmetric 7-point stencil matrix on an n x n x n grid.
+Matrix buildMatrix(const int n)
+{
+    const int numCells = n * n * n;
+    Matrix A(numCells, numCells, 7 * numCells, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const int cell = row.index();
+        const int i = cell % n;
+        const int j = (cell / n) % n;
+        const int k = cell / (n * n);
+        if (k > 0) row.insert(cell - n * n);
+        if (j > 0) row.insert(cell - n);
+        if (i > 0) row.insert(cell - 1);
+        row.insert(cell);
+        if (i < n - 1) row.insert(cell + 1);
+        if (j < n - 1) row.insert(cell + n);
+        if (k < n - 1) row.insert(cell + n * n);
+    }
+    for (auto row = A.begin(); row != A.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            const int offset = static_cast<int>(col.index()) - static_cast<int>(row.index());
+            if (offset == 0) {
+                *col = 6.05;
+            } else {
+                // Upwind-like asymmetry in the x-direction.
+                *col = offset == -1 ? -1.5 : (offset == 1 ? -0.5 : -1.0);
+            }
+        }
+    }
+    return A;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const int n = argc > 1 ? std::atoi(argv[1]) : 30;
+    const int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const auto A = buildMatrix(n);
+    const int numCells = A.N();
+
+    // Every process owns all of its cells, there are no overlap or copy cells.
+    Comm comm(mpiHelper.getCommunicator());
+    using LocalIndex = Dune::ParallelLocalIndex<Dune::OwnerOverlapCopyAttributeSet::AttributeSet>;
+    comm.indexSet().beginResize();
+    for (int cell = 0; cell < numCells; ++cell) {
+        comm.indexSet().add(mpiHelper.rank() * numCells + cell,
+                            LocalIndex(cell, Dune::OwnerOverlapCopyAttributeSet::owner, true));
+    }
+    comm.indexSet().endResize();
+    comm.remoteIndices().rebuild<false>();
+
+    Operator op(A, comm);
+    const std::function<void(Vector&)> weightsCalculator;
+
+    for (const std::string solver : {"bicgstab", "pipelined_bicgstab", "gmres", "pipelined_gmres"}) {
+        Opm::PropertyTree prm;
+        prm.put("tol", 1e-8);
+        prm.put("maxiter", 1000);
+        prm.put("verbosity", 0);
+        prm.put("restart", 30);
+        prm.put("solver", solver);
+        prm.put("preconditioner.type", std::string("ILU0"));
+        Dune::FlexibleSolver<Operator> linsolver(op, comm, prm, weightsCalculator, 0);
+
+        int iterations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < repetitions; ++rep) {
+            Vector x(numCells);
+            Vector b(numCells);
+            x = 0.0;
+            b = 1.0;
+            Dune::InverseOperatorResult res;
+            linsolver.apply(x, b, res);
+            iterations = res.iterations;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double time = comm.communicator().max(elapsed.count() / repetitions);
+
+        if (mpiHelper.rank() == 0) {
+            std::cout << "procs " << mpiHelper.size()
+                      << "  solver " << std::setw(18) << solver
+                      << "  iterations " << std::setw(5) << iterations
+                      << "  time " << std::setw(10) << time * 1e3 << " ms"
+                      << "  time/iteration " << std::setw(10) << time * 1e3 / std::max(iterations, 1) << " ms"
+                      << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#else // HAVE_MPI
+
+int main()
+{
+    std::cout << "benchmark_pipelined_krylov requires MPI." << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif // HAVE_MPI
@@ -0,0 +1,478 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Replays a linear system written by the simulator (linear solver
+// verbosity > 10) with a set of linear solver configurations, to compare
+// them outside of a simulation run. The system is given by the common
+// prefix of its files, e.g. "reports/prob_0_time_000086400_nit_2_":
+//  - <prefix>matrix_istl and <prefix>rhs_istl, the Jacobian and residual.
+//  - <prefix>wells_istl (optional), the well contributions -C D^-1 B when
+//    they are not added to the matrix (--matrix-add-well-contributions=false).
+//  - or <prefix>system_istl.bin with all of these, when written in the
+//    binary format (--linear-system-dump-format=binary).
+// Systems written by a parallel run consist of one file per process, and
+// their index sets, and must be replayed with the same number of processes.
+// The configurations are JSON files in the format of the
+// --linear-solver-configuration option, see options_flexiblesolver.json.
+//
+// Usage: [mpirun -np <procs>] replay_linear_system [--repeat=<n>] [--pressure-index=<i>]
+//                                                  <system prefix> <config.json> ...
+//
+// For every configuration the setup time (creating the solver and its
+// preconditioner), the apply time, the number of iterations and the
+// reduction of the true residual are reported, averaged over the
+// repetitions. Times are the maximum over all processes.
+
+#include <config.h>
+
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/simulators/linalg/BinarySystemFile.hpp>
+#include <opm/simulators/linalg/FlexibleSolver.hpp>
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/MatrixMarketSpecializations.hpp>
+#include <opm/simulators/linalg/PropertyTree.hpp>
+#include <opm/simulators/linalg/WellOperators.hpp>
+#include <opm/simulators/linalg/getQuasiImpesWeights.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/matrixmarket.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/scalarproducts.hh>
+#if HAVE_MPI
+#include <dune/istl/owneroverlapcopy.hh>
+#include <dune/istl/schwarz.hh>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template <int N>
+using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, N, N>>;
+template <int N>
+using Vector = Dune::BlockVector<Dune::FieldVector<double, N>>;
+#if HAVE_MPI
+using Comm = Dune::OwnerOverlapCopyCommunication<int, int>;
+#endif
+
+struct Options
+{
+    int repeat = 1;
+    int pressureIndex = 0;
+    std::string prefix;
+    std::vector<std::string> configs;
+};
+
+struct Timing
+{
+    double setup = 0.0;
+    double apply = 0.0;
+    double iterations = 0.0;
+    double reduction = 0.0;
+    bool converged = true;
+};
+
+
+/// Well contributions given as an assembled matrix, applied in addition
+/// to the system matrix by the well model adapters.
+template <int N>
+class MatrixWellOperator : public Opm::LinearOperatorExtra<Vector<N>, Vector<N>>
+{
+public:
+    using Base = Opm::LinearOperatorExtra<Vector<N>, Vector<N>>;
+    using field_type = typename Base::field_type;
+    using PressureMatrix = typename Base::PressureMatrix;
+
+    explicit MatrixWellOperator(const Matrix<N>& wells)
+        : wells_(wells)
+    {
+    }
+
+    void apply(const Vector<N>& x, Vector<N>& y) const override
+    {
+        wells_.umv(x, y);
+    }
+
+    void applyscaleadd(field_type alpha, const Vector<N>& x, Vector<N>& y) const override
+    {
+        wells_.usmv(alpha, x, y);
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return Dune::SolverCategory::sequential;
+    }
+
+    void addWellPressureEquations(PressureMatrix&, const Vector<N>&, const bool) const override
+    {
+        OPM_THROW(std::logic_error, "The well pressure equations (cprw) are not available when replaying a linear system.");
+    }
+
+    void addWellPressureEquationsStruct(PressureMatrix&) const override
+    {
+        OPM_THROW(std::logic_error, "The well pressure equations (cprw) are not available when replaying a linear system.");
+    }
+
+    int getNumberOfExtraEquations() const override
+    {
+        return 0;
+    }
+
+private:
+    const Matrix<N>& wells_;
+};
+
+
+/// The file of this process. Runs with MPI write "<name>_<rank><extension>"
+/// also on a single process.
+std::string rankFileName(const std::string& name, const int rank, const std::string& extension)
+{
+    const std::string parallelName = name + "_" + std::to_string(rank) + extension;
+    if (std::filesystem::exists(parallelName)) {
+        return parallelName;
+    }
+    return name + extension;
+}
+
+/// Block size of a matrix file, from the structure line written by storeMatrixMarket.
+int readBlockSize(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file) {
+        OPM_THROW(std::runtime_error, "Could not open " << filename);
+    }
+    std::string line;
+    while (std::getline(file, line) && !line.empty() && line[0] == '%') {
+        std::istringstream words(line);
+        std::string percent, istlStruct, blocked;
+        int rows = 0, cols = 0;
+        words >> percent >> istlStruct >> blocked >> rows >> cols;
+        if (istlStruct == "ISTL_STRUCT" && blocked == "blocked") {
+            if (rows != cols) {
+                OPM_THROW(std::runtime_error, "Non-square blocks in " << filename);
+            }
+            return rows;
+        }
+    }
+    return 1;
+}
+
+template <int N>
+std::function<void(Vector<N>&)> weightsCalculator(const Opm::PropertyTree& prm,
+                                                  const Matrix<N>& matrix,
+                                                  const int pressureIndex,
+                                                  const bool ioRank)
+{
+    using namespace std::string_literals;
+    const auto type = prm.get("preconditioner.type"s, "cpr"s);
+    if (type != "cpr" && type != "cprt" && type != "cprw" && type != "cprwt") {
+        return {};
+    }
+    const bool transpose = type == "cprt" || type == "cprwt";
+    if (prm.get("preconditioner.weight_type"s, "quasiimpes"s) != "quasiimpes" && ioRank) {
+        std::cout << "Note: only quasiimpes weights can be computed from the matrix, using these." << std::endl;
+    }
+    return [&matrix, pressureIndex, transpose](Vector<N>& weights) {
+        Opm::Amg::getQuasiImpesWeights(matrix, pressureIndex, transpose, weights);
+    };
+}
+
+/// Create the solver for every repetition and apply it to the system,
+/// measuring the true residual reduction with the given operator.
+template <class Operator, class CreateSolver>
+Timing run(Operator& op,
+           Dune::ScalarProduct<typename Operator::domain_type>& sp,
+           const typename Operator::domain_type& rhs,
+           const CreateSolver& createSolver,
+           const int repeat)
+{
+    using X = typename Operator::domain_type;
+    using Clock = std::chrono::steady_clock;
+    Timing timing;
+    const double rhsNorm = sp.norm(rhs);
+    for (int i = 0; i < repeat; ++i) {
+        const auto start = Clock::now();
+        auto solver = createSolver();
+        const auto setup = Clock::now();
+
+        X x(rhs.size());
+        x = 0.0;
+        X b(rhs);
+        Dune::InverseOperatorResult result;
+        solver->apply(x, b, result);
+        const auto end = Clock::now();
+
+        X residual(rhs);
+        op.applyscaleadd(-1.0, x, residual);
+        timing.setup += std::chrono::duration<double>(setup - start).count();
+        timing.apply += std::chrono::duration<double>(end - setup).count();
+        timing.iterations += result.iterations;
+        timing.reduction += rhsNorm > 0.0 ? sp.norm(residual) / rhsNorm : 0.0;
+        timing.converged = timing.converged && result.converged;
+    }
+    timing.setup /= repeat;
+    timing.apply /= repeat;
+    timing.iterations /= repeat;
+    timing.reduction /= repeat;
+    return timing;
+}
+
+void printHeader()
+{
+    std::cout << std::left << std::setw(40) << "Configuration" << std::right
+              << std::setw(12) << "Setup [s]" << std::setw(12) << "Apply [s]"
+              << std::setw(10) << "Iter" << std::setw(14) << "Reduction" << std::endl;
+}
+
+void report(const std::string& config, const Timing& timing)
+{
+    std::cout << std::left << std::setw(40) << config << std::right
+              << std::setw(12) << std::setprecision(4) << timing.setup
+              << std::setw(12) << std::setprecision(4) << timing.apply
+              << std::setw(10) << std::setprecision(4) << timing.iterations
+              << std::setw(14) << std::setprecision(3) << std::scientific << timing.reduction
+              << std::defaultfloat
+              << (timing.converged ? "" : "  (not converged)") << std::endl;
+}
+
+template <int N>
+void replaySequential(const Options& options)
+{
+    using M = Matrix<N>;
+    using V = Vector<N>;
+    using FieldMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, N, N>>;
+
+    M matrix;
+    V rhs;
+    std::optional<M> wells;
+    const auto binaryFile = rankFileName(options.prefix + "system_istl", 0, ".bin");
+    if (std::filesystem::exists(binaryFile)) {
+        const Opm::MappedBinarySystem system(binaryFile);
+        matrix = system.matrix<M>();
+        rhs = system.rhs<V>();
+        if (system.hasWells()) {
+            wells = system.wells<M>();
+        }
+    } else {
+        Dune::loadMatrixMarket(reinterpret_cast<FieldMatrix&>(matrix), rankFileName(options.prefix + "matrix_istl", 0, ".mm"));
+        Dune::loadMatrixMarket(rhs, rankFileName(options.prefix + "rhs_istl", 0, ".mm"));
+        const auto wellsFile = rankFileName(options.prefix + "wells_istl", 0, ".mm");
+        if (std::filesystem::exists(wellsFile)) {
+            wells.emplace();
+            Dune::loadMatrixMarket(reinterpret_cast<FieldMatrix&>(*wells), wellsFile);
+        }
+    }
+    std::cout << "System with " << matrix.N() << " rows of size " << N << ", "
+              << matrix.nonzeroes() << " blocks"
+              << (wells ? ", and " + std::to_string(wells->nonzeroes()) + " well blocks" : std::string())
+              << std::endl;
+    printHeader();
+
+    Dune::SeqScalarProduct<V> sp;
+    for (const auto& config : options.configs) {
+        const Opm::PropertyTree prm(config);
+        const auto wc = weightsCalculator(prm, matrix, options.pressureIndex, true);
+        Timing timing;
+        if (wells) {
+            using Operator = Opm::WellModelMatrixAdapter<M, V, V, false>;
+            MatrixWellOperator<N> wellOp(*wells);
+            Operator op(matrix, wellOp);
+            timing = run(op, sp, rhs, [&]() {
+                return std::make_unique<Dune::FlexibleSolver<Operator>>(op, prm, wc, options.pressureIndex);
+            }, options.repeat);
+        } else {
+            using Operator = Dune::MatrixAdapter<M, V, V>;
+            Operator op(matrix);
+            timing = run(op, sp, rhs, [&]() {
+                return std::make_unique<Dune::FlexibleSolver<Operator>>(op, prm, wc, options.pressureIndex);
+            }, options.repeat);
+        }
+        report(config, timing);
+    }
+}
+
+#if HAVE_MPI
+template <int N>
+void replayParallel(const Options& options)
+{
+    using M = Matrix<N>;
+    using V = Vector<N>;
+    using FieldMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, N, N>>;
+
+    // Reading the index sets of the matrix restores the decomposition.
+    Comm comm(Dune::MPIHelper::getCommunicator());
+    const auto& cc = comm.communicator();
+    M matrix;
+    V rhs;
+    std::optional<M> wells;
+    const auto binaryFile = options.prefix + "system_istl_" + std::to_string(cc.rank()) + ".bin";
+    if (std::filesystem::exists(binaryFile)) {
+        const Opm::MappedBinarySystem system(binaryFile);
+        system.setupCommunication(comm);
+        matrix = system.matrix<M>();
+        rhs = system.rhs<V>();
+        if (system.hasWells()) {
+            wells = system.wells<M>();
+        }
+    } else {
+        Dune::loadMatrixMarket(reinterpret_cast<FieldMatrix&>(matrix), options.prefix + "matrix_istl", comm, true);
+        Dune::loadMatrixMarket(rhs, options.prefix + "rhs_istl", comm, false);
+        if (std::filesystem::exists(rankFileName(options.prefix + "wells_istl", cc.rank(), ".mm"))) {
+            wells.emplace();
+            Dune::loadMatrixMarket(reinterpret_cast<FieldMatrix&>(*wells), options.prefix + "wells_istl", comm, false);
+        }
+    }
+
+    // The simulator numbers the owned rows first.
+    std::size_t interiorSize = 0;
+    std::size_t interiorEnd = 0;
+    for (const auto& index : comm.indexSet()) {
+        if (index.local().attribute() == Dune::OwnerOverlapCopyAttributeSet::owner) {
+            ++interiorSize;
+            interiorEnd = std::max(interiorEnd, static_cast<std::size_t>(index.local().local()) + 1);
+        }
+    }
+    if (interiorEnd != interiorSize) {
+        OPM_THROW(std::runtime_error, "The owned rows are not numbered first on process " << cc.rank());
+    }
+    const bool ioRank = cc.rank() == 0;
+    const auto globalRows = cc.sum(interiorSize);
+    if (ioRank) {
+        std::cout << "System with " << globalRows << " rows of size " << N << " on "
+                  << cc.size() << " processes" << (wells ? ", with separate well contributions" : "") << std::endl;
+        printHeader();
+    }
+
+    Dune::OverlappingSchwarzScalarProduct<V, Comm> sp(comm);
+    for (const auto& config : options.configs) {
+        const Opm::PropertyTree prm(config);
+        const auto wc = weightsCalculator(prm, matrix, options.pressureIndex, ioRank);
+        Timing timing;
+        if (wells) {
+            using Operator = Opm::WellModelGhostLastMatrixAdapter<M, V, V, true>;
+            MatrixWellOperator<N> wellOp(*wells);
+            Operator op(matrix, wellOp, interiorSize);
+            timing = run(op, sp, rhs, [&]() {
+                return std::make_unique<Dune::FlexibleSolver<Operator>>(op, comm, prm, wc, options.pressureIndex);
+            }, options.repeat);
+        } else {
+            using Operator = Dune::OverlappingSchwarzOperator<M, V, V, Comm>;
+            Operator op(matrix, comm);
+            timing = run(op, sp, rhs, [&]() {
+                return std::make_unique<Dune::FlexibleSolver<Operator>>(op, comm, prm, wc, options.pressureIndex);
+            }, options.repeat);
+        }
+        timing.setup = cc.max(timing.setup);
+        timing.apply = cc.max(timing.apply);
+        if (ioRank) {
+            report(config, timing);
+        }
+    }
+}
+#endif // HAVE_MPI
+
+template <int N>
+void replay(const Options& options, const int numProcesses)
+{
+    if (numProcesses == 1) {
+        replaySequential<N>(options);
+        return;
+    }
+#if HAVE_MPI
+    replayParallel<N>(options);
+#endif
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--repeat=", 0) == 0) {
+            options.repeat = std::max(std::atoi(arg.c_str() + 9), 1);
+        } else if (arg.rfind("--pressure-index=", 0) == 0) {
+            options.pressureIndex = std::atoi(arg.c_str() + 17);
+        } else if (options.prefix.empty()) {
+            options.prefix = arg;
+        } else {
+            options.configs.push_back(arg);
+        }
+    }
+    if (options.prefix.empty() || options.configs.empty()) {
+        throw std::invalid_argument("Usage: replay_linear_system [--repeat=<n>] [--pressure-index=<i>] "
+                                    "<system prefix> <config.json> ...");
+    }
+    return options;
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+    const auto& helper = Dune::MPIHelper::instance(argc, argv);
+    try {
+        const Options options = parseOptions(argc, argv);
+        const int numProcesses = helper.size();
+#if !HAVE_MPI
+        if (numProcesses > 1) {
+            throw std::runtime_error("Replaying a parallel linear system requires MPI.");
+        }
+#endif
+        const auto binaryFile = rankFileName(options.prefix + "system_istl", helper.rank(), ".bin");
+        const int blockSize = std::filesystem::exists(binaryFile)
+            ? static_cast<int>(Opm::MappedBinarySystem(binaryFile).header().blockSize)
+            : readBlockSize(rankFileName(options.prefix + "matrix_istl", helper.rank(), ".mm"));
+        switch (blockSize) {
+        case 1: replay<1>(options, numProcesses); break;
+        case 2: replay<2>(options, numProcesses); break;
+        case 3: replay<3>(options, numProcesses); break;
+        case 4: replay<4>(options, numProcesses); break;
+        case 5: replay<5>(options, numProcesses); break;
+        case 6: replay<6>(options, numProcesses); break;
+        default:
+            OPM_THROW(std::runtime_error, "Unsupported block size " << blockSize);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -340,6 +340,9 @@ namespace Opm {
             }
             report.update_time += perfTimer.stop();
             residual_norms_history_.push_back(residual_norms);
+            if (param_.use_adaptive_linear_tolerance_) {
+                ebosSimulator_.model().newtonMethod().linearSolver().setLinearReduction(adaptiveLinearReduction());
+            }
             if (!report.converged) {
                 perfTimer.reset();
                 perfTimer.start();
@@ -1122,7 +1125,47 @@ namespace Opm {
         double dsMax() const { return param_.ds_max_; }
         double drMaxRel() const { return param_.dr_max_rel_; }
         double maxResidualAllowed() const { return param_.max_residual_allowed_; }
+
+        /// Linear solver tolerance for the current Newton iteration, from the
+        /// reduction of the largest CNV residual |F| (Eisenstat and Walker,
+        /// choice 2): eta_k = gamma (|F_k| / |F_k-1|)^2. Safeguards:
+        ///  - eta_k is not reduced much below gamma eta_k-1^2 while that is
+        ///    still large, to avoid a sudden tightening.
+        ///  - eta_k >= 0.5 tol / |F_k|, not to solve more accurately than
+        ///    needed to satisfy the CNV tolerance tol.
+        ///  - eta_k <= the maximum tolerance.
+        /// The linear solver does not go below its configured tolerance.
+        double adaptiveLinearReduction()
+        {
+            const double gamma = 0.9;
+            const double etaMax = param_.max_adaptive_linear_tolerance_;
+            const auto scaledNorm = [this](const std::vector<double>& norms) {
+                const double maxNorm = norms.empty() ? 0.0 : *std::max_element(norms.begin(), norms.end());
+                return maxNorm / param_.tolerance_cnv_;
+            };
+            const double norm = scaledNorm(residual_norms_history_.back());
+            double eta = etaMax;
+            if (residual_norms_history_.size() > 1) {
+                const double previousNorm = scaledNorm(residual_norms_history_[residual_norms_history_.size() - 2]);
+                if (previousNorm > 0.0) {
+                    const double ratio = norm / previousNorm;
+                    eta = gamma * ratio * ratio;
+                    const double previousEta = gamma * linear_reduction_ * linear_reduction_;
+                    if (previousEta > 0.1) {
+                        eta = std::max(eta, previousEta);
+                    }
+                }
+            }
+            if (norm > 0.0) {
+                eta = std::max(eta, 0.5 / norm);
+            }
+            linear_reduction_ = std::min(eta, etaMax);
+            return linear_reduction_;
+        }
+
         double linear_solve_setup_time_;
+        /// Linear tolerance of the last Newton iteration, with the adaptive linear tolerance.
+        double linear_reduction_ = 1.0;
     public:
         std::vector<bool> wasSwitched_;
     };
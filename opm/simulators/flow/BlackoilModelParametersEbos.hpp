@@ -92,6 +92,10 @@ struct SolveWelleqInitially {
     using type = UndefinedProperty;
 };
 template<class TypeTag, class MyTypeTag>
+struct ParallelWellAssembly {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
 struct UpdateEquationsScaling {
     using type = UndefinedProperty;
 };
@@ -104,6 +108,14 @@ struct MatrixAddWellContributions {
     using type = UndefinedProperty;
 };
 template<class TypeTag, class MyTypeTag>
+struct UseAdaptiveLinearTolerance {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct MaxAdaptiveLinearTolerance {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
 struct EnableWellOperabilityCheck {
     using type = UndefinedProperty;
 };
@@ -232,6 +244,10 @@ struct SolveWelleqInitially<TypeTag, TTag::FlowModelParameters> {
     static constexpr bool value = true;
 };
 template<class TypeTag>
+struct ParallelWellAssembly<TypeTag, TTag::FlowModelParameters> {
+    static constexpr bool value = false;
+};
+template<class TypeTag>
 struct UpdateEquationsScaling<TypeTag, TTag::FlowModelParameters> {
     static constexpr bool value = false;
 };
@@ -244,6 +260,15 @@ struct MatrixAddWellContributions<TypeTag, TTag::FlowModelParameters> {
     static constexpr bool value = false;
 };
 template<class TypeTag>
+struct UseAdaptiveLinearTolerance<TypeTag, TTag::FlowModelParameters> {
+    static constexpr bool value = false;
+};
+template<class TypeTag>
+struct MaxAdaptiveLinearTolerance<TypeTag, TTag::FlowModelParameters> {
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+template<class TypeTag>
 struct TolerancePressureMsWells<TypeTag, TTag::FlowModelParameters> {
     using type = GetPropType<TypeTag, Scalar>;
     static constexpr type value = 0.01*1e5;
@@ -394,12 +419,22 @@ namespace Opm
         /// Solve well equation initially
         bool solve_welleq_initially_;
 
+        /// Assemble and solve the wells that do not depend on each other on several threads
+        bool parallel_well_assembly_;
+
         /// Update scaling factors for mass balance equations
         bool update_equations_scaling_;
 
         /// Try to detect oscillation or stagnation.
         bool use_update_stabilization_;
 
+        /// Choose the linear solver tolerance of every Newton iteration from
+        /// the reduction of the nonlinear residual (inexact Newton).
+        bool use_adaptive_linear_tolerance_;
+
+        /// Loosest linear solver tolerance used by the inexact Newton method.
+        double max_adaptive_linear_tolerance_;
+
         /// Whether to use MultisegmentWell to handle multisegment wells
         /// it is something temporary before the multisegment well model is considered to be
         /// well developed and tested.
@@ -451,8 +486,11 @@ namespace Opm
             maxSinglePrecisionTimeStep_ = EWOMS_GET_PARAM(TypeTag, Scalar, MaxSinglePrecisionDays) *24*60*60;
             max_strict_iter_ = EWOMS_GET_PARAM(TypeTag, int, MaxStrictIter);
             solve_welleq_initially_ = EWOMS_GET_PARAM(TypeTag, bool, SolveWelleqInitially);
+            parallel_well_assembly_ = EWOMS_GET_PARAM(TypeTag, bool, ParallelWellAssembly);
             update_equations_scaling_ = EWOMS_GET_PARAM(TypeTag, bool, UpdateEquationsScaling);
             use_update_stabilization_ = EWOMS_GET_PARAM(TypeTag, bool, UseUpdateStabilization);
+            use_adaptive_linear_tolerance_ = EWOMS_GET_PARAM(TypeTag, bool, UseAdaptiveLinearTolerance);
+            max_adaptive_linear_tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, MaxAdaptiveLinearTolerance);
             matrix_add_well_contributions_ = EWOMS_GET_PARAM(TypeTag, bool, MatrixAddWellContributions);
             check_well_operability_ = EWOMS_GET_PARAM(TypeTag, bool, EnableWellOperabilityCheck);
             check_well_operability_iter_ = EWOMS_GET_PARAM(TypeTag, bool, EnableWellOperabilityCheckIter);
@@ -489,8 +527,11 @@ namespace Opm
             EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxSinglePrecisionDays, "Maximum time step size where single precision floating point arithmetic can be used solving for the linear systems of equations");
             EWOMS_REGISTER_PARAM(TypeTag, int, MaxStrictIter, "Maximum number of Newton iterations before relaxed tolerances are used for the CNV convergence criterion");
             EWOMS_REGISTER_PARAM(TypeTag, bool, SolveWelleqInitially, "Fully solve the well equations before each iteration of the reservoir model");
+            EWOMS_REGISTER_PARAM(TypeTag, bool, ParallelWellAssembly, "Assemble and solve the well equations on several threads, for the wells that are not coupled through group controls");
             EWOMS_REGISTER_PARAM(TypeTag, bool, UpdateEquationsScaling, "Update scaling factors for mass balance equations during the run");
             EWOMS_REGISTER_PARAM(TypeTag, bool, UseUpdateStabilization, "Try to detect and correct oscillations or stagnation during the Newton method");
+            EWOMS_REGISTER_PARAM(TypeTag, bool, UseAdaptiveLinearTolerance, "Loosen the linear solver tolerance in Newton iterations far from convergence, based on the reduction of the CNV residuals (Eisenstat-Walker)");
+            EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxAdaptiveLinearTolerance, "Loosest linear solver tolerance used with --use-adaptive-linear-tolerance");
             EWOMS_REGISTER_PARAM(TypeTag, bool, MatrixAddWellContributions, "Explicitly specify the influences of wells between cells in the Jacobian and preconditioner matrices");
             EWOMS_REGISTER_PARAM(TypeTag, bool, EnableWellOperabilityCheck, "Enable the well operability checking");
             EWOMS_REGISTER_PARAM(TypeTag, bool, EnableWellOperabilityCheckIter, "Enable the well operability checking during iterations");
@@ -0,0 +1,345 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BISAI_HEADER_INCLUDED
+#define OPM_BISAI_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/PreconditionerWithUpdate.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/common/version.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/ilu.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Block incomplete sparse approximate inverse preconditioner on the CPU.
+///
+/// This is a CPU version of the BISAI preconditioner that is implemented
+/// for OpenCL in bda/opencl/BISAI.cpp, following
+///     H. Anzt et al., Incomplete sparse approximate inverses for parallel
+///     preconditioning, Parallel Computing 71 (2018), 1-22.
+///
+/// Approximate inverses M_L and M_U of the ILU0 factors L and U are
+/// computed on the sparsity pattern of A, such that (L M_L)_ij = (U M_U)_ij
+/// = delta_ij for all nonzeros (i, j). Every column of M_L and M_U is the
+/// solution of a small independent triangular system, hence the setup is
+/// distributed among the OpenMP threads column by column. The application
+/// is v = w M_U M_L d, i.e. two sparse matrix-vector products which are
+/// threaded over the rows.
+///
+/// \tparam Matrix The type of the Matrix.
+/// \tparam Domain The type of the Vector representing the domain.
+/// \tparam Range The type of the Vector representing the range.
+template <class Matrix, class Domain, class Range>
+class BISAI : public Dune::PreconditionerWithUpdate<Domain, Range>
+{
+public:
+    //! \brief The matrix type the preconditioner is for.
+    using matrix_type = typename std::remove_const<Matrix>::type;
+    //! \brief The domain type of the preconditioner.
+    using domain_type = Domain;
+    //! \brief The range type of the preconditioner.
+    using range_type = Range;
+    //! \brief The field type of the preconditioner.
+    using field_type = typename Domain::field_type;
+
+    using block_type = typename matrix_type::block_type;
+    using size_type = typename matrix_type::size_type;
+
+    /*! \brief Constructor.
+
+      \param A The matrix to operate on.
+      \param w The relaxation factor.
+    */
+    BISAI(const Matrix& A, const field_type w)
+        : A_(A)
+        , w_(w)
+    {
+        update();
+    }
+
+    void pre(Domain&, Range&) override
+    {
+    }
+
+    void apply(Domain& v, const Range& d) override
+    {
+        const std::ptrdiff_t numRows = rows_.size() - 1;
+        tmp_.resize(d.size());
+
+        // tmp = M_L d, the unit diagonal of M_L is not stored.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            auto rhs = d[row];
+            for (size_type ij = rows_[row]; ij < diagonal_[row]; ++ij) {
+                inverse_[ij].umv(d[cols_[ij]], rhs);
+            }
+            tmp_[row] = rhs;
+        }
+
+        // v = w M_U tmp
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            v[row] = 0;
+            for (size_type ij = diagonal_[row]; ij < rows_[row + 1]; ++ij) {
+                inverse_[ij].umv(tmp_[cols_[ij]], v[row]);
+            }
+            v[row] *= w_;
+        }
+    }
+
+    void post(Domain&) override
+    {
+    }
+
+    void update() override
+    {
+        if (!ilu_ || patternChanged()) {
+            ilu_ = std::make_unique<matrix_type>(A_);
+            buildPattern();
+        } else {
+            *ilu_ = A_;
+        }
+
+        // After the decomposition the strict lower part holds L (with
+        // unit diagonal), the diagonal holds the inverted diagonal of U
+        // and the strict upper part holds U.
+#if DUNE_VERSION_LT(DUNE_GRID, 2, 8)
+        bilu0_decomposition(*ilu_);
+#else
+        Dune::ILU::blockILU0Decomposition(*ilu_);
+#endif
+        for (auto row = ilu_->begin(); row != ilu_->end(); ++row) {
+            size_type ij = rows_[row.index()];
+            for (auto col = row->begin(); col != row->end(); ++col, ++ij) {
+                lu_[ij] = *col;
+            }
+        }
+
+        const std::ptrdiff_t numRows = rows_.size() - 1;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t col = 0; col < numRows; ++col) {
+            // Column col of M_L by forward substitution, top to bottom.
+            for (size_type t = lower_.columnStart[col]; t < lower_.columnStart[col + 1]; ++t) {
+                const size_type target = lower_.targets[t];
+                block_type s = lu_[target];
+                for (size_type p = lower_.pairStart[t]; p < lower_.pairStart[t + 1]; ++p) {
+                    block_type product = lu_[lower_.pairs[p].first];
+                    product.rightmultiply(inverse_[lower_.pairs[p].second]);
+                    s += product;
+                }
+                s *= -1.0;
+                inverse_[target] = s;
+            }
+
+            // Column col of M_U by backward substitution, bottom to top,
+            // starting with (M_U)_jj = U_jj^-1.
+            inverse_[diagonal_[col]] = lu_[diagonal_[col]];
+            for (size_type t = upper_.columnStart[col]; t < upper_.columnStart[col + 1]; ++t) {
+                const size_type target = upper_.targets[t];
+                block_type s(0.0);
+                for (size_type p = upper_.pairStart[t]; p < upper_.pairStart[t + 1]; ++p) {
+                    block_type product = lu_[upper_.pairs[p].first];
+                    product.rightmultiply(inverse_[upper_.pairs[p].second]);
+                    s -= product;
+                }
+                s.leftmultiply(lu_[diagonal_[upper_.rows[t]]]);
+                inverse_[target] = s;
+            }
+        }
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return Dune::SolverCategory::sequential;
+    }
+
+private:
+    /// \brief The small triangular systems of the columns of one factor.
+    ///
+    /// For column j, the unknowns targets[columnStart[j]] to
+    /// targets[columnStart[j+1]-1] are computed in this order. The entry
+    /// at offset target (in row rows[t]) is a linear combination of the
+    /// products factor[pair.first] * inverse[pair.second] over the pairs
+    /// pairStart[t] to pairStart[t+1]-1.
+    struct Subsystems
+    {
+        std::vector<size_type> columnStart;
+        std::vector<size_type> targets;
+        std::vector<size_type> rows;
+        std::vector<size_type> pairStart;
+        std::vector<std::pair<size_type, size_type>> pairs;
+    };
+
+    /// \brief True if the sparsity pattern of A differs from the stored one.
+    bool patternChanged() const
+    {
+        if (A_.N() + 1 != rows_.size() || A_.nonzeroes() != cols_.size()) {
+            return true;
+        }
+        for (size_type row = 0; row < A_.N(); ++row) {
+            if (A_[row].size() != rows_[row + 1] - rows_[row]) {
+                return true;
+            }
+            auto column = cols_.begin() + rows_[row];
+            for (auto col = A_[row].begin(); col != A_[row].end(); ++col, ++column) {
+                if (col.index() != *column) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// \brief Set up the CRS pattern of A and the structure of the column
+    /// subsystems of M_L and M_U. Only done when the pattern changes.
+    void buildPattern()
+    {
+        const size_type numRows = A_.N();
+        rows_.assign(numRows + 1, 0);
+        cols_.clear();
+        cols_.reserve(A_.nonzeroes());
+        diagonal_.assign(numRows, 0);
+        for (auto row = A_.begin(); row != A_.end(); ++row) {
+            bool hasDiagonal = false;
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                if (col.index() == row.index()) {
+                    diagonal_[row.index()] = cols_.size();
+                    hasDiagonal = true;
+                }
+                cols_.push_back(col.index());
+            }
+            if (!hasDiagonal) {
+                OPM_THROW(std::logic_error, "BISAI: diagonal entry missing in row " << row.index());
+            }
+            rows_[row.index() + 1] = cols_.size();
+        }
+
+        // Column oriented view of the pattern: the rows (in increasing
+        // order) and CRS offsets of the nonzeros of every column.
+        std::vector<size_type> colStart(numRows + 1, 0);
+        for (const auto col : cols_) {
+            ++colStart[col + 1];
+        }
+        std::partial_sum(colStart.begin(), colStart.end(), colStart.begin());
+        std::vector<size_type> colRows(cols_.size());
+        std::vector<size_type> colOffsets(cols_.size());
+        std::vector<size_type> next(colStart.begin(), colStart.end() - 1);
+        for (size_type i = 0; i < numRows; ++i) {
+            for (size_type ij = rows_[i]; ij < rows_[i + 1]; ++ij) {
+                const size_type pos = next[cols_[ij]]++;
+                colRows[pos] = i;
+                colOffsets[pos] = ij;
+            }
+        }
+
+        const auto offset = [this](const size_type row, const size_type col) -> std::ptrdiff_t {
+            const auto begin = cols_.begin() + rows_[row];
+            const auto end = cols_.begin() + rows_[row + 1];
+            const auto it = std::lower_bound(begin, end, col);
+            return (it != end && *it == col) ? it - cols_.begin() : -1;
+        };
+
+        lower_ = Subsystems{};
+        upper_ = Subsystems{};
+        lower_.columnStart.assign(numRows + 1, 0);
+        upper_.columnStart.assign(numRows + 1, 0);
+        lower_.pairStart.push_back(0);
+        upper_.pairStart.push_back(0);
+        for (size_type j = 0; j < numRows; ++j) {
+            const size_type begin = colStart[j];
+            const size_type end = colStart[j + 1];
+            const size_type diag = std::find(colRows.begin() + begin, colRows.begin() + end, j) - colRows.begin();
+
+            // (M_L)_ij = -(L_ij + sum_{j<k<i} L_ik (M_L)_kj) for i > j.
+            for (size_type t = diag + 1; t < end; ++t) {
+                const size_type i = colRows[t];
+                for (size_type s = diag + 1; s < t; ++s) {
+                    const auto ik = offset(i, colRows[s]);
+                    if (ik >= 0) {
+                        lower_.pairs.emplace_back(ik, colOffsets[s]);
+                    }
+                }
+                lower_.targets.push_back(colOffsets[t]);
+                lower_.rows.push_back(i);
+                lower_.pairStart.push_back(lower_.pairs.size());
+            }
+            lower_.columnStart[j + 1] = lower_.targets.size();
+
+            // (M_U)_ij = -U_ii^-1 sum_{i<k<=j} U_ik (M_U)_kj for i < j.
+            for (size_type t = diag; t-- > begin; ) {
+                const size_type i = colRows[t];
+                for (size_type s = t + 1; s <= diag; ++s) {
+                    const auto ik = offset(i, colRows[s]);
+                    if (ik >= 0) {
+                        upper_.pairs.emplace_back(ik, colOffsets[s]);
+                    }
+                }
+                upper_.targets.push_back(colOffsets[t]);
+                upper_.rows.push_back(i);
+                upper_.pairStart.push_back(upper_.pairs.size());
+            }
+            upper_.columnStart[j + 1] = upper_.targets.size();
+        }
+
+        lu_.resize(cols_.size());
+        inverse_.resize(cols_.size());
+    }
+
+    const Matrix& A_;
+    field_type w_;
+
+    //! \brief The ILU0 decomposition of A.
+    std::unique_ptr<matrix_type> ilu_;
+
+    //! \brief The pattern of A in CRS format, diagonal_ holds the offset of the diagonal in each row.
+    std::vector<size_type> rows_;
+    std::vector<size_type> cols_;
+    std::vector<size_type> diagonal_;
+    Subsystems lower_;
+    Subsystems upper_;
+
+    //! \brief The flat ILU0 factors, in the order of the pattern.
+    std::vector<block_type> lu_;
+    //! \brief The strict lower part of M_L and the upper part of M_U, in the order of the pattern.
+    std::vector<block_type> inverse_;
+
+    Range tmp_;
+};
+
+} // namespace Opm
+
+#endif // OPM_BISAI_HEADER_INCLUDED
@@ -0,0 +1,516 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BINARYSYSTEMFILE_HEADER_INCLUDED
+#define OPM_BINARYSYSTEMFILE_HEADER_INCLUDED
+
+#include <opm/common/ErrorMacros.hpp>
+
+#if HAVE_MPI
+#include <dune/istl/owneroverlapcopy.hh>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Opm
+{
+
+/// \brief Header of a binary linear system file.
+///
+/// A file holds the part of a linear system that is local to one process:
+/// the matrix in block-CSR format, the right hand side, optionally the
+/// well contributions as a second block-CSR matrix, and in parallel runs
+/// the index set mapping the local rows to global indices. The arrays are
+/// stored without any conversion, in the byte order of the writer, and
+/// start at the given offsets which are aligned for direct use after
+/// mapping the file into memory:
+///  - row start:  uint64[numRows + 1]
+///  - columns:    uint64[nonzeroes], local column indices
+///  - values:     double[nonzeroes * blockSize * blockSize], row-major blocks
+///  - rhs:        double[numRows * blockSize]
+///  - indices:    BinarySystemIndex[numIndices]
+///  - neighbours: int32[numNeighbours], the ranks sharing indices
+/// An offset of 0 marks an absent array.
+struct BinarySystemHeader
+{
+    static constexpr char magicString[8] = {'O', 'P', 'M', 'L', 'S', 'Y', 'S', '\0'};
+    static constexpr std::uint32_t currentVersion = 1;
+    static constexpr std::uint64_t alignment = 64;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t blockSize;
+    std::int32_t rank;
+    std::int32_t numRanks;
+    std::uint64_t numRows;
+    std::uint64_t nonzeroes;
+    std::uint64_t wellNonzeroes;
+    std::uint64_t numIndices;
+    std::uint64_t numNeighbours;
+    std::uint64_t rowStart;
+    std::uint64_t columns;
+    std::uint64_t values;
+    std::uint64_t rhs;
+    std::uint64_t wellRowStart;
+    std::uint64_t wellColumns;
+    std::uint64_t wellValues;
+    std::uint64_t indices;
+    std::uint64_t neighbours;
+};
+
+/// \brief Entry of the parallel index set in a binary linear system file.
+struct BinarySystemIndex
+{
+    std::int64_t global;
+    std::uint64_t local;
+    std::uint32_t attribute;
+    std::uint32_t isPublic;
+};
+
+
+namespace Details
+{
+    inline std::uint64_t alignedOffset(const std::uint64_t offset)
+    {
+        const auto a = BinarySystemHeader::alignment;
+        return (offset + a - 1) / a * a;
+    }
+
+    /// \brief Sequential writer placing every array at an aligned offset.
+    class BinarySystemWriter
+    {
+    public:
+        explicit BinarySystemWriter(const std::string& filename)
+            : file_(filename, std::ios::binary | std::ios::trunc)
+        {
+            if (!file_) {
+                OPM_THROW(std::runtime_error, "Could not open " << filename << " for writing.");
+            }
+            const BinarySystemHeader empty{};
+            write(&empty, sizeof(empty));
+        }
+
+        /// \brief Pad to the next aligned offset and return it.
+        std::uint64_t align()
+        {
+            static const char zeros[BinarySystemHeader::alignment] = {};
+            const auto aligned = alignedOffset(position_);
+            write(zeros, aligned - position_);
+            return aligned;
+        }
+
+        void write(const void* data, const std::size_t bytes)
+        {
+            file_.write(static_cast<const char*>(data), bytes);
+            check();
+            position_ += bytes;
+        }
+
+        void writeHeader(const BinarySystemHeader& header)
+        {
+            file_.seekp(0);
+            file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file_.flush();
+            check();
+        }
+
+    private:
+        //! \brief Stop at the first failed write, e.g. on a full disk, so
+        //! that no later offset refers to data that is not in the file.
+        void check()
+        {
+            if (!file_) {
+                OPM_THROW(std::runtime_error, "Writing a binary linear system failed.");
+            }
+        }
+
+        std::ofstream file_;
+        std::uint64_t position_ = 0;
+    };
+
+    /// \brief True if the blocks and column indices of all rows follow each
+    /// other in memory, as for matrices built row-wise or implicitly.
+    template <class Matrix>
+    bool isContiguous(const Matrix& matrix)
+    {
+        if (matrix.N() == 0 || matrix.nonzeroes() == 0) {
+            return false;
+        }
+        const auto* values = matrix[0].getptr();
+        const auto* columns = matrix[0].getindexptr();
+        std::size_t offset = 0;
+        for (std::size_t row = 0; row < matrix.N(); ++row) {
+            const auto size = matrix[row].size();
+            if (size == 0) {
+                continue;
+            }
+            if (matrix[row].getptr() != values + offset || matrix[row].getindexptr() != columns + offset) {
+                return false;
+            }
+            offset += size;
+        }
+        return true;
+    }
+
+    /// \brief Write the block-CSR arrays of a matrix, one write per array
+    /// if its storage is contiguous.
+    template <class Matrix>
+    void writeBlockCSR(BinarySystemWriter& writer, const Matrix& matrix,
+                       std::uint64_t& rowStartOffset, std::uint64_t& columnsOffset, std::uint64_t& valuesOffset)
+    {
+        using Block = typename Matrix::block_type;
+        static_assert(sizeof(Block) == Block::rows * Block::cols * sizeof(double),
+                      "The matrix blocks must be stored as contiguous doubles.");
+        static_assert(sizeof(typename Matrix::size_type) == sizeof(std::uint64_t),
+                      "The column indices must be 64 bit.");
+
+        std::vector<std::uint64_t> rowStart(matrix.N() + 1, 0);
+        for (std::size_t row = 0; row < matrix.N(); ++row) {
+            rowStart[row + 1] = rowStart[row] + matrix[row].size();
+        }
+        rowStartOffset = writer.align();
+        writer.write(rowStart.data(), rowStart.size() * sizeof(std::uint64_t));
+
+        const bool contiguous = isContiguous(matrix);
+        columnsOffset = writer.align();
+        if (contiguous) {
+            writer.write(matrix[0].getindexptr(), matrix.nonzeroes() * sizeof(std::uint64_t));
+        } else {
+            for (std::size_t row = 0; row < matrix.N(); ++row) {
+                writer.write(matrix[row].getindexptr(), matrix[row].size() * sizeof(std::uint64_t));
+            }
+        }
+        valuesOffset = writer.align();
+        if (contiguous) {
+            writer.write(matrix[0].getptr(), matrix.nonzeroes() * sizeof(Block));
+        } else {
+            for (std::size_t row = 0; row < matrix.N(); ++row) {
+                writer.write(matrix[row].getptr(), matrix[row].size() * sizeof(Block));
+            }
+        }
+    }
+} // namespace Details
+
+
+/// \brief Write the local part of a linear system in the binary format.
+///
+/// \param wells  Well contributions to be applied in addition to the
+///               matrix, or nullptr.
+/// \param comm   Parallel communication whose index set is stored, or
+///               nullptr in sequential runs.
+template <class Matrix, class Vector, class Communicator>
+void writeBinarySystem(const std::string& filename,
+                       const Matrix& matrix,
+                       const Vector& rhs,
+                       const Matrix* wells,
+                       [[maybe_unused]] const Communicator* comm)
+{
+    using Block = typename Matrix::block_type;
+    BinarySystemHeader header{};
+    std::copy(std::begin(BinarySystemHeader::magicString), std::end(BinarySystemHeader::magicString), header.magic);
+    header.version = BinarySystemHeader::currentVersion;
+    header.blockSize = Block::rows;
+    header.rank = 0;
+    header.numRanks = 1;
+    header.numRows = matrix.N();
+    header.nonzeroes = matrix.nonzeroes();
+
+    Details::BinarySystemWriter writer(filename);
+    Details::writeBlockCSR(writer, matrix, header.rowStart, header.columns, header.values);
+    header.rhs = writer.align();
+    if (rhs.size() > 0) {
+        writer.write(&rhs[0][0], rhs.size() * Block::rows * sizeof(double));
+    }
+    if (wells != nullptr) {
+        header.wellNonzeroes = wells->nonzeroes();
+        Details::writeBlockCSR(writer, *wells, header.wellRowStart, header.wellColumns, header.wellValues);
+    }
+
+#if HAVE_MPI
+    if (comm != nullptr) {
+        header.rank = comm->communicator().rank();
+        header.numRanks = comm->communicator().size();
+        std::vector<BinarySystemIndex> indices;
+        indices.reserve(comm->indexSet().size());
+        for (const auto& index : comm->indexSet()) {
+            indices.push_back({static_cast<std::int64_t>(index.global()),
+                               static_cast<std::uint64_t>(index.local().local()),
+                               static_cast<std::uint32_t>(index.local().attribute()),
+                               static_cast<std::uint32_t>(index.local().isPublic())});
+        }
+        header.numIndices = indices.size();
+        header.indices = writer.align();
+        writer.write(indices.data(), indices.size() * sizeof(BinarySystemIndex));
+
+        const auto& neighbourSet = comm->remoteIndices().getNeighbours();
+        const std::vector<std::int32_t> neighbours(neighbourSet.begin(), neighbourSet.end());
+        header.numNeighbours = neighbours.size();
+        header.neighbours = writer.align();
+        writer.write(neighbours.data(), neighbours.size() * sizeof(std::int32_t));
+    }
+#endif
+    writer.writeHeader(header);
+}
+
+
+/// \brief Read-only view of a binary linear system file mapped into memory.
+///
+/// The arrays can be used in place, without parsing. The conversion to
+/// ISTL types copies them, since a BCRSMatrix can not use external storage.
+/// All arrays of the header are checked to lie within the file and to be
+/// aligned for their type when the file is opened, and the row starts and
+/// column indices of a matrix before it is built, so that a truncated or
+/// corrupt file gives an exception rather than an invalid memory access.
+class MappedBinarySystem
+{
+public:
+    explicit MappedBinarySystem(const std::string& filename)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            OPM_THROW(std::runtime_error, "Could not open " << filename);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(BinarySystemHeader)) {
+            ::close(fd);
+            OPM_THROW(std::runtime_error, filename << " is not a binary linear system.");
+        }
+        size_ = status.st_size;
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            OPM_THROW(std::runtime_error, "Could not map " << filename << " into memory.");
+        }
+        const auto& h = header();
+        if (std::memcmp(h.magic, BinarySystemHeader::magicString, sizeof(h.magic)) != 0
+            || h.version != BinarySystemHeader::currentVersion) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+            OPM_THROW(std::runtime_error, filename << " is not a binary linear system of version "
+                      << BinarySystemHeader::currentVersion << ".");
+        }
+        try {
+            checkArrays();
+        } catch (...) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+            throw;
+        }
+    }
+
+    ~MappedBinarySystem()
+    {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    MappedBinarySystem(const MappedBinarySystem&) = delete;
+    MappedBinarySystem& operator=(const MappedBinarySystem&) = delete;
+
+    const BinarySystemHeader& header() const
+    {
+        return *static_cast<const BinarySystemHeader*>(data_);
+    }
+
+    /// \brief The array of count elements starting at the given offset of the header.
+    ///
+    /// Throws if the array does not lie within the file or is not aligned for T.
+    template <class T>
+    const T* array(const std::uint64_t offset, const std::uint64_t count) const
+    {
+        checkArray(offset, count, sizeof(T), alignof(T));
+        return reinterpret_cast<const T*>(static_cast<const char*>(data_) + offset);
+    }
+
+    bool hasWells() const
+    {
+        return header().wellRowStart != 0;
+    }
+
+    template <class Matrix>
+    Matrix matrix() const
+    {
+        const auto& h = header();
+        return makeMatrix<Matrix>(h.rowStart, h.columns, h.values, h.nonzeroes);
+    }
+
+    template <class Matrix>
+    Matrix wells() const
+    {
+        const auto& h = header();
+        if (!hasWells()) {
+            OPM_THROW(std::logic_error, "The binary linear system has no well contributions.");
+        }
+        return makeMatrix<Matrix>(h.wellRowStart, h.wellColumns, h.wellValues, h.wellNonzeroes);
+    }
+
+    template <class Vector>
+    Vector rhs() const
+    {
+        using Block = typename Vector::block_type;
+        checkBlockSize(Block::dimension);
+        const auto& h = header();
+        Vector result(h.numRows);
+        const auto* values = array<Block>(h.rhs, h.numRows);
+        std::copy(values, values + h.numRows, result.begin());
+        return result;
+    }
+
+#if HAVE_MPI
+    /// \brief Restore the index set, and the remote indices, of the
+    /// process that wrote the file.
+    template <class Communication>
+    void setupCommunication(Communication& comm) const
+    {
+        using IndexSet = typename Communication::ParallelIndexSet;
+        using LocalIndex = typename IndexSet::LocalIndex;
+        using Attribute = Dune::OwnerOverlapCopyAttributeSet::AttributeSet;
+        const auto& h = header();
+        if (h.rank != comm.communicator().rank() || h.numRanks != comm.communicator().size()) {
+            OPM_THROW(std::runtime_error, "The binary linear system was written by rank " << h.rank << " of "
+                      << h.numRanks << " processes.");
+        }
+        const auto* indices = array<BinarySystemIndex>(h.indices, h.numIndices);
+        comm.indexSet().beginResize();
+        for (std::uint64_t i = 0; i < h.numIndices; ++i) {
+            comm.indexSet().add(indices[i].global,
+                                LocalIndex(indices[i].local, static_cast<Attribute>(indices[i].attribute),
+                                           indices[i].isPublic != 0));
+        }
+        comm.indexSet().endResize();
+        const auto* neighbours = array<std::int32_t>(h.neighbours, h.numNeighbours);
+        comm.remoteIndices().setNeighbours(std::set<int>(neighbours, neighbours + h.numNeighbours));
+        comm.remoteIndices().template rebuild<false>();
+    }
+#endif
+
+private:
+    void checkBlockSize(const std::uint32_t blockSize) const
+    {
+        if (header().blockSize != blockSize) {
+            OPM_THROW(std::runtime_error, "The binary linear system has block size " << header().blockSize
+                      << ", expected " << blockSize << ".");
+        }
+    }
+
+    void checkArray(const std::uint64_t offset, const std::uint64_t count,
+                    const std::uint64_t elementSize, const std::uint64_t elementAlignment) const
+    {
+        if (count == 0) {
+            return;
+        }
+        if (offset < sizeof(BinarySystemHeader) || offset > size_ || count > (size_ - offset) / elementSize) {
+            OPM_THROW(std::runtime_error, "The binary linear system is truncated or corrupt: an array of "
+                      << count << " elements of " << elementSize << " bytes at offset " << offset
+                      << " does not fit into the " << size_ << " bytes of the file.");
+        }
+        if (offset % elementAlignment != 0) {
+            OPM_THROW(std::runtime_error, "The binary linear system is corrupt: the array at offset "
+                      << offset << " is not aligned to " << elementAlignment << " bytes.");
+        }
+    }
+
+    /// \brief Check the arrays given by the header, with the block size of the file.
+    void checkArrays() const
+    {
+        const auto& h = header();
+        // Real block sizes are small, and this keeps the block sizes in bytes from overflowing.
+        if (h.blockSize == 0 || h.blockSize > 1024) {
+            OPM_THROW(std::runtime_error, "The binary linear system is corrupt: invalid block size "
+                      << h.blockSize << ".");
+        }
+        if (h.numRows == std::numeric_limits<std::uint64_t>::max()) {
+            OPM_THROW(std::runtime_error, "The binary linear system is corrupt: invalid number of rows.");
+        }
+        const std::uint64_t blockBytes = std::uint64_t(h.blockSize) * h.blockSize * sizeof(double);
+        const std::uint64_t vectorBlockBytes = std::uint64_t(h.blockSize) * sizeof(double);
+        checkArray(h.rowStart, h.numRows + 1, sizeof(std::uint64_t), alignof(std::uint64_t));
+        checkArray(h.columns, h.nonzeroes, sizeof(std::uint64_t), alignof(std::uint64_t));
+        checkArray(h.values, h.nonzeroes, blockBytes, alignof(double));
+        checkArray(h.rhs, h.numRows, vectorBlockBytes, alignof(double));
+        if (hasWells()) {
+            checkArray(h.wellRowStart, h.numRows + 1, sizeof(std::uint64_t), alignof(std::uint64_t));
+            checkArray(h.wellColumns, h.wellNonzeroes, sizeof(std::uint64_t), alignof(std::uint64_t));
+            checkArray(h.wellValues, h.wellNonzeroes, blockBytes, alignof(double));
+        }
+        checkArray(h.indices, h.numIndices, sizeof(BinarySystemIndex), alignof(BinarySystemIndex));
+        checkArray(h.neighbours, h.numNeighbours, sizeof(std::int32_t), alignof(std::int32_t));
+    }
+
+    template <class Matrix>
+    Matrix makeMatrix(const std::uint64_t rowStartOffset, const std::uint64_t columnsOffset,
+                      const std::uint64_t valuesOffset, const std::uint64_t nonzeroes) const
+    {
+        using Block = typename Matrix::block_type;
+        checkBlockSize(Block::rows);
+        const auto numRows = header().numRows;
+        const auto* rowStart = array<std::uint64_t>(rowStartOffset, numRows + 1);
+        const auto* columns = array<std::uint64_t>(columnsOffset, nonzeroes);
+        const auto* blocks = array<Block>(valuesOffset, nonzeroes);
+        if (rowStart[0] != 0 || rowStart[numRows] != nonzeroes) {
+            OPM_THROW(std::runtime_error, "The binary linear system is corrupt: the row starts do not match the "
+                      << nonzeroes << " nonzeroes.");
+        }
+        for (std::uint64_t row = 0; row < numRows; ++row) {
+            if (rowStart[row + 1] < rowStart[row]) {
+                OPM_THROW(std::runtime_error, "The binary linear system is corrupt: row " << row
+                          << " has a negative size.");
+            }
+        }
+        for (std::uint64_t k = 0; k < nonzeroes; ++k) {
+            if (columns[k] >= numRows) {
+                OPM_THROW(std::runtime_error, "The binary linear system is corrupt: column index "
+                          << columns[k] << " of " << numRows << " rows.");
+            }
+        }
+        Matrix matrix(numRows, numRows, nonzeroes, Matrix::row_wise);
+        for (auto row = matrix.createbegin(); row != matrix.createend(); ++row) {
+            for (auto k = rowStart[row.index()]; k < rowStart[row.index() + 1]; ++k) {
+                row.insert(columns[k]);
+            }
+        }
+        for (std::size_t row = 0; row < numRows; ++row) {
+            std::copy(blocks + rowStart[row], blocks + rowStart[row + 1], matrix[row].getptr());
+        }
+        return matrix;
+    }
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace Opm
+
+#endif // OPM_BINARYSYSTEMFILE_HEADER_INCLUDED
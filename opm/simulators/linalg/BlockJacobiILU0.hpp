@@ -0,0 +1,378 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BLOCKJACOBIILU0_HEADER_INCLUDED
+#define OPM_BLOCKJACOBIILU0_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/PreconditionerWithUpdate.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/common/version.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/ilu.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm
+{
+
+/// \brief Named partitions for BlockJacobiILU0.
+///
+/// The "partition" parameter of the BlockJacobiILU0 preconditioner in the
+/// preconditioner factory names a partition added here. The partition is
+/// shared by all preconditioners created with it, whatever their matrix and
+/// operator types, so it is neither copied nor converted when a solver is
+/// created.
+class BlockJacobiPartitions
+{
+public:
+    /// \brief Add or replace the partition with the given name.
+    static void add(const std::string& name, std::shared_ptr<const std::vector<int>> partition)
+    {
+        partitions()[name] = std::move(partition);
+    }
+
+    /// \brief The partition with the given name.
+    static std::shared_ptr<const std::vector<int>> get(const std::string& name)
+    {
+        const auto it = partitions().find(name);
+        if (it == partitions().end()) {
+            OPM_THROW(std::invalid_argument, "BlockJacobiILU0: unknown partition " << name << ".");
+        }
+        return it->second;
+    }
+
+private:
+    static std::map<std::string, std::shared_ptr<const std::vector<int>>>& partitions()
+    {
+        static std::map<std::string, std::shared_ptr<const std::vector<int>>> named;
+        return named;
+    }
+};
+
+/// \brief Block-Jacobi preconditioner with an ILU0 factorization of every block.
+///
+/// The rows are split into blocks by a partition, typically the Zoltan
+/// partition of the cells that the GPU solvers use for --num-jacobi-blocks.
+/// The couplings between different blocks are dropped, so the blocks are
+/// factored and solved independently, one block per OpenMP thread at a time.
+/// This gives parallelism within a process without changing the MPI
+/// decomposition, at the price of a somewhat weaker preconditioner than
+/// ILU0 of the whole matrix. The pattern of the blocks is set up again by
+/// update() whenever the sparsity pattern of the matrix changed.
+///
+/// \tparam Matrix The type of the Matrix.
+/// \tparam Domain The type of the Vector representing the domain.
+/// \tparam Range The type of the Vector representing the range.
+template <class Matrix, class Domain, class Range>
+class BlockJacobiILU0 : public Dune::PreconditionerWithUpdate<Domain, Range>
+{
+public:
+    //! \brief The matrix type the preconditioner is for.
+    using matrix_type = typename std::remove_const<Matrix>::type;
+    //! \brief The domain type of the preconditioner.
+    using domain_type = Domain;
+    //! \brief The range type of the preconditioner.
+    using range_type = Range;
+    //! \brief The field type of the preconditioner.
+    using field_type = typename Domain::field_type;
+
+    using block_type = typename matrix_type::block_type;
+    using size_type = typename matrix_type::size_type;
+
+    /*! \brief Constructor with a shared partition.
+
+      \param A The matrix to operate on.
+      \param partition The block of every row, numbered from 0. It is
+                       shared, not copied, e.g. with the other solvers
+                       created for the same matrix.
+      \param w The relaxation factor.
+    */
+    BlockJacobiILU0(const Matrix& A, std::shared_ptr<const std::vector<int>> partition, const field_type w)
+        : A_(A)
+        , partition_(std::move(partition))
+        , w_(w)
+    {
+        if (!partition_ || partition_->size() != A_.N()) {
+            OPM_THROW(std::invalid_argument, "BlockJacobiILU0: the partition has "
+                      << (partition_ ? partition_->size() : 0)
+                      << " entries for a matrix with " << A_.N() << " rows.");
+        }
+        if (!partition_->empty() && *std::min_element(partition_->begin(), partition_->end()) < 0) {
+            OPM_THROW(std::invalid_argument, "BlockJacobiILU0: negative block in the partition.");
+        }
+        update();
+    }
+
+    /*! \brief Constructor.
+
+      \param A The matrix to operate on.
+      \param partition The block of every row, numbered from 0.
+      \param w The relaxation factor.
+    */
+    BlockJacobiILU0(const Matrix& A, std::vector<int> partition, const field_type w)
+        : BlockJacobiILU0(A, std::make_shared<const std::vector<int>>(std::move(partition)), w)
+    {
+    }
+
+    /*! \brief Constructor with a partition into consecutive rows.
+
+      \param A The matrix to operate on.
+      \param numBlocks The number of blocks, 0 for the number of OpenMP threads.
+      \param w The relaxation factor.
+    */
+    BlockJacobiILU0(const Matrix& A, const int numBlocks, const field_type w)
+        : BlockJacobiILU0(A, contiguousPartition(A, numBlocks), w)
+    {
+    }
+
+    /// \brief Split the rows into consecutive ranges with about the same number of nonzeros.
+    static std::vector<int> contiguousPartition(const Matrix& A, int numBlocks)
+    {
+        if (numBlocks <= 0) {
+#ifdef _OPENMP
+            numBlocks = omp_get_max_threads();
+#else
+            numBlocks = 1;
+#endif
+        }
+        std::vector<int> partition(A.N(), 0);
+        const double nonzeroesPerBlock = static_cast<double>(A.nonzeroes()) / numBlocks;
+        size_type nonzeroes = 0;
+        for (auto row = A.begin(); row != A.end(); ++row) {
+            partition[row.index()] = std::min(static_cast<int>(nonzeroes / nonzeroesPerBlock), numBlocks - 1);
+            nonzeroes += row->size();
+        }
+        return partition;
+    }
+
+    void pre(Domain&, Range&) override
+    {
+    }
+
+    void apply(Domain& v, const Range& d) override
+    {
+        const std::ptrdiff_t numBlocks = blocks_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t b = 0; b < numBlocks; ++b) {
+            auto& block = blocks_[b];
+            const auto& ilu = *block.ilu;
+            const size_type n = block.rows.size();
+
+            // Solve Ly = d, L having a unit diagonal.
+            for (size_type i = 0; i < n; ++i) {
+                auto rhs = d[block.rows[i]];
+                const auto& row = ilu[i];
+                for (auto col = row.begin(); col.index() < i; ++col) {
+                    col->mmv(block.y[col.index()], rhs);
+                }
+                block.y[i] = rhs;
+            }
+
+            // Solve Ux = y, the diagonal holding the inverted diagonal of U.
+            for (size_type i = n; i-- > 0;) {
+                auto rhs = block.y[i];
+                const auto& row = ilu[i];
+                auto col = row.end();
+                for (--col; col.index() > i; --col) {
+                    col->mmv(block.y[col.index()], rhs);
+                }
+                // col is at the diagonal, and y_i is no longer needed.
+                col->mv(rhs, block.y[i]);
+                v[block.rows[i]] = block.y[i];
+                v[block.rows[i]] *= w_;
+            }
+        }
+    }
+
+    void post(Domain&) override
+    {
+    }
+
+    void update() override
+    {
+        if (blocks_.empty() || patternChanged()) {
+            buildBlocks();
+        }
+        const auto& partition = *partition_;
+        const std::ptrdiff_t numBlocks = blocks_.size();
+        // Exceptions must not leave the parallel region, they are rethrown after it.
+        std::vector<std::exception_ptr> failures(numBlocks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t b = 0; b < numBlocks; ++b) {
+            auto& block = blocks_[b];
+            auto& ilu = *block.ilu;
+            // The local numbering keeps the order of the rows, so the
+            // entries of a block come in the same order as in A.
+            for (size_type i = 0; i < block.rows.size(); ++i) {
+                auto local = ilu[i].begin();
+                const auto& row = A_[block.rows[i]];
+                for (auto col = row.begin(); col != row.end(); ++col) {
+                    if (partition[col.index()] == static_cast<int>(b)) {
+                        *local = *col;
+                        ++local;
+                    }
+                }
+            }
+            try {
+#if DUNE_VERSION_LT(DUNE_GRID, 2, 8)
+                bilu0_decomposition(ilu);
+#else
+                Dune::ILU::blockILU0Decomposition(ilu);
+#endif
+            }
+            catch (...) {
+                failures[b] = std::current_exception();
+            }
+        }
+        for (const auto& failure : failures) {
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return Dune::SolverCategory::sequential;
+    }
+
+    /// \brief The number of independent blocks.
+    std::size_t numBlocks() const
+    {
+        return blocks_.size();
+    }
+
+private:
+    struct Block
+    {
+        //! \brief The rows of A in this block, in increasing order.
+        std::vector<size_type> rows;
+        //! \brief The diagonal block of A, overwritten by its ILU0 factors.
+        std::unique_ptr<matrix_type> ilu;
+        //! \brief Work vector of the triangular solves.
+        Range y;
+    };
+
+    /// \brief True if the sparsity pattern of A differs from the one of the blocks.
+    bool patternChanged() const
+    {
+        if (A_.N() + 1 != rowStart_.size() || A_.nonzeroes() != columns_.size()) {
+            return true;
+        }
+        for (size_type row = 0; row < A_.N(); ++row) {
+            if (A_[row].size() != rowStart_[row + 1] - rowStart_[row]) {
+                return true;
+            }
+            auto column = columns_.begin() + rowStart_[row];
+            for (auto col = A_[row].begin(); col != A_[row].end(); ++col, ++column) {
+                if (col.index() != *column) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// \brief Set up the local numbering and the pattern of every block.
+    /// Only done when the pattern of A changes.
+    void buildBlocks()
+    {
+        const auto& partition = *partition_;
+        const int numBlocks = partition.empty() ? 0 : *std::max_element(partition.begin(), partition.end()) + 1;
+        blocks_.clear();
+        blocks_.resize(numBlocks);
+        localIndex_.resize(A_.N());
+        for (size_type row = 0; row < A_.N(); ++row) {
+            if (A_[row].find(row) == A_[row].end()) {
+                OPM_THROW(std::logic_error, "BlockJacobiILU0: diagonal entry missing in row " << row);
+            }
+            auto& rows = blocks_[partition[row]].rows;
+            localIndex_[row] = rows.size();
+            rows.push_back(row);
+        }
+        rowStart_.assign(1, 0);
+        columns_.clear();
+        columns_.reserve(A_.nonzeroes());
+        for (auto row = A_.begin(); row != A_.end(); ++row) {
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                columns_.push_back(col.index());
+            }
+            rowStart_.push_back(columns_.size());
+        }
+
+        const std::ptrdiff_t count = numBlocks;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t b = 0; b < count; ++b) {
+            auto& block = blocks_[b];
+            const size_type n = block.rows.size();
+            size_type blockNonzeroes = 0;
+            for (const auto row : block.rows) {
+                for (auto col = A_[row].begin(); col != A_[row].end(); ++col) {
+                    blockNonzeroes += partition[col.index()] == static_cast<int>(b);
+                }
+            }
+            block.ilu = std::make_unique<matrix_type>(n, n, blockNonzeroes, matrix_type::row_wise);
+            auto local = block.rows.begin();
+            for (auto row = block.ilu->createbegin(); row != block.ilu->createend(); ++row, ++local) {
+                for (auto col = A_[*local].begin(); col != A_[*local].end(); ++col) {
+                    if (partition[col.index()] == static_cast<int>(b)) {
+                        row.insert(localIndex_[col.index()]);
+                    }
+                }
+            }
+            block.y.resize(n);
+        }
+    }
+
+    const Matrix& A_;
+    std::shared_ptr<const std::vector<int>> partition_;
+    field_type w_;
+
+    std::vector<Block> blocks_;
+    //! \brief The index of every row within its block.
+    std::vector<size_type> localIndex_;
+    //! \brief The sparsity pattern of A the blocks were set up for.
+    std::vector<size_type> rowStart_;
+    std::vector<size_type> columns_;
+};
+
+} // namespace Opm
+
+#endif // OPM_BLOCKJACOBIILU0_HEADER_INCLUDED
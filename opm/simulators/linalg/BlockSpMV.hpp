@@ -0,0 +1,106 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BLOCKSPMV_HEADER_INCLUDED
+#define OPM_BLOCKSPMV_HEADER_INCLUDED
+
+#include <array>
+#include <cstddef>
+
+namespace Opm
+{
+
+namespace detail
+{
+
+/// \brief Fewer rows than this are not worth the threading overhead.
+constexpr std::ptrdiff_t spmvMinRowsForThreads = 64;
+
+/// \brief Compute the product of one block row of A with x.
+///
+/// The block size is a compile time constant, hence the loops over
+/// the block entries are fully unrolled and the accumulation can be
+/// vectorised by the compiler. The blocks and column indices of the
+/// row are accessed through the contiguous storage of the BCRSMatrix.
+template <int N, class Row, class X>
+std::array<double, N> blockRowProduct(const Row& row, const X& x)
+{
+    std::array<double, N> acc{};
+    const auto* blocks = row.getptr();
+    const auto* cols = row.getindexptr();
+    const std::size_t size = row.size();
+    for (std::size_t k = 0; k < size; ++k) {
+        const auto& block = blocks[k];
+        const auto& xBlock = x[cols[k]];
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                acc[i] += block[i][j] * xBlock[j];
+            }
+        }
+    }
+    return acc;
+}
+
+} // namespace detail
+
+/// \brief y = A x for the first numRows block rows of A.
+///
+/// Specialised at compile time on the block size of the matrix and
+/// threaded over the rows with OpenMP, unless there are only a few rows.
+template <class Matrix, class X, class Y>
+void blockSpMV(const Matrix& A, const X& x, Y& y, const std::size_t numRows)
+{
+    constexpr int N = Matrix::block_type::rows;
+    static_assert(N == Matrix::block_type::cols, "Only square blocks are supported");
+#ifdef _OPENMP
+#pragma omp parallel for if(static_cast<std::ptrdiff_t>(numRows) > detail::spmvMinRowsForThreads)
+#endif
+    for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(numRows); ++row) {
+        const auto acc = detail::blockRowProduct<N>(A[row], x);
+        auto& yBlock = y[row];
+        for (int i = 0; i < N; ++i) {
+            yBlock[i] = acc[i];
+        }
+    }
+}
+
+/// \brief y += alpha A x for the first numRows block rows of A.
+///
+/// The scaling and the update of y are fused with the product, so
+/// that y is only read and written once per row.
+template <class Matrix, class X, class Y>
+void blockSpMVScaleAdd(const double alpha, const Matrix& A, const X& x, Y& y, const std::size_t numRows)
+{
+    constexpr int N = Matrix::block_type::rows;
+    static_assert(N == Matrix::block_type::cols, "Only square blocks are supported");
+#ifdef _OPENMP
+#pragma omp parallel for if(static_cast<std::ptrdiff_t>(numRows) > detail::spmvMinRowsForThreads)
+#endif
+    for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(numRows); ++row) {
+        const auto acc = detail::blockRowProduct<N>(A[row], x);
+        auto& yBlock = y[row];
+        for (int i = 0; i < N; ++i) {
+            yBlock[i] += alpha * acc[i];
+        }
+    }
+}
+
+} // namespace Opm
+
+#endif // OPM_BLOCKSPMV_HEADER_INCLUDED
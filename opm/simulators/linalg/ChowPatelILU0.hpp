@@ -0,0 +1,318 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CHOWPATELILU0_HEADER_INCLUDED
+#define OPM_CHOWPATELILU0_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/PreconditionerWithUpdate.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Fine-grained parallel block ILU0 preconditioner on the CPU.
+///
+/// This is a CPU version of the iterative ILU0 factorization of
+///     E. Chow and A. Patel, Fine-grained parallel incomplete LU
+///     factorization, SIAM J. Sci. Comput. 37 (2015), C169-C193,
+/// that is implemented for OpenCL in bda/opencl/ChowPatelIlu.cpp.
+///
+/// The entries of L (unit lower triangular) and U are computed by a
+/// number of Jacobi-style fixed-point sweeps over the nonzero pattern
+/// of A. All entries of one sweep only depend on the previous sweep,
+/// hence the rows are distributed among the OpenMP threads. The
+/// triangular solves of apply() are likewise replaced by a fixed number
+/// of Jacobi iterations, which only need matrix-vector products.
+///
+/// \tparam Matrix The type of the Matrix.
+/// \tparam Domain The type of the Vector representing the domain.
+/// \tparam Range The type of the Vector representing the range.
+template <class Matrix, class Domain, class Range>
+class ChowPatelILU0 : public Dune::PreconditionerWithUpdate<Domain, Range>
+{
+public:
+    //! \brief The matrix type the preconditioner is for.
+    using matrix_type = typename std::remove_const<Matrix>::type;
+    //! \brief The domain type of the preconditioner.
+    using domain_type = Domain;
+    //! \brief The range type of the preconditioner.
+    using range_type = Range;
+    //! \brief The field type of the preconditioner.
+    using field_type = typename Domain::field_type;
+
+    using block_type = typename matrix_type::block_type;
+    using size_type = typename matrix_type::size_type;
+
+    /*! \brief Constructor.
+
+      \param A The matrix to operate on.
+      \param sweeps The number of fixed-point sweeps of the factorization.
+      \param applySweeps The number of Jacobi iterations used for each of
+                         the two triangular solves in apply.
+      \param w The relaxation factor.
+    */
+    ChowPatelILU0(const Matrix& A, const int sweeps, const int applySweeps, const field_type w)
+        : A_(A)
+        , sweeps_(sweeps)
+        , applySweeps_(applySweeps)
+        , w_(w)
+    {
+        update();
+    }
+
+    void pre(Domain&, Range&) override
+    {
+    }
+
+    void apply(Domain& v, const Range& d) override
+    {
+        const std::ptrdiff_t numRows = rows_.size() - 1;
+        y_.resize(d.size());
+        tmp_.resize(d.size());
+        x_.resize(v.size());
+        xNew_.resize(v.size());
+
+        // Solve Ly = d approximately: y <- d - (L - I) y.
+        y_ = d;
+        for (int sweep = 0; sweep < applySweeps_; ++sweep) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+                auto rhs = d[row];
+                for (size_type ij = rows_[row]; ij < diagonal_[row]; ++ij) {
+                    lu_[ij].mmv(y_[cols_[ij]], rhs);
+                }
+                tmp_[row] = rhs;
+            }
+            std::swap(y_, tmp_);
+        }
+
+        // Solve Ux = y approximately: x <- D^-1 (y - (U - D) x).
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            invDiagonal_[row].mv(y_[row], x_[row]);
+        }
+        for (int sweep = 0; sweep < applySweeps_; ++sweep) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+                auto rhs = y_[row];
+                for (size_type ij = diagonal_[row] + 1; ij < rows_[row + 1]; ++ij) {
+                    lu_[ij].mmv(x_[cols_[ij]], rhs);
+                }
+                invDiagonal_[row].mv(rhs, xNew_[row]);
+            }
+            std::swap(x_, xNew_);
+        }
+
+        v = x_;
+        v *= w_;
+    }
+
+    void post(Domain&) override
+    {
+    }
+
+    void update() override
+    {
+        if (rows_.empty() || patternChanged()) {
+            buildPattern();
+        }
+        const std::ptrdiff_t numRows = A_.N();
+
+        // Flat copy of the values of A, in the order of the pattern.
+        aValues_.resize(cols_.size());
+        for (auto row = A_.begin(); row != A_.end(); ++row) {
+            size_type ij = rows_[row.index()];
+            for (auto col = row->begin(); col != row->end(); ++col, ++ij) {
+                aValues_[ij] = *col;
+            }
+        }
+
+        // Initial guess: U = upper(A), L = lower(A) D^-1.
+        computeInverseDiagonal(aValues_);
+        lu_ = aValues_;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            for (size_type ij = rows_[row]; ij < diagonal_[row]; ++ij) {
+                lu_[ij].rightmultiply(invDiagonal_[cols_[ij]]);
+            }
+        }
+
+        luNew_.resize(lu_.size());
+        for (int sweep = 0; sweep < sweeps_; ++sweep) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+                for (size_type ij = rows_[row]; ij < rows_[row + 1]; ++ij) {
+                    block_type s = aValues_[ij];
+                    for (size_type p = productStart_[ij]; p < productStart_[ij + 1]; ++p) {
+                        block_type product = lu_[products_[p].first];
+                        product.rightmultiply(lu_[products_[p].second]);
+                        s -= product;
+                    }
+                    if (ij < diagonal_[row]) {
+                        // L_ij = (A_ij - sum_k L_ik U_kj) U_jj^-1
+                        s.rightmultiply(invDiagonal_[cols_[ij]]);
+                    }
+                    luNew_[ij] = s;
+                }
+            }
+            std::swap(lu_, luNew_);
+            computeInverseDiagonal(lu_);
+        }
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return Dune::SolverCategory::sequential;
+    }
+
+private:
+    /// \brief True if the sparsity pattern of A differs from the stored one.
+    bool patternChanged() const
+    {
+        if (A_.N() + 1 != rows_.size() || A_.nonzeroes() != cols_.size()) {
+            return true;
+        }
+        for (size_type row = 0; row < A_.N(); ++row) {
+            if (A_[row].size() != rows_[row + 1] - rows_[row]) {
+                return true;
+            }
+            auto column = cols_.begin() + rows_[row];
+            for (auto col = A_[row].begin(); col != A_[row].end(); ++col, ++column) {
+                if (col.index() != *column) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// \brief Set up the CRS pattern and, for every nonzero (i, j), the
+    /// pairs of offsets (ik, kj) with k < min(i, j) that enter the sum of
+    /// its fixed-point equation. Only done when the pattern changes.
+    void buildPattern()
+    {
+        const size_type numRows = A_.N();
+        rows_.assign(numRows + 1, 0);
+        cols_.clear();
+        cols_.reserve(A_.nonzeroes());
+        diagonal_.assign(numRows, 0);
+        for (auto row = A_.begin(); row != A_.end(); ++row) {
+            bool hasDiagonal = false;
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                if (col.index() == row.index()) {
+                    diagonal_[row.index()] = cols_.size();
+                    hasDiagonal = true;
+                }
+                cols_.push_back(col.index());
+            }
+            if (!hasDiagonal) {
+                OPM_THROW(std::logic_error, "ChowPatelILU0: diagonal entry missing in row " << row.index());
+            }
+            rows_[row.index() + 1] = cols_.size();
+        }
+
+        std::vector<std::vector<std::pair<size_type, size_type>>> products(cols_.size());
+        std::vector<std::ptrdiff_t> position(numRows, -1);
+        for (size_type i = 0; i < numRows; ++i) {
+            for (size_type ij = rows_[i]; ij < rows_[i + 1]; ++ij) {
+                position[cols_[ij]] = ij;
+            }
+            for (size_type ik = rows_[i]; ik < diagonal_[i]; ++ik) {
+                const size_type k = cols_[ik];
+                for (size_type kj = diagonal_[k] + 1; kj < rows_[k + 1]; ++kj) {
+                    // k < j holds since kj is in the strict upper part of row k.
+                    const auto ij = position[cols_[kj]];
+                    if (ij >= 0) {
+                        products[ij].emplace_back(ik, kj);
+                    }
+                }
+            }
+            for (size_type ij = rows_[i]; ij < rows_[i + 1]; ++ij) {
+                position[cols_[ij]] = -1;
+            }
+        }
+
+        productStart_.assign(cols_.size() + 1, 0);
+        products_.clear();
+        for (size_type ij = 0; ij < cols_.size(); ++ij) {
+            products_.insert(products_.end(), products[ij].begin(), products[ij].end());
+            productStart_[ij + 1] = products_.size();
+        }
+        invDiagonal_.resize(numRows);
+    }
+
+    void computeInverseDiagonal(const std::vector<block_type>& values)
+    {
+        const std::ptrdiff_t numRows = invDiagonal_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            invDiagonal_[row] = values[diagonal_[row]];
+            invDiagonal_[row].invert();
+        }
+    }
+
+    const Matrix& A_;
+    int sweeps_;
+    int applySweeps_;
+    field_type w_;
+
+    //! \brief The pattern of A in CRS format, diagonal_ holds the offset of the diagonal in each row.
+    std::vector<size_type> rows_;
+    std::vector<size_type> cols_;
+    std::vector<size_type> diagonal_;
+    //! \brief The (ik, kj) offset pairs of the fixed-point equation of each nonzero.
+    std::vector<size_type> productStart_;
+    std::vector<std::pair<size_type, size_type>> products_;
+
+    //! \brief The values of A and of the combined factors L and U.
+    std::vector<block_type> aValues_;
+    std::vector<block_type> lu_;
+    std::vector<block_type> luNew_;
+    //! \brief The inverted diagonal blocks of U.
+    std::vector<block_type> invDiagonal_;
+
+    Range y_;
+    Range tmp_;
+    Domain x_;
+    Domain xNew_;
+};
+
+} // namespace Opm
+
+#endif // OPM_CHOWPATELILU0_HEADER_INCLUDED
@@ -31,6 +31,13 @@
 namespace Dune
 {
 
+template <class X>
+class NonBlockingDotProducts;
+template <class X>
+struct RecycleSpace;
+template <class X>
+class RecyclingGMResSolver;
+
 /// A solver class that encapsulates all needed objects for a linear solver
 /// (operator, scalar product, iterative solver and preconditioner) and sets
 /// them up based on runtime parameters, using the PreconditionerFactory for
@@ -48,7 +55,7 @@ public:
     /// Create a sequential solver.
     FlexibleSolver(Operator& op,
                    const Opm::PropertyTree& prm,
-                   const std::function<VectorType()>& weightsCalculator,
+                   const std::function<void(VectorType&)>& weightsCalculator,
                    std::size_t pressureIndex);
 
     /// Create a parallel solver (if Comm is e.g. OwnerOverlapCommunication).
@@ -56,7 +63,7 @@ public:
     FlexibleSolver(Operator& op,
                    const Comm& comm,
                    const Opm::PropertyTree& prm,
-                   const std::function<VectorType()>& weightsCalculator,
+                   const std::function<void(VectorType&)>& weightsCalculator,
                    std::size_t pressureIndex);
 
     virtual void apply(VectorType& x, VectorType& rhs, Dune::InverseOperatorResult& res) override;
@@ -66,6 +73,10 @@ public:
     /// Access the contained preconditioner.
     AbstractPrecondType& preconditioner();
 
+    /// Let the "recycling_gmres" solver use the given recycled subspace, which
+    /// may outlive this solver. Has no effect for the other solvers.
+    void setRecycleSpace(const std::shared_ptr<RecycleSpace<VectorType>>& space);
+
     virtual Dune::SolverCategory::Category category() const override;
 
 private:
@@ -75,28 +86,36 @@ private:
     // Machinery for making sequential or parallel operators/preconditioners/scalar products.
     template <class Comm>
     void initOpPrecSp(Operator& op, const Opm::PropertyTree& prm,
-                      const std::function<VectorType()> weightsCalculator, const Comm& comm,
+                      const std::function<void(VectorType&)> weightsCalculator, const Comm& comm,
                       std::size_t pressureIndex);
 
     void initOpPrecSp(Operator& op, const Opm::PropertyTree& prm,
-                      const std::function<VectorType()> weightsCalculator, const Dune::Amg::SequentialInformation&,
+                      const std::function<void(VectorType&)> weightsCalculator, const Dune::Amg::SequentialInformation&,
                       std::size_t pressureIndex);
 
     void initSolver(const Opm::PropertyTree& prm, const bool is_iorank);
 
+    // Set up an iterative refinement around a single precision solve.
+    template <class Comm>
+    void initMixedPrecision(Operator& op, const Opm::PropertyTree& prm,
+                            const std::function<void(VectorType&)> weightsCalculator, const Comm& comm,
+                            std::size_t pressureIndex);
+
     // Main initialization routine.
     // Call with Comm == Dune::Amg::SequentialInformation to get a serial solver.
     template <class Comm>
     void init(Operator& op,
               const Comm& comm,
               const Opm::PropertyTree& prm,
-              const std::function<VectorType()> weightsCalculator,
+              const std::function<void(VectorType&)> weightsCalculator,
               std::size_t pressureIndex);
 
     Operator* linearoperator_for_solver_;
     std::shared_ptr<AbstractPrecondType> preconditioner_;
     std::shared_ptr<AbstractScalarProductType> scalarproduct_;
+    std::shared_ptr<NonBlockingDotProducts<VectorType>> dotproducts_;
     std::shared_ptr<AbstractSolverType> linsolver_;
+    RecyclingGMResSolver<VectorType>* recyclingsolver_ = nullptr;
 };
 
 } // namespace Dune
@@ -24,7 +24,10 @@
 #include <opm/simulators/linalg/matrixblock.hh>
 #include <opm/simulators/linalg/ilufirstelement.hh>
 #include <opm/simulators/linalg/FlexibleSolver.hpp>
+#include <opm/simulators/linalg/MixedPrecisionSolver.hpp>
+#include <opm/simulators/linalg/PipelinedSolvers.hpp>
 #include <opm/simulators/linalg/PreconditionerFactory.hpp>
+#include <opm/simulators/linalg/RecyclingGMResSolver.hpp>
 
 #include <dune/common/fmatrix.hh>
 #include <dune/istl/bcrsmatrix.hh>
@@ -40,7 +43,7 @@ namespace Dune
     FlexibleSolver<Operator>::
     FlexibleSolver(Operator& op,
                    const Opm::PropertyTree& prm,
-                   const std::function<VectorType()>& weightsCalculator,
+                   const std::function<void(VectorType&)>& weightsCalculator,
                    std::size_t pressureIndex)
     {
         init(op, Dune::Amg::SequentialInformation(), prm, weightsCalculator,
@@ -54,7 +57,7 @@ namespace Dune
     FlexibleSolver(Operator& op,
                    const Comm& comm,
                    const Opm::PropertyTree& prm,
-                   const std::function<VectorType()>& weightsCalculator,
+                   const std::function<void(VectorType&)>& weightsCalculator,
                    std::size_t pressureIndex)
     {
         init(op, comm, prm, weightsCalculator, pressureIndex);
@@ -85,6 +88,16 @@ namespace Dune
         return *preconditioner_;
     }
 
+    template <class Operator>
+    void
+    FlexibleSolver<Operator>::
+    setRecycleSpace(const std::shared_ptr<RecycleSpace<VectorType>>& space)
+    {
+        if (recyclingsolver_) {
+            recyclingsolver_->setRecycleSpace(space);
+        }
+    }
+
     template <class Operator>
     Dune::SolverCategory::Category
     FlexibleSolver<Operator>::
@@ -100,7 +113,7 @@ namespace Dune
     FlexibleSolver<Operator>::
     initOpPrecSp(Operator& op,
                  const Opm::PropertyTree& prm,
-                 const std::function<VectorType()> weightsCalculator,
+                 const std::function<void(VectorType&)> weightsCalculator,
                  const Comm& comm,
                  std::size_t pressureIndex)
     {
@@ -113,6 +126,7 @@ namespace Dune
                                                                              comm,
                                                                              pressureIndex);
         scalarproduct_ = Dune::createScalarProduct<VectorType, Comm>(comm, op.category());
+        dotproducts_ = std::make_shared<Dune::NonBlockingDotProducts<VectorType>>(comm);
     }
 
     template <class Operator>
@@ -120,7 +134,7 @@ namespace Dune
     FlexibleSolver<Operator>::
     initOpPrecSp(Operator& op,
                  const Opm::PropertyTree& prm,
-                 const std::function<VectorType()> weightsCalculator,
+                 const std::function<void(VectorType&)> weightsCalculator,
                  const Dune::Amg::SequentialInformation&,
                  std::size_t pressureIndex)
     {
@@ -132,6 +146,7 @@ namespace Dune
                                                                        weightsCalculator,
                                                                        pressureIndex);
         scalarproduct_ = std::make_shared<Dune::SeqScalarProduct<VectorType>>();
+        dotproducts_ = std::make_shared<Dune::NonBlockingDotProducts<VectorType>>();
     }
 
     template <class Operator>
@@ -166,6 +181,35 @@ namespace Dune
                                                                         restart, // desired residual reduction factor
                                                                         maxiter, // maximum number of iterations
                                                                         verbosity));
+        } else if (solver_type == "pipelined_bicgstab") {
+            linsolver_.reset(new Dune::PipelinedBiCGSTABSolver<VectorType>(*linearoperator_for_solver_,
+                                                                           *dotproducts_,
+                                                                           *preconditioner_,
+                                                                           tol, // desired residual reduction factor
+                                                                           maxiter, // maximum number of iterations
+                                                                           verbosity));
+        } else if (solver_type == "pipelined_gmres") {
+            int restart = prm.get<int>("restart", 15);
+            linsolver_.reset(new Dune::PipelinedGMResSolver<VectorType>(*linearoperator_for_solver_,
+                                                                        *dotproducts_,
+                                                                        *preconditioner_,
+                                                                        tol, // desired residual reduction factor
+                                                                        restart,
+                                                                        maxiter, // maximum number of iterations
+                                                                        verbosity));
+        } else if (solver_type == "recycling_gmres") {
+            int restart = prm.get<int>("restart", 15);
+            int recycle = prm.get<int>("recycle", 5);
+            auto solver = std::make_shared<Dune::RecyclingGMResSolver<VectorType>>(*linearoperator_for_solver_,
+                                                                                  *scalarproduct_,
+                                                                                  *preconditioner_,
+                                                                                  tol, // desired residual reduction factor
+                                                                                  restart,
+                                                                                  recycle, // maximum number of recycled directions
+                                                                                  maxiter, // maximum number of iterations
+                                                                                  verbosity);
+            recyclingsolver_ = solver.get();
+            linsolver_ = solver;
 #if HAVE_SUITESPARSE_UMFPACK
         } else if (solver_type == "umfpack") {
             bool dummy = false;
@@ -178,6 +222,30 @@ namespace Dune
     }
 
 
+    template <class Operator>
+    template <class Comm>
+    void
+    FlexibleSolver<Operator>::
+    initMixedPrecision(Operator& op,
+                       const Opm::PropertyTree& prm,
+                       const std::function<void(VectorType&)> weightsCalculator,
+                       const Comm& comm,
+                       std::size_t pressureIndex)
+    {
+        // Only double precision operators with a single precision counterpart,
+        // the inner solver of the refinement is a single precision FlexibleSolver.
+        if constexpr (std::is_same_v<typename VectorType::field_type, double>
+                      && Opm::SinglePrecisionOperator<Operator>::available) {
+            linearoperator_for_solver_ = &op;
+            auto solver = std::make_shared<MixedPrecisionSolver<Operator>>(op, comm, prm, weightsCalculator, pressureIndex);
+            preconditioner_ = solver->preconditioner();
+            linsolver_ = solver;
+        } else {
+            OPM_THROW(std::invalid_argument, "Properties: Mixed precision is not available for this operator.");
+        }
+    }
+
+
     // Main initialization routine.
     // Call with Comm == Dune::Amg::SequentialInformation to get a serial solver.
     template <class Operator>
@@ -187,9 +255,14 @@ namespace Dune
     init(Operator& op,
          const Comm& comm,
          const Opm::PropertyTree& prm,
-         const std::function<VectorType()> weightsCalculator,
+         const std::function<void(VectorType&)> weightsCalculator,
          std::size_t pressureIndex)
     {
+        const std::string precision = prm.get<std::string>("precision", "double");
+        if (precision == "mixed") {
+            initMixedPrecision(op, prm, weightsCalculator, comm, pressureIndex);
+            return;
+        }
         initOpPrecSp(op, prm, weightsCalculator, comm, pressureIndex);
         initSolver(prm, comm.communicator().rank() == 0);
     }
@@ -229,7 +302,7 @@ template class Dune::FlexibleSolver<Operator>;
 template Dune::FlexibleSolver<Operator>::FlexibleSolver(Operator& op,                                    \
                                                         const Comm& comm,                                \
                                                         const Opm::PropertyTree& prm,                    \
-                                                        const std::function<typename Operator::domain_type()>& weightsCalculator, \
+                                                        const std::function<void(typename Operator::domain_type&)>& weightsCalculator, \
                                                         std::size_t pressureIndex);
 #define INSTANTIATE_FLEXIBLESOLVER(N)     \
 INSTANTIATE_FLEXIBLESOLVER_OP(SeqOpM<N>); \
@@ -114,10 +114,46 @@ struct CprReuseInterval {
     using type = UndefinedProperty;
 };
 template<class TypeTag, class MyTypeTag>
+struct CprReuseUpdateTolerance {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct CprReuseRebuildTolerance {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
 struct Linsolver {
     using type = UndefinedProperty;
 };
 template<class TypeTag, class MyTypeTag>
+struct LinearSystemReordering {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSystemDumpFormat {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverAutoTune {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverAutoTuneTrials {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverAutoTuneInterval {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverPrecision {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverOverlapCommunication {
+    using type = UndefinedProperty;
+};
+template<class TypeTag, class MyTypeTag>
 struct AcceleratorMode {
     using type = UndefinedProperty;
 };
@@ -216,10 +252,48 @@ struct CprReuseInterval<TypeTag, TTag::FlowIstlSolverParams> {
     static constexpr int value = 10;
 };
 template<class TypeTag>
+struct CprReuseUpdateTolerance<TypeTag, TTag::FlowIstlSolverParams> {
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.02;
+};
+template<class TypeTag>
+struct CprReuseRebuildTolerance<TypeTag, TTag::FlowIstlSolverParams> {
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.2;
+};
+template<class TypeTag>
 struct Linsolver<TypeTag, TTag::FlowIstlSolverParams> {
     static constexpr auto value = "ilu0";
 };
 template<class TypeTag>
+struct LinearSystemReordering<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr auto value = "none";
+};
+template<class TypeTag>
+struct LinearSystemDumpFormat<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr auto value = "matrixmarket";
+};
+template<class TypeTag>
+struct LinearSolverAutoTune<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr auto value = "";
+};
+template<class TypeTag>
+struct LinearSolverAutoTuneTrials<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr int value = 3;
+};
+template<class TypeTag>
+struct LinearSolverAutoTuneInterval<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr int value = 0;
+};
+template<class TypeTag>
+struct LinearSolverPrecision<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr auto value = "double";
+};
+template<class TypeTag>
+struct LinearSolverOverlapCommunication<TypeTag, TTag::FlowIstlSolverParams> {
+    static constexpr bool value = false;
+};
+template<class TypeTag>
 struct AcceleratorMode<TypeTag, TTag::FlowIstlSolverParams> {
     static constexpr auto value = "none";
 };
@@ -263,12 +337,21 @@ namespace Opm
         bool   ignoreConvergenceFailure_;
         bool scale_linear_system_;
         std::string linsolver_;
+        std::string linear_system_reordering_;
+        std::string linear_system_dump_format_;
+        std::string linear_solver_autotune_;
+        int linear_solver_autotune_trials_;
+        int linear_solver_autotune_interval_;
+        std::string linear_solver_precision_;
+        bool linear_solver_overlap_communication_;
         std::string accelerator_mode_;
         int bda_device_id_;
         int opencl_platform_id_;
         int cpr_max_ell_iter_;
         int cpr_reuse_setup_;
         int cpr_reuse_interval_;
+        double cpr_reuse_update_tolerance_;
+        double cpr_reuse_rebuild_tolerance_;
         std::string opencl_ilu_reorder_;
         std::string fpga_bitstream_;
 
@@ -292,7 +375,16 @@ namespace Opm
             cpr_max_ell_iter_  =  EWOMS_GET_PARAM(TypeTag, int, CprMaxEllIter);
             cpr_reuse_setup_  =  EWOMS_GET_PARAM(TypeTag, int, CprReuseSetup);
             cpr_reuse_interval_  =  EWOMS_GET_PARAM(TypeTag, int, CprReuseInterval);
+            cpr_reuse_update_tolerance_ = EWOMS_GET_PARAM(TypeTag, double, CprReuseUpdateTolerance);
+            cpr_reuse_rebuild_tolerance_ = EWOMS_GET_PARAM(TypeTag, double, CprReuseRebuildTolerance);
             linsolver_ = EWOMS_GET_PARAM(TypeTag, std::string, Linsolver);
+            linear_system_reordering_ = EWOMS_GET_PARAM(TypeTag, std::string, LinearSystemReordering);
+            linear_system_dump_format_ = EWOMS_GET_PARAM(TypeTag, std::string, LinearSystemDumpFormat);
+            linear_solver_autotune_ = EWOMS_GET_PARAM(TypeTag, std::string, LinearSolverAutoTune);
+            linear_solver_autotune_trials_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverAutoTuneTrials);
+            linear_solver_autotune_interval_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverAutoTuneInterval);
+            linear_solver_precision_ = EWOMS_GET_PARAM(TypeTag, std::string, LinearSolverPrecision);
+            linear_solver_overlap_communication_ = EWOMS_GET_PARAM(TypeTag, bool, LinearSolverOverlapCommunication);
             accelerator_mode_ = EWOMS_GET_PARAM(TypeTag, std::string, AcceleratorMode);
             bda_device_id_ = EWOMS_GET_PARAM(TypeTag, int, BdaDeviceId);
             opencl_platform_id_ = EWOMS_GET_PARAM(TypeTag, int, OpenclPlatformId);
@@ -317,9 +409,18 @@ namespace Opm
             EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverIgnoreConvergenceFailure, "Continue with the simulation like nothing happened after the linear solver did not converge");
             EWOMS_REGISTER_PARAM(TypeTag, bool, ScaleLinearSystem, "Scale linear system according to equation scale and primary variable types");
             EWOMS_REGISTER_PARAM(TypeTag, int, CprMaxEllIter, "MaxIterations of the elliptic pressure part of the cpr solver");
-            EWOMS_REGISTER_PARAM(TypeTag, int, CprReuseSetup, "Reuse preconditioner setup. Valid options are 0: recreate the preconditioner for every linear solve, 1: recreate once every timestep, 2: recreate if last linear solve took more than 10 iterations, 3: never recreate, 4: recreated every CprReuseInterval");
+            EWOMS_REGISTER_PARAM(TypeTag, int, CprReuseSetup, "Reuse preconditioner setup. Valid options are 0: recreate the preconditioner for every linear solve, 1: recreate once every timestep, 2: recreate if last linear solve took more than 10 iterations, 3: never recreate, 4: recreated every CprReuseInterval, 5: adapt to the changes of the linear system, see CprReuseUpdateTolerance and CprReuseRebuildTolerance. When not recreated, the preconditioner is updated numerically, for CPR keeping the AMG aggregates and coarse sparsity of the last full setup");
             EWOMS_REGISTER_PARAM(TypeTag, int, CprReuseInterval, "Reuse preconditioner interval. Used when CprReuseSetup is set to 4, then the preconditioner will be fully recreated instead of reused every N linear solve, where N is this parameter.");
+            EWOMS_REGISTER_PARAM(TypeTag, double, CprReuseUpdateTolerance, "Used when CprReuseSetup is set to 5. Relative change of sampled diagonal blocks and well contributions since the last update above which the preconditioner is updated numerically, otherwise it is reused as it is. It is also updated when the linear iterations grow by half");
+            EWOMS_REGISTER_PARAM(TypeTag, double, CprReuseRebuildTolerance, "Used when CprReuseSetup is set to 5. Relative change of sampled diagonal blocks and well contributions since the last full setup above which the preconditioner is recreated. It is also recreated after well events, failed linear solves, and when the linear iterations triple");
             EWOMS_REGISTER_PARAM(TypeTag, std::string, Linsolver, "Configuration of solver. Valid options are: ilu0 (default), cpr (an alias for cpr_trueimpes), cpr_quasiimpes, cpr_trueimpes or amg. Alternatively, you can request a configuration to be read from a JSON file by giving the filename here, ending with '.json.'");
+            EWOMS_REGISTER_PARAM(TypeTag, std::string, LinearSystemReordering, "Reorder the linear system before it is passed to the preconditioner and Krylov solver, to improve cache reuse. Valid options are: none (default) and rcm (reverse Cuthill-McKee). Not available with the cprw preconditioner");
+            EWOMS_REGISTER_PARAM(TypeTag, std::string, LinearSystemDumpFormat, "Format of the linear systems written with a linear solver verbosity above 10. Valid options are: matrixmarket (default) and binary (block-CSR arrays that can be memory mapped, one file per process)");
+            EWOMS_REGISTER_PARAM(TypeTag, std::string, LinearSolverAutoTune, "Comma-separated list of linear solver configurations, in the format of --linsolver, to try on the first linear systems of the run. The fastest one is used for the rest of the run. Empty (default) disables the auto-tuning");
+            EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverAutoTuneTrials, "Number of consecutive linear solves with every configuration of --linear-solver-auto-tune");
+            EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverAutoTuneInterval, "Repeat the trials of --linear-solver-auto-tune after this number of report steps, 0 (default) to keep the first choice");
+            EWOMS_REGISTER_PARAM(TypeTag, std::string, LinearSolverPrecision, "Precision of the linear solver: double (default), or mixed for a single precision solve, including the preconditioner, with iterative refinement of the solution in double precision");
+            EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverOverlapCommunication, "In parallel runs, order the cells that other processes have copies of last in the ILU0 preconditioner and smoother, and send their values while the rest of the backward solve is computed. The reordering copies the matrix at every preconditioner update and the vectors at every application, so this only pays off if the communication is slow. Default: false");
             EWOMS_REGISTER_PARAM(TypeTag, std::string, AcceleratorMode, "Use GPU (cusparseSolver or openclSolver) or FPGA (fpgaSolver) as the linear solver, usage: '--accelerator-mode=[none|cusparse|opencl|fpga|amgcl]'");
             EWOMS_REGISTER_PARAM(TypeTag, int, BdaDeviceId, "Choose device ID for cusparseSolver or openclSolver, use 'nvidia-smi' or 'clinfo' to determine valid IDs");
             EWOMS_REGISTER_PARAM(TypeTag, int, OpenclPlatformId, "Choose platform ID for openclSolver, use 'clinfo' to determine valid platform IDs");
@@ -344,6 +445,15 @@ namespace Opm
             ilu_milu_                 = MILU_VARIANT::ILU;
             ilu_redblack_             = false;
             ilu_reorder_sphere_       = true;
+            linear_system_reordering_ = "none";
+            linear_system_dump_format_ = "matrixmarket";
+            linear_solver_autotune_ = "";
+            linear_solver_autotune_trials_ = 3;
+            linear_solver_autotune_interval_ = 0;
+            linear_solver_precision_ = "double";
+            linear_solver_overlap_communication_ = false;
+            cpr_reuse_update_tolerance_ = 0.02;
+            cpr_reuse_rebuild_tolerance_ = 0.2;
             accelerator_mode_         = "none";
             bda_device_id_            = 0;
             opencl_platform_id_       = 0;
@@ -27,15 +27,27 @@
 #include <opm/simulators/linalg/ExtractParallelGridInformationToISTL.hpp>
 #include <opm/simulators/linalg/FlexibleSolver.hpp>
 #include <opm/simulators/linalg/FlowLinearSolverParameters.hpp>
+#include <opm/simulators/linalg/LinearSolverAutoTuner.hpp>
 #include <opm/simulators/linalg/MatrixBlock.hpp>
 #include <opm/simulators/linalg/ParallelIstlInformation.hpp>
 #include <opm/simulators/linalg/ParallelOverlappingILU0.hpp>
+#include <opm/simulators/linalg/PreconditionerFactory.hpp>
+#include <opm/simulators/linalg/PreconditionerReusePolicy.hpp>
+#include <opm/simulators/linalg/RecyclingGMResSolver.hpp>
+#include <opm/simulators/linalg/ReorderedLinearSystem.hpp>
 #include <opm/simulators/linalg/WellOperators.hpp>
 #include <opm/simulators/linalg/WriteSystemMatrixHelper.hpp>
 #include <opm/simulators/linalg/findOverlapRowsAndColumns.hpp>
 #include <opm/simulators/linalg/getQuasiImpesWeights.hpp>
 #include <opm/simulators/linalg/setupPropertyTree.hpp>
 
+#include <opm/input/eclipse/Schedule/Events.hpp>
+
+#include <dune/common/timer.hh>
+
+#include <optional>
+#include <sstream>
+
 #if HAVE_CUDA || HAVE_OPENCL || HAVE_FPGA || HAVE_AMGCL
 #include <opm/simulators/linalg/bda/BdaBridge.hpp>
 #include <opm/simulators/linalg/bda/WellContributions.hpp>
@@ -133,6 +145,10 @@ namespace Opm
             prm_ = setupPropertyTree(parameters_,
                                      EWOMS_PARAM_IS_SET(TypeTag, int, LinearSolverMaxIter),
                                      EWOMS_PARAM_IS_SET(TypeTag, int, CprMaxEllIter));
+            if (parameters_.cpr_reuse_setup_ == 5) {
+                reusePolicy_ = std::make_unique<PreconditionerReusePolicy>(parameters_.cpr_reuse_update_tolerance_,
+                                                                           parameters_.cpr_reuse_rebuild_tolerance_);
+            }
 
 #if HAVE_CUDA || HAVE_OPENCL || HAVE_FPGA || HAVE_AMGCL
             {
@@ -158,6 +174,21 @@ namespace Opm
                 OPM_THROW(std::logic_error,"Cannot use accelerated solver since CUDA, OpenCL and amgcl were not found by cmake and FPGA was not enabled");
             }
 #endif
+            if (!parameters_.linear_solver_autotune_.empty()) {
+#if HAVE_CUDA || HAVE_OPENCL || HAVE_FPGA || HAVE_AMGCL
+                // The accelerated solves neither use nor time the candidate configurations.
+                const bool accelerated = bdaBridge->getUseGpu() || bdaBridge->getUseFpga();
+#else
+                const bool accelerated = false;
+#endif
+                if (accelerated) {
+                    if (on_io_rank) {
+                        OpmLog::warning("Linear solver auto-tuning is not available with --accelerator-mode, it is disabled");
+                    }
+                } else {
+                    setupAutoTuner();
+                }
+            }
             extractParallelGridInformationToISTL(simulator_.vanguard().grid(), parallelInformation_);
 
             // For some reason simulator_.model().elementMapper() is not initialized at this stage
@@ -216,14 +247,11 @@ namespace Opm
                 // Outch! We need to be able to scale the linear system! Hence const_cast
                 matrix_ = const_cast<Matrix*>(&M.istlMatrix());
 
-                // setup sparsity pattern for jacobi matrix for preconditioner (only used for openclSolver)
-#if HAVE_OPENCL
                 this->numJacobiBlocks_ = EWOMS_GET_PARAM(TypeTag, int, NumJacobiBlocks);
-#else
-                this->numJacobiBlocks_ = 0;
-#endif
 
                 useWellConn_ = EWOMS_GET_PARAM(TypeTag, bool, MatrixAddWellContributions);
+#if HAVE_OPENCL
+                // setup sparsity pattern for jacobi matrix for preconditioner (only used for openclSolver)
                 if (numJacobiBlocks_ > 1) {
                     const auto wellsForConn = simulator_.vanguard().schedule().getWellsatEnd();
                     const auto& cartMapper = simulator_.vanguard().cartesianIndexMapper();
@@ -232,6 +260,7 @@ namespace Opm
                     std::cout << "Create block-Jacobi pattern" << std::endl;
                     blockJacobiAdjacency();
                 }
+#endif
             } else {
                 // Pointers should not change
                 if ( &(M.istlMatrix()) != matrix_ ) {
@@ -241,10 +270,33 @@ namespace Opm
             }
             rhs_ = &b;
 
+            if (autoTuner_) {
+                if (autoTuner_->select(simulator_.episodeIndex())) {
+                    // Recreate the solver with the configuration to try next.
+                    prm_ = autoTuner_->current().prm;
+                    flexibleSolver_.reset();
+                }
+                if (autoTuner_->justLockedIn() && simulator_.gridView().comm().rank() == 0) {
+                    OpmLog::info(autoTuner_->report());
+                }
+            }
+
             if (isParallel() && prm_.get<std::string>("preconditioner.type") != "ParOverILU0") {
                 makeOverlapRowsInvalid(getMatrix());
             }
+            if (firstcall) {
+                setupReordering();
+                setupJacobiPartition();
+                // The solver matrix, and with it its sparsity pattern, is only
+                // set up here, so this is where the cached diagonal positions
+                // of the quasi-IMPES weights are invalidated.
+                diagonalOffsets_.clear();
+            } else if (reordered_) {
+                reordered_->updateMatrix(getMatrix());
+            }
+            Dune::Timer setupTimer;
             prepareFlexibleSolver();
+            setupTime_ = setupTimer.elapsed();
             firstcall = false;
         }
 
@@ -267,10 +319,19 @@ namespace Opm
             const int verbosity = prm_.get<int>("verbosity", 0);
             const bool write_matrix = verbosity > 10;
             if (write_matrix) {
+                // The wells are written separately if not part of the matrix.
+                std::optional<Matrix> wells;
+                if (!useWellConn_) {
+                    SparseMatrixAdapter wellMatrix(simulator_);
+                    Helper::assembleWellMatrix(simulator_.problem().wellModel(), getMatrix().N(), wellMatrix);
+                    wells = wellMatrix.istlMatrix();
+                }
                 Helper::writeSystem(simulator_, //simulator is only used to get names
                                     getMatrix(),
                                     *rhs_,
-                                    comm_.get());
+                                    wells ? &*wells : nullptr,
+                                    comm_.get(),
+                                    prm_.get<std::string>("dump_format", parameters_.linear_system_dump_format_));
             }
 
             // Solve system.
@@ -294,7 +355,7 @@ namespace Opm
                 }
 #endif
 
-                if (numJacobiBlocks_ > 1) {
+                if (blockJacobiForGPUILU0_) {
                     copyMatToBlockJac(getMatrix(), *blockJacobiForGPUILU0_);
                 // Const_cast needed since the CUDA stuff overwrites values for better matrix condition..
                     bdaBridge->solve_system(const_cast<Matrix*>(&getMatrix()), &*blockJacobiForGPUILU0_,
@@ -302,7 +363,7 @@ namespace Opm
                 }
                 else
                     bdaBridge->solve_system(const_cast<Matrix*>(&getMatrix()), const_cast<Matrix*>(&getMatrix()),
-                                            numJacobiBlocks_, *rhs_, *wellContribs, result);
+                                            0, *rhs_, *wellContribs, result);
                 if (result.converged) {
                     // get result vector x from non-Dune backend, iff solve was successful
                     bdaBridge->get_result(x);
@@ -322,7 +383,29 @@ namespace Opm
             // Otherwise, use flexible istl solver.
             if (!accelerator_was_used) {
                 assert(flexibleSolver_);
-                flexibleSolver_->apply(x, *rhs_, result);
+                Dune::Timer applyTimer;
+                if (reordered_) {
+                    reordered_->toReordered(x, reorderedX_);
+                    reordered_->toReordered(*rhs_, reorderedRhs_);
+                    if (linearReduction_ > 0.0) {
+                        flexibleSolver_->apply(reorderedX_, reorderedRhs_, linearReduction_, result);
+                    } else {
+                        flexibleSolver_->apply(reorderedX_, reorderedRhs_, result);
+                    }
+                    reordered_->fromReordered(reorderedX_, x);
+                } else if (linearReduction_ > 0.0) {
+                    flexibleSolver_->apply(x, *rhs_, linearReduction_, result);
+                } else {
+                    flexibleSolver_->apply(x, *rhs_, result);
+                }
+                if (autoTuner_ && autoTuner_->trialing()) {
+                    // The slowest process decides, so that all make the same choice.
+                    const double time = simulator_.gridView().comm().max(setupTime_ + applyTimer.elapsed());
+                    autoTuner_->record(time, result.converged);
+                }
+                if (reusePolicy_) {
+                    reusePolicy_->record(result.iterations, result.converged);
+                }
             }
 
             // Check convergence, iterations etc.
@@ -341,6 +424,15 @@ namespace Opm
         /// \copydoc NewtonIterationBlackoilInterface::iterations
         int iterations () const { return iterations_; }
 
+        /// Set the residual reduction of the following solves, e.g. by an
+        /// inexact Newton method. The configured tolerance is only loosened,
+        /// never tightened, and a value <= 0 restores it.
+        void setLinearReduction(const double reduction)
+        {
+            const double configured = prm_.get<double>("tol", parameters_.linear_solver_reduction_);
+            linearReduction_ = reduction > 0.0 ? std::max(reduction, configured) : 0.0;
+        }
+
         /// \copydoc NewtonIterationBlackoilInterface::parallelInformation
         const std::any& parallelInformation() const { return parallelInformation_; }
 
@@ -385,26 +477,30 @@ namespace Opm
         void prepareFlexibleSolver()
         {
 
-            std::function<Vector()> weightsCalculator = getWeightsCalculator();
+            std::function<void(Vector&)> weightsCalculator = getWeightsCalculator();
 
-            if (shouldCreateSolver()) {
+            const auto action = reuseAction();
+            if (action == PreconditionerReusePolicy::Action::Rebuild) {
+                const PropertyTree prm = solverParameters();
                 if (isParallel()) {
 #if HAVE_MPI
                     if (useWellConn_) {
                         using ParOperatorType = Dune::OverlappingSchwarzOperator<Matrix, Vector, Vector, Comm>;
-                        auto op = std::make_unique<ParOperatorType>(getMatrix(), *comm_);
+                        auto op = std::make_unique<ParOperatorType>(solverMatrix(), solverComm());
                         using FlexibleSolverType = Dune::FlexibleSolver<ParOperatorType>;
-                        auto sol = std::make_unique<FlexibleSolverType>(*op, *comm_, prm_, weightsCalculator, pressureIndex);
+                        auto sol = std::make_unique<FlexibleSolverType>(*op, solverComm(), prm, weightsCalculator, pressureIndex);
                         preconditionerForFlexibleSolver_ = &(sol->preconditioner());
+                        sol->setRecycleSpace(recycleSpace_);
                         linearOperatorForFlexibleSolver_ = std::move(op);
                         flexibleSolver_ = std::move(sol);
                     } else {
                         using ParOperatorType = WellModelGhostLastMatrixAdapter<Matrix, Vector, Vector, true>;
-                        wellOperator_ = std::make_unique<WellModelOperator>(simulator_.problem().wellModel());
-                        auto op = std::make_unique<ParOperatorType>(getMatrix(), *wellOperator_, interiorCellNum_);
+                        setupWellOperator();
+                        auto op = std::make_unique<ParOperatorType>(solverMatrix(), solverWellOperator(), interiorCellNum_);
                         using FlexibleSolverType = Dune::FlexibleSolver<ParOperatorType>;
-                        auto sol = std::make_unique<FlexibleSolverType>(*op, *comm_, prm_, weightsCalculator, pressureIndex);
+                        auto sol = std::make_unique<FlexibleSolverType>(*op, solverComm(), prm, weightsCalculator, pressureIndex);
                         preconditionerForFlexibleSolver_ = &(sol->preconditioner());
+                        sol->setRecycleSpace(recycleSpace_);
                         linearOperatorForFlexibleSolver_ = std::move(op);
                         flexibleSolver_ = std::move(sol);
                     }
@@ -412,28 +508,110 @@ namespace Opm
                 } else {
                     if (useWellConn_) {
                         using SeqOperatorType = Dune::MatrixAdapter<Matrix, Vector, Vector>;
-                        auto op = std::make_unique<SeqOperatorType>(getMatrix());
+                        auto op = std::make_unique<SeqOperatorType>(solverMatrix());
                         using FlexibleSolverType = Dune::FlexibleSolver<SeqOperatorType>;
-                        auto sol = std::make_unique<FlexibleSolverType>(*op, prm_, weightsCalculator, pressureIndex);
+                        auto sol = std::make_unique<FlexibleSolverType>(*op, prm, weightsCalculator, pressureIndex);
                         preconditionerForFlexibleSolver_ = &(sol->preconditioner());
+                        sol->setRecycleSpace(recycleSpace_);
                         linearOperatorForFlexibleSolver_ = std::move(op);
                         flexibleSolver_ = std::move(sol);
                     } else {
                         using SeqOperatorType = WellModelMatrixAdapter<Matrix, Vector, Vector, false>;
-                        wellOperator_ = std::make_unique<WellModelOperator>(simulator_.problem().wellModel());
-                        auto op = std::make_unique<SeqOperatorType>(getMatrix(), *wellOperator_);
+                        setupWellOperator();
+                        auto op = std::make_unique<SeqOperatorType>(solverMatrix(), solverWellOperator());
                         using FlexibleSolverType = Dune::FlexibleSolver<SeqOperatorType>;
-                        auto sol = std::make_unique<FlexibleSolverType>(*op, prm_, weightsCalculator, pressureIndex);
+                        auto sol = std::make_unique<FlexibleSolverType>(*op, prm, weightsCalculator, pressureIndex);
                         preconditionerForFlexibleSolver_ = &(sol->preconditioner());
+                        sol->setRecycleSpace(recycleSpace_);
                         linearOperatorForFlexibleSolver_ = std::move(op);
                         flexibleSolver_ = std::move(sol);
                     }
                 }
             }
-            else
+            else if (action == PreconditionerReusePolicy::Action::Update)
             {
+                // Numeric-only re-setup, reusing the sparsity dependent
+                // parts (e.g. the AMG aggregates of CPR) of the last setup.
                 preconditionerForFlexibleSolver_->update();
             }
+            // Otherwise the preconditioner of an earlier setup is reused as it is.
+        }
+
+
+        /// Create the operator of the well contributions, unless they are
+        /// part of the matrix. It only forwards to the well model, so it
+        /// is kept for the whole run.
+        void setupWellOperator()
+        {
+            if (wellOperator_) {
+                return;
+            }
+            wellOperator_ = std::make_unique<WellModelOperator>(simulator_.problem().wellModel());
+            if (reordered_) {
+                reorderedWellOperator_ = std::make_unique<ReorderedWellOperator<Matrix, Vector, Vector>>(*wellOperator_, *reordered_);
+            }
+        }
+
+
+        /// Return whether to recreate the solver, update the preconditioner
+        /// numerically, or reuse it without any update.
+        PreconditionerReusePolicy::Action reuseAction()
+        {
+            using Action = PreconditionerReusePolicy::Action;
+            if (!reusePolicy_) {
+                return shouldCreateSolver() ? Action::Rebuild : Action::Update;
+            }
+
+            // Sample the diagonal blocks, and the response of the wells in
+            // the cells they perforated at the last well event.
+            constexpr std::size_t maxSampledRows = 1000;
+            std::vector<std::vector<double>> samples(2);
+            PreconditionerReusePolicy::sampleDiagonal(getMatrix(), maxSampledRows, samples[0]);
+            const bool wellEvent = checkWellEvent();
+            if (!useWellConn_) {
+                // Created here already, so that the first sample has the
+                // same layout as the later ones.
+                setupWellOperator();
+                Vector probe(getMatrix().N());
+                probe = 1.0;
+                wellResponse_.resize(probe.size());
+                wellResponse_ = 0.0;
+                wellOperator_->apply(probe, wellResponse_);
+                if (wellEvent || wellResponseRows_.empty()) {
+                    wellResponseRows_.clear();
+                    for (std::size_t row = 0; row < wellResponse_.size(); ++row) {
+                        if (wellResponse_[row].two_norm2() > 0.0) {
+                            wellResponseRows_.push_back(row);
+                        }
+                    }
+                }
+                for (const auto row : wellResponseRows_) {
+                    samples[1].insert(samples[1].end(), wellResponse_[row].begin(), wellResponse_[row].end());
+                }
+            }
+            return reusePolicy_->decide(samples, wellEvent || !flexibleSolver_, simulator_.gridView().comm());
+        }
+
+
+        /// Return true at the first solve after wells were opened, shut,
+        /// added or switched, by the schedule or during the run.
+        bool checkWellEvent()
+        {
+            bool event = false;
+            const int episode = simulator_.episodeIndex();
+            if (episode != lastEpisode_) {
+                const uint64_t wellEvents = ScheduleEvents::NEW_WELL
+                    + ScheduleEvents::WELL_STATUS_CHANGE
+                    + ScheduleEvents::WELL_SWITCHED_INJECTOR_PRODUCER
+                    + ScheduleEvents::INJECTION_TYPE_CHANGED
+                    + ScheduleEvents::COMPLETION_CHANGE;
+                event = episode >= 0 && simulator_.vanguard().schedule()[episode].events().hasEvent(wellEvents);
+                lastEpisode_ = episode;
+            }
+            const int openWells = simulator_.problem().wellModel().numLocalNonshutWells();
+            event = event || openWells != numOpenWells_;
+            numOpenWells_ = openWells;
+            return event;
         }
 
 
@@ -485,9 +663,9 @@ namespace Opm
 
 
         /// Return an appropriate weight function if a cpr preconditioner is asked for.
-        std::function<Vector()> getWeightsCalculator() const
+        std::function<void(Vector&)> getWeightsCalculator() const
         {
-            std::function<Vector()> weightsCalculator;
+            std::function<void(Vector&)> weightsCalculator;
 
             using namespace std::string_literals;
 
@@ -500,14 +678,20 @@ namespace Opm
                     // weights will be created as default in the solver
                     // assignment p = pressureIndex prevent compiler warning about
                     // capturing variable with non-automatic storage duration
-                    weightsCalculator = [this, transpose, p = pressureIndex]() {
-                        return Amg::getQuasiImpesWeights<Matrix, Vector>(this->getMatrix(), p, transpose);
+                    weightsCalculator = [this, transpose, p = pressureIndex](Vector& weights) {
+                        Amg::getQuasiImpesWeights(this->solverMatrix(), p, transpose, weights, this->diagonalOffsets_);
                     };
                 } else if (weightsType == "trueimpes") {
                     // assignment p = pressureIndex prevent compiler warning about
                     // capturing variable with non-automatic storage duration
-                    weightsCalculator = [this, p = pressureIndex]() {
-                        return this->getTrueImpesWeights(p);
+                    weightsCalculator = [this, p = pressureIndex](Vector& weights) {
+                        if (this->reordered_) {
+                            this->trueImpesWeights_.resize(weights.size());
+                            this->getTrueImpesWeights(p, this->trueImpesWeights_);
+                            this->reordered_->toReordered(this->trueImpesWeights_, weights);
+                        } else {
+                            this->getTrueImpesWeights(p, weights);
+                        }
                     };
                 } else {
                     OPM_THROW(std::invalid_argument,
@@ -522,14 +706,30 @@ namespace Opm
         // Weights to make approximate pressure equations.
         // Calculated from the storage terms (only) of the
         // conservation equations, ignoring all other terms.
-        Vector getTrueImpesWeights(int pressureVarIndex) const
+        void getTrueImpesWeights(int pressureVarIndex, Vector& weights) const
         {
-            Vector weights(rhs_->size());
+            using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+            using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+            using Storage = Dune::FieldVector<GetPropType<TypeTag, Properties::Evaluation>, Indices::numEq>;
+            if constexpr (Details::HasIntensiveQuantitiesStorage<LocalResidual, IntensiveQuantities, Storage>::value) {
+                // Evaluate the storage terms on the intensive quantities
+                // cached during linearization, if they are cached for all cells.
+                const auto& model = simulator_.model();
+                bool cached = weights.size() > 0;
+                for (std::size_t cell = 0; cached && cell < weights.size(); ++cell) {
+                    cached = model.cachedIntensiveQuantities(cell, /*timeIdx=*/0) != nullptr;
+                }
+                if (cached) {
+                    Amg::getTrueImpesWeightsFromCache<LocalResidual>(pressureVarIndex, weights, model,
+                                                                     simulator_.timeStepSize(),
+                                                                     simulator_.vanguard().grid().comm());
+                    return;
+                }
+            }
             ElementContext elemCtx(simulator_);
             Amg::getTrueImpesWeights(pressureVarIndex, weights, simulator_.vanguard().gridView(),
                                      elemCtx, simulator_.model(),
                                      ThreadManager::threadId());
-            return weights;
         }
 
 
@@ -628,6 +828,143 @@ namespace Opm
             return *matrix_;
         }
 
+        /// Set up the candidate configurations of --linear-solver-auto-tune,
+        /// every one as if it was given to --linsolver.
+        void setupAutoTuner()
+        {
+            const bool on_io_rank = simulator_.gridView().comm().rank() == 0;
+            std::vector<LinearSolverAutoTuner::Candidate> candidates;
+            std::istringstream names(parameters_.linear_solver_autotune_);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                name.erase(0, name.find_first_not_of(' '));
+                name.erase(name.find_last_not_of(' ') + 1);
+                if (name.empty()) {
+                    continue;
+                }
+                FlowLinearSolverParameters candidateParameters = parameters_;
+                candidateParameters.linsolver_ = name;
+                auto prm = setupPropertyTree(candidateParameters,
+                                             EWOMS_PARAM_IS_SET(TypeTag, int, LinearSolverMaxIter),
+                                             EWOMS_PARAM_IS_SET(TypeTag, int, CprMaxEllIter));
+                const auto preconditionerType = prm.get<std::string>("preconditioner.type", "cpr");
+                if (parameters_.linear_system_reordering_ != "none"
+                    && (preconditionerType == "cprw" || preconditionerType == "cprwt")) {
+                    if (on_io_rank) {
+                        OpmLog::warning("Linear solver configuration " + name + " is not available with linear"
+                                        " system reordering, it is not considered for the auto-tuning.");
+                    }
+                    continue;
+                }
+                candidates.push_back({name, prm});
+            }
+            autoTuner_ = std::make_unique<LinearSolverAutoTuner>(std::move(candidates),
+                                                                 parameters_.linear_solver_autotune_trials_,
+                                                                 parameters_.linear_solver_autotune_interval_);
+            prm_ = autoTuner_->current().prm;
+            if (on_io_rank) {
+                OpmLog::info("Linear solver auto-tuning between: " + parameters_.linear_solver_autotune_);
+            }
+        }
+
+        /// Set up the reordered copy of the linear system, if requested.
+        /// Only the interior rows are reordered, so the overlap rows stay
+        /// at the end and the interior/overlap split is preserved.
+        void setupReordering()
+        {
+            const auto& reordering = parameters_.linear_system_reordering_;
+            if (reordering == "none") {
+                return;
+            }
+            if (reordering != "rcm") {
+                OPM_THROW(std::invalid_argument, "Unknown linear system reordering: " << reordering
+                          << ". Please use none or rcm.");
+            }
+            const auto preconditionerType = prm_.get<std::string>("preconditioner.type", "cpr");
+            if (preconditionerType == "cprw" || preconditionerType == "cprwt") {
+                if (simulator_.gridView().comm().rank() == 0) {
+                    OpmLog::warning("Linear system reordering is not available with the cprw preconditioner, it is disabled.");
+                }
+                return;
+            }
+            reordered_ = std::make_unique<ReorderedLinearSystem<Matrix, Vector>>(getMatrix(), interiorCellNum_);
+#if HAVE_MPI
+            if (isParallel()) {
+                // Same global indices and attributes, at the new local positions.
+                reorderedComm_ = std::make_shared<CommunicationType>(comm_->communicator());
+                using LocalIndex = typename CommunicationType::ParallelIndexSet::LocalIndex;
+                const auto& perm = reordered_->permutation();
+                auto& indexSet = reorderedComm_->indexSet();
+                indexSet.beginResize();
+                for (const auto& index : comm_->indexSet()) {
+                    indexSet.add(index.global(), LocalIndex(perm[index.local().local()],
+                                                            index.local().attribute(),
+                                                            index.local().isPublic()));
+                }
+                indexSet.endResize();
+                reorderedComm_->remoteIndices().template rebuild<false>();
+            }
+#endif
+        }
+
+        /// Add the Zoltan partition of --num-jacobi-blocks, in the row order
+        /// of the solver matrix, to the partitions of the BlockJacobiILU0
+        /// preconditioner. The partition only exists for runs on a single
+        /// process.
+        void setupJacobiPartition()
+        {
+            const auto& cellPartition = simulator_.vanguard().cellPartition();
+            if (numJacobiBlocks_ <= 1 || cellPartition.size() != getMatrix().N()) {
+                return;
+            }
+            auto partition = std::make_shared<std::vector<int>>(cellPartition.size());
+            for (std::size_t cell = 0; cell < cellPartition.size(); ++cell) {
+                const std::size_t row = reordered_ ? reordered_->permutation()[cell] : cell;
+                (*partition)[row] = cellPartition[cell];
+            }
+            jacobiPartition_ = "num_jacobi_blocks";
+            BlockJacobiPartitions::add(jacobiPartition_, std::move(partition));
+        }
+
+        /// The parameters of a new flexible solver. A BlockJacobiILU0
+        /// preconditioner, or CPR fine smoother, refers to the Zoltan
+        /// partition by name rather than using blocks of consecutive rows.
+        PropertyTree solverParameters() const
+        {
+            PropertyTree prm = prm_;
+            if (!jacobiPartition_.empty()) {
+                for (const std::string key : {"preconditioner", "preconditioner.finesmoother"}) {
+                    if (prm.get<std::string>(key + ".type", "") == "BlockJacobiILU0") {
+                        prm.put(key + ".partition", jacobiPartition_);
+                    }
+                }
+            }
+            return prm;
+        }
+
+        /// The matrix passed to the flexible solver, reordered if requested.
+        const Matrix& solverMatrix() const
+        {
+            return reordered_ ? reordered_->matrix() : getMatrix();
+        }
+
+        /// The well operator for the flexible solver, acting in the order of solverMatrix().
+        const LinearOperatorExtra<Vector, Vector>& solverWellOperator() const
+        {
+            if (reorderedWellOperator_) {
+                return *reorderedWellOperator_;
+            }
+            return *wellOperator_;
+        }
+
+#if HAVE_MPI
+        /// The communication for the flexible solver, in the order of solverMatrix().
+        const CommunicationType& solverComm() const
+        {
+            return reorderedComm_ ? *reorderedComm_ : *comm_;
+        }
+#endif
+
         const Simulator& simulator_;
         mutable int iterations_;
         mutable int calls_;
@@ -639,13 +976,30 @@ namespace Opm
         Vector *rhs_;
 
         std::unique_ptr<Matrix> blockJacobiForGPUILU0_;
+        //! \brief The name of the partition of --num-jacobi-blocks in BlockJacobiPartitions, empty if none.
+        std::string jacobiPartition_;
 
         std::unique_ptr<AbstractSolverType> flexibleSolver_;
         std::unique_ptr<AbstractOperatorType> linearOperatorForFlexibleSolver_;
         AbstractPreconditionerType* preconditionerForFlexibleSolver_;
+        //! \brief Subspace kept between the solves by the "recycling_gmres" solver, also when the solver is recreated.
+        std::shared_ptr<Dune::RecycleSpace<Vector>> recycleSpace_ = std::make_shared<Dune::RecycleSpace<Vector>>();
         std::unique_ptr<WellModelAsLinearOperator<WellModel, Vector, Vector>> wellOperator_;
+        //! \brief Copy of the linear system in bandwidth-reducing order, if reordering is requested.
+        std::unique_ptr<ReorderedLinearSystem<Matrix, Vector>> reordered_;
+        std::unique_ptr<LinearOperatorExtra<Vector, Vector>> reorderedWellOperator_;
+        Vector reorderedX_;
+        Vector reorderedRhs_;
+#if HAVE_MPI
+        std::shared_ptr<CommunicationType> reorderedComm_;
+#endif
         std::vector<int> overlapRows_;
         std::vector<int> interiorRows_;
+        //! \brief Cached positions of the diagonal blocks, used for the quasi-IMPES weights.
+        //! Must be cleared whenever the sparsity pattern of solverMatrix() changes.
+        mutable std::vector<std::size_t> diagonalOffsets_;
+        //! \brief True-IMPES weights in the original order, before reordering.
+        mutable Vector trueImpesWeights_;
         std::vector<std::set<int>> wellConnectionsGraph_;
 
         bool useWellConn_;
@@ -655,6 +1009,18 @@ namespace Opm
         PropertyTree prm_;
         bool scale_variables_;
         int numJacobiBlocks_;
+        //! \brief Reduction set by setLinearReduction(), 0 to use the configured tolerance.
+        double linearReduction_ = 0.0;
+        std::unique_ptr<LinearSolverAutoTuner> autoTuner_;
+        //! \brief Adaptive reuse of the preconditioner, for --cpr-reuse-setup=5.
+        std::unique_ptr<PreconditionerReusePolicy> reusePolicy_;
+        //! \brief The response of the wells to a constant vector, and the rows sampled from it.
+        Vector wellResponse_;
+        std::vector<std::size_t> wellResponseRows_;
+        int lastEpisode_ = -1;
+        int numOpenWells_ = -1;
+        //! \brief Time of the last call to prepareFlexibleSolver(), for the auto-tuning.
+        double setupTime_ = 0.0;
 
         std::shared_ptr< CommunicationType > comm_;
     }; // end ISTLSolver
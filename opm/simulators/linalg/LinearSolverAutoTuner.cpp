@@ -0,0 +1,137 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/simulators/linalg/LinearSolverAutoTuner.hpp>
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace Opm
+{
+
+LinearSolverAutoTuner::LinearSolverAutoTuner(std::vector<Candidate> candidates,
+                                             const int trialSolves,
+                                             const int interval)
+    : candidates_(std::move(candidates))
+    , trialSolves_(std::max(trialSolves, 1))
+    , interval_(std::max(interval, 0))
+{
+    if (candidates_.empty()) {
+        OPM_THROW(std::invalid_argument, "Linear solver auto-tuning needs at least one candidate configuration.");
+    }
+    trialing_ = candidates_.size() > 1;
+}
+
+bool LinearSolverAutoTuner::select(const int reportStep)
+{
+    justLockedIn_ = false;
+    const std::size_t previous = current_;
+    if (startStep_ < 0) {
+        startTrials(reportStep);
+    } else if (!trialing_ && interval_ > 0 && reportStep >= startStep_ + interval_ && candidates_.size() > 1) {
+        startTrials(reportStep);
+    }
+    const auto& last = candidates_[current_];
+    if (trialing_ && (last.failed || last.solves >= trialSolves_)) {
+        // The trial of the last candidate is over, continue with the
+        // candidate with the fewest solves, in order of appearance.
+        std::size_t next = candidates_.size();
+        for (std::size_t i = 0; i < candidates_.size(); ++i) {
+            const auto& c = candidates_[i];
+            if (!c.failed && c.solves < trialSolves_
+                && (next == candidates_.size() || c.solves < candidates_[next].solves)) {
+                next = i;
+            }
+        }
+        if (next == candidates_.size()) {
+            lockIn(reportStep);
+        } else {
+            current_ = next;
+        }
+    }
+    return current_ != previous;
+}
+
+void LinearSolverAutoTuner::record(const double seconds, const bool converged)
+{
+    if (!trialing_) {
+        return;
+    }
+    auto& c = candidates_[current_];
+    c.time += seconds;
+    ++c.solves;
+    c.failed = c.failed || !converged;
+}
+
+std::string LinearSolverAutoTuner::report() const
+{
+    std::ostringstream os;
+    os << "Linear solver auto-tuning, average time per linear solve (setup and apply):";
+    for (const auto& c : candidates_) {
+        os << "\n  " << std::left << std::setw(30) << c.name << std::right;
+        if (c.failed) {
+            os << " failed to converge";
+        } else if (c.solves > 0) {
+            os << std::setw(12) << std::setprecision(4) << c.time / c.solves << " s  (" << c.solves << " solves)";
+        } else {
+            os << " not tried";
+        }
+    }
+    os << "\nSelected: " << current().name
+       << ", use --linsolver=" << current().name << " to reuse this choice. Its configuration is:\n";
+    current().prm.write_json(os, true);
+    return os.str();
+}
+
+void LinearSolverAutoTuner::startTrials(const int reportStep)
+{
+    startStep_ = reportStep;
+    trialing_ = candidates_.size() > 1;
+    for (auto& c : candidates_) {
+        c.time = 0.0;
+        c.solves = 0;
+        c.failed = false;
+    }
+}
+
+void LinearSolverAutoTuner::lockIn(const int reportStep)
+{
+    double best = std::numeric_limits<double>::max();
+    std::size_t choice = 0;
+    for (std::size_t i = 0; i < candidates_.size(); ++i) {
+        const auto& c = candidates_[i];
+        if (!c.failed && c.solves > 0 && c.time / c.solves < best) {
+            best = c.time / c.solves;
+            choice = i;
+        }
+    }
+    current_ = choice;
+    trialing_ = false;
+    justLockedIn_ = true;
+    startStep_ = reportStep;
+}
+
+} // namespace Opm
@@ -0,0 +1,108 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_LINEARSOLVERAUTOTUNER_HEADER_INCLUDED
+#define OPM_LINEARSOLVERAUTOTUNER_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/PropertyTree.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Choose the fastest of several linear solver configurations at run time.
+///
+/// The candidates are tried in turn on the linear systems of the
+/// simulation, for a given number of consecutive solves each. The solver
+/// is only recreated when switching candidates, so within its trial every
+/// candidate reuses its preconditioner setup as in the rest of the run,
+/// and the time of a solve includes the setup whenever one is done. Once
+/// all candidates have been tried, the one with the least average time per
+/// solve is locked in. Candidates that fail to converge are disqualified,
+/// and their trial ends at once. The trials are optionally repeated every
+/// given number of report steps, as the best choice may change with the
+/// state of the reservoir and the wells.
+class LinearSolverAutoTuner
+{
+public:
+    struct Candidate
+    {
+        std::string name;
+        PropertyTree prm;
+        double time = 0.0;
+        int solves = 0;
+        bool failed = false;
+    };
+
+    /// \param trialSolves  Number of consecutive solves with every candidate.
+    /// \param interval     Number of report steps after which the trials are
+    ///                     repeated, 0 to keep the first choice.
+    LinearSolverAutoTuner(std::vector<Candidate> candidates, int trialSolves, int interval);
+
+    /// \brief Choose the candidate for the next solve.
+    /// \return True if it differs from the one of the last solve.
+    bool select(int reportStep);
+
+    /// \brief Record the time of a solve with the current candidate.
+    void record(double seconds, bool converged);
+
+    /// \brief True while the candidates are tried.
+    bool trialing() const
+    {
+        return trialing_;
+    }
+
+    /// \brief True once after the trials finished and a candidate was locked in.
+    bool justLockedIn() const
+    {
+        return justLockedIn_;
+    }
+
+    const Candidate& current() const
+    {
+        return candidates_[current_];
+    }
+
+    const std::vector<Candidate>& candidates() const
+    {
+        return candidates_;
+    }
+
+    /// \brief Timings of all candidates and the choice, for the log.
+    std::string report() const;
+
+private:
+    void startTrials(int reportStep);
+    void lockIn(int reportStep);
+
+    std::vector<Candidate> candidates_;
+    int trialSolves_;
+    int interval_;
+    std::size_t current_ = 0;
+    bool trialing_ = true;
+    bool justLockedIn_ = false;
+    int startStep_ = -1;
+};
+
+} // namespace Opm
+
+#endif // OPM_LINEARSOLVERAUTOTUNER_HEADER_INCLUDED
@@ -0,0 +1,499 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_MIXEDPRECISIONSOLVER_HEADER_INCLUDED
+#define OPM_MIXEDPRECISIONSOLVER_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/FlexibleSolver.hpp>
+#include <opm/simulators/linalg/PreconditionerWithUpdate.hpp>
+#include <opm/simulators/linalg/PropertyTree.hpp>
+#include <opm/simulators/linalg/WellOperators.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/common/timer.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/paamg/pinfo.hh>
+#include <dune/istl/scalarproducts.hh>
+#include <dune/istl/solver.hh>
+#if HAVE_MPI
+#include <dune/istl/schwarz.hh>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace Opm
+{
+
+/// The single precision counterparts of the double precision matrix and vector types.
+template <class Matrix>
+using SinglePrecisionMatrix
+    = Dune::BCRSMatrix<Opm::MatrixBlock<float, Matrix::block_type::rows, Matrix::block_type::cols>>;
+template <class Vector>
+using SinglePrecisionVector = Dune::BlockVector<Dune::FieldVector<float, Vector::block_type::dimension>>;
+
+namespace Details
+{
+    /// Copy the entries of one block vector into another of a different field type.
+    template <class From, class To>
+    void convertVector(const From& from, To& to)
+    {
+        if (to.size() != from.size()) {
+            to.resize(from.size());
+        }
+        const std::ptrdiff_t size = from.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t i = 0; i < size; ++i) {
+            for (std::size_t k = 0; k < from[i].size(); ++k) {
+                to[i][k] = from[i][k];
+            }
+        }
+    }
+
+    /// Copy the values of a matrix into a matrix of a different field type and the same pattern.
+    template <class From, class To>
+    void convertMatrixValues(const From& from, To& to)
+    {
+        const std::ptrdiff_t numRows = from.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            auto toCol = to[row].begin();
+            for (auto col = from[row].begin(); col != from[row].end(); ++col, ++toCol) {
+                for (int i = 0; i < From::block_type::rows; ++i) {
+                    for (int j = 0; j < From::block_type::cols; ++j) {
+                        (*toCol)[i][j] = (*col)[i][j];
+                    }
+                }
+            }
+        }
+    }
+
+    /// A matrix of a different field type with the pattern and values of the given one.
+    template <class To, class From>
+    std::unique_ptr<To> convertMatrix(const From& from)
+    {
+        auto to = std::make_unique<To>(from.N(), from.M(), from.nonzeroes(), To::row_wise);
+        for (auto row = to->createbegin(); row != to->createend(); ++row) {
+            const auto& fromRow = from[row.index()];
+            for (auto col = fromRow.begin(); col != fromRow.end(); ++col) {
+                row.insert(col.index());
+            }
+        }
+        convertMatrixValues(from, *to);
+        return to;
+    }
+} // namespace Details
+
+/// \brief The well operator in single precision, forwarding to the double precision one.
+///
+/// The wells are not assembled into a matrix, so their contributions are
+/// computed in double precision with converted copies of the vectors.
+template <class X, class FloatX>
+class SinglePrecisionWellOperator : public LinearOperatorExtra<FloatX, FloatX>
+{
+public:
+    using Base = LinearOperatorExtra<FloatX, FloatX>;
+    using field_type = typename Base::field_type;
+    using PressureMatrix = typename Base::PressureMatrix;
+
+    explicit SinglePrecisionWellOperator(const LinearOperatorExtra<X, X>& wells)
+        : wells_(wells)
+    {
+    }
+
+    void apply(const FloatX& x, FloatX& y) const override
+    {
+        Details::convertVector(x, x_);
+        y_.resize(y.size());
+        y_ = 0.0;
+        wells_.apply(x_, y_);
+        addWellContributions(y);
+    }
+
+    void applyscaleadd(field_type alpha, const FloatX& x, FloatX& y) const override
+    {
+        Details::convertVector(x, x_);
+        y_.resize(y.size());
+        y_ = 0.0;
+        wells_.applyscaleadd(alpha, x_, y_);
+        addWellContributions(y);
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return Dune::SolverCategory::sequential;
+    }
+
+    void addWellPressureEquations(PressureMatrix& jacobian, const FloatX& weights, const bool use_well_weights) const override
+    {
+        X doubleWeights;
+        Details::convertVector(weights, doubleWeights);
+        wells_.addWellPressureEquations(jacobian, doubleWeights, use_well_weights);
+    }
+
+    void addWellPressureEquationsStruct(PressureMatrix& jacobian) const override
+    {
+        wells_.addWellPressureEquationsStruct(jacobian);
+    }
+
+    int getNumberOfExtraEquations() const override
+    {
+        return wells_.getNumberOfExtraEquations();
+    }
+
+private:
+    void addWellContributions(FloatX& y) const
+    {
+        const std::ptrdiff_t size = y.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t i = 0; i < size; ++i) {
+            for (std::size_t k = 0; k < y[i].size(); ++k) {
+                y[i][k] += y_[i][k];
+            }
+        }
+    }
+
+    const LinearOperatorExtra<X, X>& wells_;
+    mutable X x_;
+    mutable X y_;
+};
+
+/// \brief The single precision counterpart of an operator type, if there is one.
+///
+/// make() creates it for a single precision copy of the matrix of the
+/// double precision operator, together with the well operator it needs.
+template <class Operator>
+struct SinglePrecisionOperator
+{
+    static constexpr bool available = false;
+};
+
+template <class M, class X, class Y>
+struct SinglePrecisionOperator<Dune::MatrixAdapter<M, X, Y>>
+{
+    static constexpr bool available = true;
+    using FloatVector = SinglePrecisionVector<X>;
+    using type = Dune::MatrixAdapter<SinglePrecisionMatrix<M>, FloatVector, FloatVector>;
+    using WellOperator = SinglePrecisionWellOperator<X, FloatVector>;
+
+    template <class Comm>
+    static std::unique_ptr<type> make(const Dune::MatrixAdapter<M, X, Y>&, const SinglePrecisionMatrix<M>& A,
+                                      std::unique_ptr<WellOperator>&, const Comm&)
+    {
+        return std::make_unique<type>(A);
+    }
+};
+
+template <class M, class X, class Y, bool overlapping>
+struct SinglePrecisionOperator<WellModelMatrixAdapter<M, X, Y, overlapping>>
+{
+    static constexpr bool available = true;
+    using FloatVector = SinglePrecisionVector<X>;
+    using type = WellModelMatrixAdapter<SinglePrecisionMatrix<M>, FloatVector, FloatVector, overlapping>;
+    using WellOperator = SinglePrecisionWellOperator<X, FloatVector>;
+
+    template <class Comm>
+    static std::unique_ptr<type> make(const WellModelMatrixAdapter<M, X, Y, overlapping>& op,
+                                      const SinglePrecisionMatrix<M>& A,
+                                      std::unique_ptr<WellOperator>& wells, const Comm&)
+    {
+        wells = std::make_unique<WellOperator>(op.wellOperator());
+        return std::make_unique<type>(A, *wells);
+    }
+};
+
+template <class M, class X, class Y, bool overlapping>
+struct SinglePrecisionOperator<WellModelGhostLastMatrixAdapter<M, X, Y, overlapping>>
+{
+    static constexpr bool available = true;
+    using FloatVector = SinglePrecisionVector<X>;
+    using type = WellModelGhostLastMatrixAdapter<SinglePrecisionMatrix<M>, FloatVector, FloatVector, overlapping>;
+    using WellOperator = SinglePrecisionWellOperator<X, FloatVector>;
+
+    template <class Comm>
+    static std::unique_ptr<type> make(const WellModelGhostLastMatrixAdapter<M, X, Y, overlapping>& op,
+                                      const SinglePrecisionMatrix<M>& A,
+                                      std::unique_ptr<WellOperator>& wells, const Comm&)
+    {
+        wells = std::make_unique<WellOperator>(op.wellOperator());
+        return std::make_unique<type>(A, *wells, op.interiorSize());
+    }
+};
+
+#if HAVE_MPI
+template <class M, class X, class Y, class C>
+struct SinglePrecisionOperator<Dune::OverlappingSchwarzOperator<M, X, Y, C>>
+{
+    static constexpr bool available = true;
+    using FloatVector = SinglePrecisionVector<X>;
+    using type = Dune::OverlappingSchwarzOperator<SinglePrecisionMatrix<M>, FloatVector, FloatVector, C>;
+    using WellOperator = SinglePrecisionWellOperator<X, FloatVector>;
+
+    template <class Comm>
+    static std::unique_ptr<type> make(const Dune::OverlappingSchwarzOperator<M, X, Y, C>&,
+                                      const SinglePrecisionMatrix<M>& A,
+                                      std::unique_ptr<WellOperator>&, const Comm& comm)
+    {
+        if constexpr (std::is_same_v<Comm, C>) {
+            return std::make_unique<type>(A, comm);
+        } else {
+            OPM_THROW(std::logic_error, "An overlapping Schwarz operator needs a parallel communication.");
+        }
+    }
+};
+#endif
+
+} // namespace Opm
+
+namespace Dune
+{
+
+/// \brief Iterative refinement in double precision around a single precision solve.
+///
+/// The matrix is copied to single precision, and the Krylov solver and
+/// preconditioner given by the property tree (including an AMG hierarchy)
+/// work on that copy with single precision vectors. This roughly halves
+/// the memory traffic of the inner solve. The outer loop computes the
+/// true residual in double precision with the original operator, and
+/// solves for a correction in single precision until the requested
+/// reduction is reached. The inner solve reduces the residual by
+/// "inner_tol" at most, as single precision cannot resolve much more,
+/// and "max_refinements" limits the number of corrections.
+template <class Operator>
+class MixedPrecisionSolver : public InverseOperator<typename Operator::domain_type,
+                                                   typename Operator::range_type>
+{
+public:
+    using VectorType = typename Operator::domain_type;
+    using MatrixType = typename Operator::matrix_type;
+    using FloatMatrixType = Opm::SinglePrecisionMatrix<MatrixType>;
+    using FloatVectorType = Opm::SinglePrecisionVector<VectorType>;
+    using FloatOperatorTraits = Opm::SinglePrecisionOperator<Operator>;
+    using FloatOperatorType = typename FloatOperatorTraits::type;
+
+    template <class Comm>
+    MixedPrecisionSolver(const Operator& op,
+                         const Comm& comm,
+                         const Opm::PropertyTree& prm,
+                         const std::function<void(VectorType&)>& weightsCalculator,
+                         std::size_t pressureIndex)
+        : op_(op)
+        , tol_(prm.get<double>("tol", 1e-2))
+        , innerTol_(prm.get<double>("inner_tol", 1e-3))
+        , maxRefinements_(prm.get<int>("max_refinements", 10))
+        , verbosity_(comm.communicator().rank() == 0 ? prm.get<int>("verbosity", 0) : 0)
+    {
+        floatMatrix_ = Opm::Details::convertMatrix<FloatMatrixType>(op.getmat());
+        floatOperator_ = FloatOperatorTraits::make(op, *floatMatrix_, floatWells_, comm);
+
+        std::function<void(FloatVectorType&)> floatWeightsCalculator;
+        if (weightsCalculator) {
+            // The double precision weights are kept between the updates of the preconditioner.
+            floatWeightsCalculator = [this, weightsCalculator](FloatVectorType& weights) {
+                weights_.resize(weights.size());
+                weightsCalculator(weights_);
+                Opm::Details::convertVector(weights_, weights);
+            };
+        }
+        // The inner solve uses the same solver and preconditioner, in single precision.
+        Opm::PropertyTree innerPrm(prm);
+        innerPrm.put("precision", std::string("single"));
+        innerPrm.put("verbosity", std::max(prm.get<int>("verbosity", 0) - 1, 0));
+        inner_ = makeInnerSolver(comm, innerPrm, floatWeightsCalculator, pressureIndex);
+        scalarProduct_ = makeScalarProduct(comm, op.category());
+        preconditioner_ = std::make_shared<Preconditioner>(*this);
+    }
+
+    void apply(VectorType& x, VectorType& b, InverseOperatorResult& res) override
+    {
+        apply(x, b, tol_, res);
+    }
+
+    void apply(VectorType& x, VectorType& b, double reduction, InverseOperatorResult& res) override
+    {
+        Dune::Timer watch;
+        res.clear();
+        // The inner Krylov solver applies the single precision copy of the
+        // matrix, which must follow the values of the current system also
+        // when the preconditioner is reused without an update.
+        Opm::Details::convertMatrixValues(op_.getmat(), *floatMatrix_);
+        // As in the Dune solvers, b is overwritten by the residual.
+        op_.applyscaleadd(-1.0, x, b);
+        const double norm0 = scalarProduct_->norm(b);
+        double norm = norm0;
+        int refinement = 0;
+        for (; refinement < maxRefinements_ && norm > reduction * norm0; ++refinement) {
+            Opm::Details::convertVector(b, floatResidual_);
+            floatCorrection_.resize(floatResidual_.size());
+            floatCorrection_ = 0.0;
+            InverseOperatorResult innerRes;
+            const double innerReduction = std::max(reduction * norm0 / norm, innerTol_);
+            inner_->apply(floatCorrection_, floatResidual_, innerReduction, innerRes);
+            res.iterations += innerRes.iterations;
+
+            Opm::Details::convertVector(floatCorrection_, correction_);
+            x += correction_;
+            // The true residual, in double precision.
+            op_.applyscaleadd(-1.0, correction_, b);
+            const double previous = norm;
+            norm = scalarProduct_->norm(b);
+            if (verbosity_ > 0) {
+                std::cout << "Mixed precision refinement " << refinement + 1 << ": " << innerRes.iterations
+                          << " inner iterations, residual reduction " << norm / norm0 << std::endl;
+            }
+            if (!(norm < previous)) {
+                // The single precision solve no longer makes progress.
+                ++refinement;
+                break;
+            }
+        }
+        res.reduction = norm0 > 0.0 ? norm / norm0 : 0.0;
+        res.converged = res.reduction <= reduction;
+        res.conv_rate = res.iterations > 0 ? std::pow(res.reduction, 1.0 / res.iterations) : 0.0;
+        res.elapsed = watch.elapsed();
+        if (verbosity_ > 0) {
+            std::cout << "Mixed precision solve: " << refinement << " refinements, " << res.iterations
+                      << " iterations, reduction " << res.reduction << std::endl;
+        }
+    }
+
+    /// \brief The single precision preconditioner, for double precision vectors.
+    /// Its update() first copies the current matrix values to single precision.
+    std::shared_ptr<PreconditionerWithUpdate<VectorType, VectorType>> preconditioner()
+    {
+        return preconditioner_;
+    }
+
+    SolverCategory::Category category() const override
+    {
+        return op_.category();
+    }
+
+private:
+    class Preconditioner : public PreconditionerWithUpdate<VectorType, VectorType>
+    {
+    public:
+        explicit Preconditioner(MixedPrecisionSolver& solver)
+            : solver_(solver)
+        {
+        }
+
+        void pre(VectorType&, VectorType&) override
+        {
+        }
+
+        void apply(VectorType& v, const VectorType& d) override
+        {
+            Opm::Details::convertVector(d, d_);
+            v_.resize(d_.size());
+            v_ = 0.0;
+            solver_.inner_->preconditioner().apply(v_, d_);
+            Opm::Details::convertVector(v_, v);
+        }
+
+        void post(VectorType&) override
+        {
+        }
+
+        void update() override
+        {
+            Opm::Details::convertMatrixValues(solver_.op_.getmat(), *solver_.floatMatrix_);
+            solver_.inner_->preconditioner().update();
+        }
+
+        SolverCategory::Category category() const override
+        {
+            return solver_.category();
+        }
+
+    private:
+        MixedPrecisionSolver& solver_;
+        FloatVectorType d_;
+        FloatVectorType v_;
+    };
+
+    template <class Comm>
+    std::unique_ptr<FlexibleSolver<FloatOperatorType>>
+    makeInnerSolver(const Comm& comm, const Opm::PropertyTree& prm,
+                    const std::function<void(FloatVectorType&)>& weightsCalculator, std::size_t pressureIndex)
+    {
+        return std::make_unique<FlexibleSolver<FloatOperatorType>>(*floatOperator_, comm, prm,
+                                                                   weightsCalculator, pressureIndex);
+    }
+
+    std::unique_ptr<FlexibleSolver<FloatOperatorType>>
+    makeInnerSolver(const Amg::SequentialInformation&, const Opm::PropertyTree& prm,
+                    const std::function<void(FloatVectorType&)>& weightsCalculator, std::size_t pressureIndex)
+    {
+        return std::make_unique<FlexibleSolver<FloatOperatorType>>(*floatOperator_, prm,
+                                                                   weightsCalculator, pressureIndex);
+    }
+
+    template <class Comm>
+    static std::shared_ptr<ScalarProduct<VectorType>>
+    makeScalarProduct(const Comm& comm, SolverCategory::Category category)
+    {
+        return createScalarProduct<VectorType, Comm>(comm, category);
+    }
+
+    static std::shared_ptr<ScalarProduct<VectorType>>
+    makeScalarProduct(const Amg::SequentialInformation&, SolverCategory::Category)
+    {
+        return std::make_shared<SeqScalarProduct<VectorType>>();
+    }
+
+    const Operator& op_;
+    double tol_;
+    double innerTol_;
+    int maxRefinements_;
+    int verbosity_;
+
+    std::unique_ptr<FloatMatrixType> floatMatrix_;
+    std::unique_ptr<typename FloatOperatorTraits::WellOperator> floatWells_;
+    std::unique_ptr<FloatOperatorType> floatOperator_;
+    std::unique_ptr<FlexibleSolver<FloatOperatorType>> inner_;
+    std::shared_ptr<ScalarProduct<VectorType>> scalarProduct_;
+    std::shared_ptr<Preconditioner> preconditioner_;
+
+    FloatVectorType floatResidual_;
+    FloatVectorType floatCorrection_;
+    VectorType correction_;
+    //! \brief Weights of the CPR preconditioner in double precision, before conversion.
+    VectorType weights_;
+};
+
+} // namespace Dune
+
+#endif // OPM_MIXEDPRECISIONSOLVER_HEADER_INCLUDED
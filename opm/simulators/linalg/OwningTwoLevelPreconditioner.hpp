@@ -83,16 +83,15 @@ public:
     using AbstractOperatorType = Dune::AssembledLinearOperator<MatrixType, VectorType, VectorType>;
 
     OwningTwoLevelPreconditioner(const OperatorType& linearoperator, const Opm::PropertyTree& prm,
-                                 const std::function<VectorType()> weightsCalculator,
+                                 const std::function<void(VectorType&)> weightsCalculator,
                                  std::size_t pressureIndex)
         : linear_operator_(linearoperator)
         , finesmoother_(PrecFactory::create(linearoperator,
                                             prm.get_child_optional("finesmoother") ?
                                             prm.get_child("finesmoother") : Opm::PropertyTree(),
-                                            std::function<VectorType()>(), pressureIndex))
-        , comm_(nullptr)
+                                            std::function<void(VectorType&)>(), pressureIndex))
         , weightsCalculator_(weightsCalculator)
-        , weights_(weightsCalculator())
+        , weights_(initialWeights(weightsCalculator, linearoperator.getmat().N()))
         , levelTransferPolicy_(dummy_comm_, weights_, prm, pressureIndex)
         , coarseSolverPolicy_(prm.get_child_optional("coarsesolver") ? prm.get_child("coarsesolver") : Opm::PropertyTree())
         , twolevel_method_(linearoperator,
@@ -101,7 +100,6 @@ public:
                            coarseSolverPolicy_,
                            prm.get<int>("pre_smooth", 0),
                            prm.get<int>("post_smooth", 1))
-        , prm_(prm)
     {
         if (prm.get<int>("verbosity", 0) > 10) {
             std::string filename = prm.get<std::string>("weights_filename", "impes_weights.txt");
@@ -114,18 +112,17 @@ public:
     }
 
     OwningTwoLevelPreconditioner(const OperatorType& linearoperator, const Opm::PropertyTree& prm,
-                                 const std::function<VectorType()> weightsCalculator,
+                                 const std::function<void(VectorType&)> weightsCalculator,
                                  std::size_t pressureIndex, const Communication& comm)
         : linear_operator_(linearoperator)
         , finesmoother_(PrecFactory::create(linearoperator,
                                             prm.get_child_optional("finesmoother") ?
                                             prm.get_child("finesmoother"): Opm::PropertyTree(),
-                                            std::function<VectorType()>(),
+                                            std::function<void(VectorType&)>(),
                                             comm, pressureIndex))
-        , comm_(&comm)
         , weightsCalculator_(weightsCalculator)
-        , weights_(weightsCalculator())
-        , levelTransferPolicy_(*comm_, weights_, prm, pressureIndex)
+        , weights_(initialWeights(weightsCalculator, linearoperator.getmat().N()))
+        , levelTransferPolicy_(comm, weights_, prm, pressureIndex)
         , coarseSolverPolicy_(prm.get_child_optional("coarsesolver") ? prm.get_child("coarsesolver") : Opm::PropertyTree())
         , twolevel_method_(linearoperator,
                            finesmoother_,
@@ -133,7 +130,6 @@ public:
                            coarseSolverPolicy_,
                            prm.get<int>("pre_smooth", 0),
                            prm.get<int>("post_smooth", 1))
-        , prm_(prm)
     {
         if (prm.get<int>("verbosity", 0) > 10 && comm.communicator().rank() == 0) {
             auto filename = prm.get<std::string>("weights_filename", "impes_weights.txt");
@@ -160,10 +156,16 @@ public:
         twolevel_method_.post(x);
     }
 
+    /// Numeric-only re-setup for a changed matrix with the same sparsity
+    /// pattern: the weights and the fine smoother are updated in place,
+    /// the coarse entries are recomputed and the coarse solver keeps its
+    /// AMG aggregates and coarse sparsity, only recomputing the Galerkin
+    /// products and smoothers (see AMGCPR::update()).
     virtual void update() override
     {
-        weights_ = weightsCalculator_();
-        updateImpl(comm_);
+        weightsCalculator_(weights_);
+        finesmoother_->update();
+        twolevel_method_.updatePreconditioner(finesmoother_, coarseSolverPolicy_);
     }
 
     virtual Dune::SolverCategory::Category category() const override
@@ -172,6 +174,13 @@ public:
     }
 
 private:
+    static VectorType initialWeights(const std::function<void(VectorType&)>& weightsCalculator, std::size_t size)
+    {
+        VectorType weights(size);
+        weightsCalculator(weights);
+        return weights;
+    }
+
     using CoarseOperator = typename LevelTransferPolicy::CoarseOperator;
     using CoarseSolverPolicy = Dune::Amg::PressureSolverPolicy<CoarseOperator,
                                                                FlexibleSolver<CoarseOperator>,
@@ -179,33 +188,13 @@ private:
     using TwoLevelMethod
         = Dune::Amg::TwoLevelMethodCpr<OperatorType, CoarseSolverPolicy, Dune::Preconditioner<VectorType, VectorType>>;
 
-    // Handling parallel vs serial instantiation of preconditioner factory.
-    template <class Comm>
-    void updateImpl(const Comm*)
-    {
-        // Parallel case.
-        auto child = prm_.get_child_optional("finesmoother");
-        finesmoother_ = PrecFactory::create(linear_operator_, child ? *child : Opm::PropertyTree(), *comm_);
-        twolevel_method_.updatePreconditioner(finesmoother_, coarseSolverPolicy_);
-    }
-
-    void updateImpl(const Dune::Amg::SequentialInformation*)
-    {
-        // Serial case.
-        auto child = prm_.get_child_optional("finesmoother");
-        finesmoother_ = PrecFactory::create(linear_operator_, child ? *child : Opm::PropertyTree());
-        twolevel_method_.updatePreconditioner(finesmoother_, coarseSolverPolicy_);
-    }
-
     const OperatorType& linear_operator_;
-    std::shared_ptr<Dune::Preconditioner<VectorType, VectorType>> finesmoother_;
-    const Communication* comm_;
-    std::function<VectorType()> weightsCalculator_;
+    typename PrecFactory::PrecPtr finesmoother_;
+    std::function<void(VectorType&)> weightsCalculator_;
     VectorType weights_;
     LevelTransferPolicy levelTransferPolicy_;
     CoarseSolverPolicy coarseSolverPolicy_;
     TwoLevelMethod twolevel_method_;
-    Opm::PropertyTree prm_;
     Communication dummy_comm_;
 };
 
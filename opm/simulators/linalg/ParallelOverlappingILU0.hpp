@@ -22,19 +22,23 @@
 
 #include <opm/simulators/linalg/GraphColoring.hpp>
 #include <opm/simulators/linalg/MILU.hpp>
+#include <opm/simulators/linalg/PersistentHaloExchange.hpp>
 #include <opm/simulators/linalg/PreconditionerWithUpdate.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <dune/common/version.hh>
+#include <dune/common/fmatrix.hh>
 #include <dune/istl/preconditioner.hh>
 #include <dune/istl/ilu.hh>
 #include <dune/istl/paamg/smoother.hh>
 #include <dune/istl/paamg/graph.hh>
 #include <dune/istl/paamg/pinfo.hh>
 
+#include <algorithm>
 #include <type_traits>
 #include <numeric>
 #include <limits>
 #include <cstddef>
+#include <memory>
 #include <string>
 
 namespace Opm
@@ -45,13 +49,45 @@ namespace Opm
 template<class Matrix, class Domain, class Range, class ParallelInfo = Dune::Amg::SequentialInformation>
 class ParallelOverlappingILU0;
 
+/// \brief The precision used for storing the factors of the ILU decomposition.
+///
+/// The Krylov vectors always stay in the field type of the vectors. Storing
+/// the factors in single precision roughly halves the memory traffic of
+/// the (bandwidth bound) triangular solves.
+enum class ILUStorage {
+    /// \brief Store all factors in the field type of the matrix.
+    Double = 0,
+    /// \brief Store L and U in float and the inverted diagonal in the field type of the matrix.
+    Float = 1,
+    /// \brief Store L, U and the inverted diagonal in float.
+    FloatAll = 2
+};
+
+inline ILUStorage convertString2ILUStorage(const std::string& storage)
+{
+    if ( storage == "double" )
+    {
+        return ILUStorage::Double;
+    }
+    if ( storage == "float" )
+    {
+        return ILUStorage::Float;
+    }
+    if ( storage == "float_all" )
+    {
+        return ILUStorage::FloatAll;
+    }
+    OPM_THROW(std::invalid_argument, "Unknown ILU storage " << storage
+              << ". Valid options are double, float and float_all.");
+}
+
 template<class F>
 class ParallelOverlappingILU0Args
     : public Dune::Amg::DefaultSmootherArgs<F>
 {
  public:
     ParallelOverlappingILU0Args(MILU_VARIANT milu = MILU_VARIANT::ILU )
-        : milu_(milu), n_(0)
+        : milu_(milu), n_(0), levelScheduling_(false), storage_(ILUStorage::Double)
     {}
     void setMilu(MILU_VARIANT milu)
     {
@@ -69,9 +105,27 @@ class ParallelOverlappingILU0Args
     {
         return n_;
     }
+    void setLevelScheduling(bool levelScheduling)
+    {
+        levelScheduling_ = levelScheduling;
+    }
+    bool getLevelScheduling() const
+    {
+        return levelScheduling_;
+    }
+    void setStorage(ILUStorage storage)
+    {
+        storage_ = storage;
+    }
+    ILUStorage getStorage() const
+    {
+        return storage_;
+    }
  private:
     MILU_VARIANT milu_;
     int n_;
+    bool levelScheduling_;
+    ILUStorage storage_;
 };
 } // end namespace Opm
 
@@ -113,7 +167,10 @@ struct ConstructionTraits<Opm::ParallelOverlappingILU0<Matrix,Domain,Range,Paral
                       args.getComm(),
                       args.getArgs().getN(),
                       args.getArgs().relaxationFactor,
-                      args.getArgs().getMilu()) );
+                      args.getArgs().getMilu(),
+                      false, true,
+                      args.getArgs().getLevelScheduling(),
+                      args.getArgs().getStorage()) );
     }
 
 #if ! DUNE_VERSION_NEWER(DUNE_ISTL, 2, 7)
@@ -283,6 +340,60 @@ namespace Opm
         }
         assert(colcount == numUpper);
       }
+
+      //! \brief Group the rows [start, end) of a triangular CRS factor into levels.
+      //!
+      //! A row only depends on rows of lower levels. Hence all rows of one level
+      //! can be processed concurrently during the triangular solve.
+      //! \param crs The lower or upper factor as stored by convertToCRS.
+      //! \param start The first row of the triangular solve.
+      //! \param end One past the last row of the triangular solve.
+      //! \param colToRow Maps a column index of the factor to the row of the
+      //!                 triangular solve computing the corresponding unknown.
+      //! \param levelRows The rows sorted by level.
+      //! \param levelPointers The start of each level in levelRows, with one
+      //!                      additional entry marking the end of the last level.
+      template<class CRS, class ColToRow>
+      void findLevelSets(const CRS& crs, std::size_t start, std::size_t end,
+                         const ColToRow& colToRow,
+                         std::vector<std::size_t>& levelRows,
+                         std::vector<std::size_t>& levelPointers)
+      {
+        std::vector<std::size_t> level(end - start, 0);
+        std::size_t numLevels = 0;
+        for (std::size_t row = start; row < end; ++row)
+        {
+          std::size_t rowLevel = 0;
+          for (auto col = crs.rows_[ row ]; col < crs.rows_[ row+1 ]; ++col)
+          {
+            const std::size_t dependency = colToRow( crs.cols_[ col ] );
+            // Entries outside of [start, row) are not computed by this
+            // solve (e.g. ghost rows) and do not impose an ordering.
+            if ( dependency >= start && dependency < row )
+            {
+              rowLevel = std::max( rowLevel, level[ dependency - start ] + 1 );
+            }
+          }
+          level[ row - start ] = rowLevel;
+          numLevels = std::max( numLevels, rowLevel + 1 );
+        }
+
+        // Counting sort of the rows by level, keeping the original
+        // order of the rows within each level.
+        levelPointers.assign( numLevels + 1, 0 );
+        for (const auto rowLevel : level)
+        {
+          ++levelPointers[ rowLevel + 1 ];
+        }
+        std::partial_sum( levelPointers.begin(), levelPointers.end(), levelPointers.begin() );
+
+        std::vector<std::size_t> next( levelPointers.begin(), levelPointers.end() - 1 );
+        levelRows.resize( end - start );
+        for (std::size_t row = start; row < end; ++row)
+        {
+          levelRows[ next[ level[ row - start ] ]++ ] = row;
+        }
+      }
     } // end namespace detail
 
 
@@ -296,6 +407,10 @@ namespace Opm
 /// make sure that x is consistent.
 /// In contrast for ParallelRestrictedOverlappingSchwarz we solve (LU)x = d for x
 /// without forcing consistency between the two steps.
+/// Optionally the owner rows that other processes have copies of are ordered
+/// last, so that they come first in the backward solve. Their values are
+/// then sent with non-blocking messages while the backward solve of the
+/// other rows goes on.
 /// \tparam Matrix The type of the Matrix.
 /// \tparam Domain The type of the Vector representing the domain.
 /// \tparam Range The type of the Vector representing the range.
@@ -321,10 +436,14 @@ public:
     typedef typename matrix_type::block_type  block_type;
     typedef typename matrix_type::size_type   size_type;
 
+    //! \brief The single precision block type used for ILUStorage::Float.
+    typedef Dune::FieldMatrix< float, block_type::rows, block_type::cols > float_block_type;
+
 protected:
-    struct CRS
+    template< class BlockType >
+    struct CRSStorage
     {
-      CRS() : nRows_( 0 ) {}
+      CRSStorage() : nRows_( 0 ) {}
 
       size_type rows() const { return nRows_; }
 
@@ -354,7 +473,7 @@ protected:
           }
       }
 
-      void push_back( const block_type& value, const size_type index )
+      void push_back( const BlockType& value, const size_type index )
       {
           values_.push_back( value );
           cols_.push_back( index );
@@ -369,11 +488,14 @@ protected:
       }
 
       std::vector< size_type  > rows_;
-      std::vector< block_type > values_;
+      std::vector< BlockType  > values_;
       std::vector< size_type  > cols_;
       size_type nRows_;
     };
 
+    typedef CRSStorage< block_type > CRS;
+    typedef CRSStorage< float_block_type > FloatCRS;
+
 public:
     Dune::SolverCategory::Category category() const override
     {
@@ -393,19 +515,25 @@ public:
                             The vertices on each layer aound it (same distance) are
                             ordered consecutivly. If false, we preserver the order of
                             the vertices with the same color.
+      \param level_scheduling If true, the triangular solves in apply are
+                              run level by level, with the rows of each
+                              level distributed among the OpenMP threads.
+      \param storage The precision used for storing the ILU factors. \see ILUStorage.
     */
     template<class BlockType, class Alloc>
     ParallelOverlappingILU0 (const Dune::BCRSMatrix<BlockType,Alloc>& A,
                              const int n, const field_type w,
                              MILU_VARIANT milu, bool redblack=false,
-                             bool reorder_sphere=true)
+                             bool reorder_sphere=true, bool level_scheduling=false,
+                             ILUStorage storage=ILUStorage::Double)
         : lower_(),
           upper_(),
           inv_(),
           comm_(nullptr), w_(w),
           relaxation_( std::abs( w - 1.0 ) > 1e-15 ),
           A_(&reinterpret_cast<const Matrix&>(A)), iluIteration_(n),
-          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere)
+          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere),
+          levelScheduling_(level_scheduling), storage_(storage)
     {
         interiorSize_ = A.N();
         // BlockMatrix is a Subclass of FieldMatrix that just adds
@@ -424,19 +552,25 @@ public:
                             The vertices on each layer aound it (same distance) are
                             ordered consecutivly. If false, we preserver the order of
                             the vertices with the same color.
+      \param level_scheduling If true, the triangular solves in apply are
+                              run level by level, with the rows of each
+                              level distributed among the OpenMP threads.
+      \param storage The precision used for storing the ILU factors. \see ILUStorage.
     */
     template<class BlockType, class Alloc>
     ParallelOverlappingILU0 (const Dune::BCRSMatrix<BlockType,Alloc>& A,
                              const ParallelInfo& comm, const int n, const field_type w,
                              MILU_VARIANT milu, bool redblack=false,
-                             bool reorder_sphere=true)
+                             bool reorder_sphere=true, bool level_scheduling=false,
+                             ILUStorage storage=ILUStorage::Double)
         : lower_(),
           upper_(),
           inv_(),
           comm_(&comm), w_(w),
           relaxation_( std::abs( w - 1.0 ) > 1e-15 ),
           A_(&reinterpret_cast<const Matrix&>(A)), iluIteration_(n),
-          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere)
+          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere),
+          levelScheduling_(level_scheduling), storage_(storage)
     {
         interiorSize_ = A.N();
         // BlockMatrix is a Subclass of FieldMatrix that just adds
@@ -455,12 +589,17 @@ public:
                   The vertices on each layer aound it (same distance) are
                   ordered consecutivly. If false, we preserver the order of
                   the vertices with the same color.
+      \param level_scheduling If true, the triangular solves in apply are
+                              run level by level, with the rows of each
+                              level distributed among the OpenMP threads.
+      \param storage The precision used for storing the ILU factors. \see ILUStorage.
     */
     template<class BlockType, class Alloc>
     ParallelOverlappingILU0 (const Dune::BCRSMatrix<BlockType,Alloc>& A,
                              const field_type w, MILU_VARIANT milu, bool redblack=false,
-                             bool reorder_sphere=true)
-        : ParallelOverlappingILU0( A, 0, w, milu, redblack, reorder_sphere )
+                             bool reorder_sphere=true, bool level_scheduling=false,
+                             ILUStorage storage=ILUStorage::Double)
+        : ParallelOverlappingILU0( A, 0, w, milu, redblack, reorder_sphere, level_scheduling, storage )
     {
     }
 
@@ -476,19 +615,25 @@ public:
                             The vertices on each layer aound it (same distance) are
                             ordered consecutivly. If false, we preserver the order of
                             the vertices with the same color.
+      \param level_scheduling If true, the triangular solves in apply are
+                              run level by level, with the rows of each
+                              level distributed among the OpenMP threads.
+      \param storage The precision used for storing the ILU factors. \see ILUStorage.
     */
     template<class BlockType, class Alloc>
     ParallelOverlappingILU0 (const Dune::BCRSMatrix<BlockType,Alloc>& A,
                              const ParallelInfo& comm, const field_type w,
                              MILU_VARIANT milu, bool redblack=false,
-                             bool reorder_sphere=true)
+                             bool reorder_sphere=true, bool level_scheduling=false,
+                             ILUStorage storage=ILUStorage::Double)
         : lower_(),
           upper_(),
           inv_(),
           comm_(&comm), w_(w),
           relaxation_( std::abs( w - 1.0 ) > 1e-15 ),
           A_(&reinterpret_cast<const Matrix&>(A)), iluIteration_(0),
-          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere)
+          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere),
+          levelScheduling_(level_scheduling), storage_(storage)
     {
         interiorSize_ = A.N();
         // BlockMatrix is a Subclass of FieldMatrix that just adds
@@ -509,13 +654,25 @@ public:
                             The vertices on each layer aound it (same distance) are
                             ordered consecutivly. If false, we preserver the order of
                             the vertices with the same color.
+      \param level_scheduling If true, the triangular solves in apply are
+                              run level by level, with the rows of each
+                              level distributed among the OpenMP threads.
+      \param storage The precision used for storing the ILU factors. \see ILUStorage.
+      \param overlap_communication If true, the values of the owner rows are
+                                   sent during the backward solve. Only used
+                                   for ILU0 without red-black ordering. The
+                                   rows are then reordered, which copies the
+                                   matrix at every update and the vectors at
+                                   every apply, so it is off by default.
     */
     template<class BlockType, class Alloc>
     ParallelOverlappingILU0 (const Dune::BCRSMatrix<BlockType,Alloc>& A,
                              const ParallelInfo& comm,
                              const field_type w, MILU_VARIANT milu,
                              size_type interiorSize, bool redblack=false,
-                             bool reorder_sphere=true)
+                             bool reorder_sphere=true, bool level_scheduling=false,
+                             ILUStorage storage=ILUStorage::Double,
+                             bool overlap_communication=false)
         : lower_(),
           upper_(),
           inv_(),
@@ -523,7 +680,9 @@ public:
           relaxation_( std::abs( w - 1.0 ) > 1e-15 ),
           interiorSize_(interiorSize),
           A_(&reinterpret_cast<const Matrix&>(A)), iluIteration_(0),
-          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere)
+          milu_(milu), redBlack_(redblack), reorderSphere_(reorder_sphere),
+          levelScheduling_(level_scheduling), storage_(storage),
+          overlapCommunication_(overlap_communication)
     {
         // BlockMatrix is a Subclass of FieldMatrix that just adds
         // methods. Therefore this cast should be safe.
@@ -551,51 +710,20 @@ public:
         Range& md = reorderD(d);
         Domain& mv = reorderV(v);
 
-        // iterator types
-        typedef typename Range ::block_type  dblock;
-        typedef typename Domain::block_type  vblock;
-
-        const size_type iEnd = lower_.rows();
-        const size_type lastRow = iEnd - 1;
-        size_type upperLoppStart = iEnd - interiorSize_;
-        size_type lowerLoopEnd = interiorSize_;
-        if( iEnd != upper_.rows() )
-        {
-            OPM_THROW(std::logic_error,"ILU: number of lower and upper rows must be the same");
-        }
-
-        // lower triangular solve
-        for( size_type i=0; i<lowerLoopEnd; ++ i )
+        switch ( storage_ )
         {
-          dblock rhs( md[ i ] );
-          const size_type rowI     = lower_.rows_[ i ];
-          const size_type rowINext = lower_.rows_[ i+1 ];
-
-          for( size_type col = rowI; col < rowINext; ++ col )
-          {
-            lower_.values_[ col ].mmv( mv[ lower_.cols_[ col ] ], rhs );
-          }
-
-          mv[ i ] = rhs;  // Lii = I
+        case ILUStorage::Float:
+            applyFactors( lowerFloat_, upperFloat_, inv_, md, mv );
+            break;
+        case ILUStorage::FloatAll:
+            applyFactors( lowerFloat_, upperFloat_, invFloat_, md, mv );
+            break;
+        default:
+            applyFactors( lower_, upper_, inv_, md, mv );
+            break;
         }
 
-        for( size_type i=upperLoppStart; i<iEnd; ++ i )
-        {
-            vblock& vBlock = mv[ lastRow - i ];
-            vblock rhs ( vBlock );
-            const size_type rowI     = upper_.rows_[ i ];
-            const size_type rowINext = upper_.rows_[ i+1 ];
-
-            for( size_type col = rowI; col < rowINext; ++ col )
-            {
-                upper_.values_[ col ].mmv( mv[ upper_.cols_[ col ] ], rhs );
-            }
-
-            // apply inverse and store result
-            inv_[ i ].mv( rhs, vBlock);
-        }
-
-        copyOwnerToAll( mv );
+        finishCopyOwnerToAll( mv );
 
         if( relaxation_ ) {
             mv *= w_;
@@ -611,6 +739,19 @@ public:
         }
     }
 
+    //! \brief Complete the copy started during the backward solve, if any.
+    void finishCopyOwnerToAll( Domain& v ) const
+    {
+#if HAVE_MPI
+        if ( haloExchange_ )
+        {
+            haloExchange_->finish( v );
+            return;
+        }
+#endif
+        copyOwnerToAll( v );
+    }
+
     /*!
       \brief Clean up.
 
@@ -639,6 +780,13 @@ public:
             }
         }
 
+        if ( overlapCommunication_ )
+        {
+            // The ordering only depends on the communication, set it up once.
+            overlapCommunication_ = false;
+            setupHaloExchange();
+        }
+
         int ilu_setup_successful = 1;
         std::string message;
         const int rank = ( comm_ ) ? comm_->communicator().rank() : 0;
@@ -770,9 +918,230 @@ public:
 
         // store ILU in simple CRS format
         detail::convertToCRS( *ILU, lower_, upper_, inv_ );
+
+        if ( levelScheduling_ && lower_.rows() > 0 )
+        {
+            // upper_ stores the rows in reverse order.
+            const size_type lastRow = upper_.rows() - 1;
+            const size_type borderEnd = upper_.rows() - interiorSize_ + borderSize_;
+            detail::findLevelSets( lower_, 0, interiorSize_,
+                                   [](size_type col) { return col; },
+                                   lowerLevelRows_, lowerLevelPointers_ );
+            detail::findLevelSets( upper_, upper_.rows() - interiorSize_, borderEnd,
+                                   [lastRow](size_type col) { return lastRow - col; },
+                                   borderLevelRows_, borderLevelPointers_ );
+            detail::findLevelSets( upper_, borderEnd, upper_.rows(),
+                                   [lastRow](size_type col) { return lastRow - col; },
+                                   upperLevelRows_, upperLevelPointers_ );
+        }
+
+        if ( storage_ != ILUStorage::Double )
+        {
+            // Keep only the single precision copies of the factors.
+            copyToFloat( lower_, lowerFloat_ );
+            copyToFloat( upper_, upperFloat_ );
+            lower_ = CRS();
+            upper_ = CRS();
+            if ( storage_ == ILUStorage::FloatAll )
+            {
+                invFloat_.resize( inv_.size() );
+                for ( size_type i = 0; i < inv_.size(); ++i )
+                {
+                    copyBlockToFloat( inv_[ i ], invFloat_[ i ] );
+                }
+                inv_ = std::vector< block_type >();
+            }
+        }
     }
 
 protected:
+    /// \brief Solve LUv = d with the factors in the given storage precision.
+    template<class LowerCRS, class UpperCRS, class InvVector>
+    void applyFactors (const LowerCRS& lower, const UpperCRS& upper,
+                       const InvVector& inv, const Range& md, Domain& mv) const
+    {
+        // iterator types
+        typedef typename Range ::block_type  dblock;
+        typedef typename Domain::block_type  vblock;
+
+        const size_type iEnd = lower.rows();
+        const size_type lastRow = iEnd - 1;
+        size_type upperLoppStart = iEnd - interiorSize_;
+        size_type lowerLoopEnd = interiorSize_;
+        if( iEnd != upper.rows() )
+        {
+            OPM_THROW(std::logic_error,"ILU: number of lower and upper rows must be the same");
+        }
+
+        auto lowerSolveRow = [&]( const size_type i )
+        {
+          dblock rhs( md[ i ] );
+          const size_type rowI     = lower.rows_[ i ];
+          const size_type rowINext = lower.rows_[ i+1 ];
+
+          for( size_type col = rowI; col < rowINext; ++ col )
+          {
+            lower.values_[ col ].mmv( mv[ lower.cols_[ col ] ], rhs );
+          }
+
+          mv[ i ] = rhs;  // Lii = I
+        };
+
+        auto upperSolveRow = [&]( const size_type i )
+        {
+            vblock& vBlock = mv[ lastRow - i ];
+            vblock rhs ( vBlock );
+            const size_type rowI     = upper.rows_[ i ];
+            const size_type rowINext = upper.rows_[ i+1 ];
+
+            for( size_type col = rowI; col < rowINext; ++ col )
+            {
+                upper.values_[ col ].mmv( mv[ upper.cols_[ col ] ], rhs );
+            }
+
+            // apply inverse and store result
+            inv[ i ].mv( rhs, vBlock);
+        };
+
+        if ( levelScheduling_ )
+        {
+            // The rows of one level do not depend on each other and
+            // are distributed among the threads.
+            applyLevelScheduled( lowerLevelRows_, lowerLevelPointers_, lowerSolveRow );
+            applyLevelScheduled( borderLevelRows_, borderLevelPointers_, upperSolveRow );
+            startCopyOwnerToAll( mv );
+            applyLevelScheduled( upperLevelRows_, upperLevelPointers_, upperSolveRow );
+        }
+        else
+        {
+            // lower triangular solve
+            for( size_type i=0; i<lowerLoopEnd; ++ i )
+            {
+                lowerSolveRow( i );
+            }
+
+            // The rows sent to other processes come first in the upper solve.
+            const size_type borderEnd = upperLoppStart + borderSize_;
+            for( size_type i=upperLoppStart; i<borderEnd; ++ i )
+            {
+                upperSolveRow( i );
+            }
+            startCopyOwnerToAll( mv );
+            for( size_type i=borderEnd; i<iEnd; ++ i )
+            {
+                upperSolveRow( i );
+            }
+        }
+    }
+
+    //! \brief Start sending the owner rows, if the communication is overlapped.
+    void startCopyOwnerToAll( const Domain& v ) const
+    {
+#if HAVE_MPI
+        if ( haloExchange_ )
+        {
+            haloExchange_->start( v );
+        }
+#else
+        DUNE_UNUSED_PARAMETER(v);
+#endif
+    }
+
+    /// \brief Set up the non-blocking copy of the owner rows, and order the
+    /// interior rows that are sent to other processes last.
+    void setupHaloExchange()
+    {
+#if HAVE_MPI
+        if constexpr ( std::is_same<ParallelInfo, Dune::OwnerOverlapCopyCommunication<int, int>>::value )
+        {
+            // Other orderings and factorizations are not split.
+            if ( !comm_ || redBlack_ || iluIteration_ != 0 || milu_ != MILU_VARIANT::ILU )
+            {
+                return;
+            }
+            auto haloExchange = std::make_unique<PersistentHaloExchange<Domain>>( *comm_ );
+            std::vector<char> isBorder( interiorSize_, false );
+            for ( const auto row : haloExchange->sendRows() )
+            {
+                if ( row >= interiorSize_ )
+                {
+                    // The owner rows are not ahead of the ghost rows.
+                    return;
+                }
+                isBorder[ row ] = true;
+            }
+            ordering_.resize( A_->N() );
+            size_type next = 0;
+            for ( size_type row = 0; row < interiorSize_; ++row )
+            {
+                if ( !isBorder[ row ] )
+                {
+                    ordering_[ row ] = next++;
+                }
+            }
+            borderSize_ = interiorSize_ - next;
+            for ( size_type row = 0; row < interiorSize_; ++row )
+            {
+                if ( isBorder[ row ] )
+                {
+                    ordering_[ row ] = next++;
+                }
+            }
+            for ( size_type row = interiorSize_; row < A_->N(); ++row )
+            {
+                ordering_[ row ] = row;
+            }
+            haloExchange->renumber( ordering_ );
+            haloExchange_ = std::move( haloExchange );
+        }
+#endif
+    }
+
+    static void copyBlockToFloat(const block_type& block, float_block_type& floatBlock)
+    {
+        for ( int i = 0; i < block_type::rows; ++i )
+        {
+            for ( int j = 0; j < block_type::cols; ++j )
+            {
+                floatBlock[ i ][ j ] = static_cast< float >( block[ i ][ j ] );
+            }
+        }
+    }
+
+    static void copyToFloat(const CRS& crs, FloatCRS& floatCrs)
+    {
+        floatCrs.clear();
+        floatCrs.resize( crs.rows() );
+        floatCrs.rows_ = crs.rows_;
+        floatCrs.cols_ = crs.cols_;
+        floatCrs.values_.resize( crs.values_.size() );
+        for ( size_type i = 0; i < crs.values_.size(); ++i )
+        {
+            copyBlockToFloat( crs.values_[ i ], floatCrs.values_[ i ] );
+        }
+    }
+
+    /// \brief Process the rows of a triangular solve level by level.
+    template<class SolveRow>
+    static void applyLevelScheduled(const std::vector<std::size_t>& levelRows,
+                                    const std::vector<std::size_t>& levelPointers,
+                                    const SolveRow& solveRow)
+    {
+        for ( std::size_t level = 0; level + 1 < levelPointers.size(); ++level )
+        {
+            const std::ptrdiff_t levelStart = levelPointers[ level ];
+            const std::ptrdiff_t levelEnd = levelPointers[ level + 1 ];
+            // Small levels are not worth the threading overhead.
+#ifdef _OPENMP
+#pragma omp parallel for if(levelEnd - levelStart > 64)
+#endif
+            for ( std::ptrdiff_t k = levelStart; k < levelEnd; ++k )
+            {
+                solveRow( levelRows[ k ] );
+            }
+        }
+    }
+
     /// \brief Reorder D if needed and return a reference to it.
     Range& reorderD(const Range& d)
     {
@@ -831,6 +1200,10 @@ protected:
     CRS lower_;
     CRS upper_;
     std::vector< block_type > inv_;
+    //! \brief The single precision copies of the decomposition, \see ILUStorage.
+    FloatCRS lowerFloat_;
+    FloatCRS upperFloat_;
+    std::vector< float_block_type > invFloat_;
     //! \brief the reordering of the unknowns
     std::vector< std::size_t > ordering_;
     //! \brief The reordered right hand side
@@ -848,6 +1221,26 @@ protected:
     MILU_VARIANT milu_;
     bool redBlack_;
     bool reorderSphere_;
+    //! \brief Whether to use level scheduling in the triangular solves.
+    bool levelScheduling_;
+    //! \brief The precision used for storing the factors.
+    ILUStorage storage_;
+    //! \brief The rows of lower_ sorted by level and the start of each level.
+    std::vector< std::size_t > lowerLevelRows_;
+    std::vector< std::size_t > lowerLevelPointers_;
+    //! \brief The rows of upper_ sorted by level and the start of each level.
+    std::vector< std::size_t > upperLevelRows_;
+    std::vector< std::size_t > upperLevelPointers_;
+    //! \brief The same for the rows of upper_ sent to other processes, which are solved first.
+    std::vector< std::size_t > borderLevelRows_;
+    std::vector< std::size_t > borderLevelPointers_;
+    //! \brief Whether to overlap the copy of the owner rows with the backward solve.
+    bool overlapCommunication_ = false;
+    //! \brief The number of interior rows sent to other processes, ordered last.
+    size_type borderSize_ = 0;
+#if HAVE_MPI
+    std::unique_ptr< PersistentHaloExchange< Domain > > haloExchange_;
+#endif
 };
 
 } // end namespace Opm
@@ -0,0 +1,189 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PERSISTENTHALOEXCHANGE_HEADER_INCLUDED
+#define OPM_PERSISTENTHALOEXCHANGE_HEADER_INCLUDED
+
+#if HAVE_MPI
+
+#include <dune/common/parallel/mpitraits.hh>
+#include <dune/istl/owneroverlapcopy.hh>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Non-blocking copy of the owner values to the copies on other processes.
+///
+/// Does the same as copyOwnerToAll() of Dune::OwnerOverlapCopyCommunication,
+/// but split into start() and finish(), so that computations that do not
+/// touch the copied rows can run while the messages are underway. The
+/// messages use persistent MPI requests and buffers that are set up once.
+/// start() must only be called once the owner rows sent to other processes
+/// (sendRows()) hold their final values, and the non-owner rows are only
+/// valid after finish().
+///
+/// \tparam Vector The block vector type to exchange.
+template <class Vector>
+class PersistentHaloExchange
+{
+public:
+    using field_type = typename Vector::field_type;
+    static constexpr int blockSize = Vector::block_type::dimension;
+
+    template <class Comm>
+    explicit PersistentHaloExchange(const Comm& comm)
+        : mpiComm_(comm.communicator())
+    {
+        using Attribute = Dune::OwnerOverlapCopyAttributeSet;
+        const auto& remoteIndices = comm.remoteIndices();
+        for (auto process = remoteIndices.begin(); process != remoteIndices.end(); ++process) {
+            Neighbour neighbour;
+            neighbour.rank = process->first;
+            // The lists are sorted by the global index on both sides, so the
+            // rows of the messages match without sending the indices.
+            for (const auto& remote : *process->second.first) {
+                const auto& local = remote.localIndexPair().local();
+                if (local.attribute() == Attribute::owner && remote.attribute() != Attribute::owner) {
+                    neighbour.sendRows.push_back(local.local());
+                } else if (local.attribute() != Attribute::owner && remote.attribute() == Attribute::owner) {
+                    neighbour.recvRows.push_back(local.local());
+                }
+            }
+            if (!neighbour.sendRows.empty() || !neighbour.recvRows.empty()) {
+                neighbours_.push_back(std::move(neighbour));
+            }
+        }
+
+        constexpr int tag = 1113;
+        const MPI_Datatype type = Dune::MPITraits<field_type>::getType();
+        for (auto& neighbour : neighbours_) {
+            neighbour.sendBuffer.resize(neighbour.sendRows.size() * blockSize);
+            neighbour.recvBuffer.resize(neighbour.recvRows.size() * blockSize);
+            if (!neighbour.sendRows.empty()) {
+                requests_.emplace_back();
+                MPI_Send_init(neighbour.sendBuffer.data(), neighbour.sendBuffer.size(), type,
+                              neighbour.rank, tag, mpiComm_, &requests_.back());
+            }
+            if (!neighbour.recvRows.empty()) {
+                requests_.emplace_back();
+                MPI_Recv_init(neighbour.recvBuffer.data(), neighbour.recvBuffer.size(), type,
+                              neighbour.rank, tag, mpiComm_, &requests_.back());
+            }
+        }
+    }
+
+    PersistentHaloExchange(const PersistentHaloExchange&) = delete;
+    PersistentHaloExchange& operator=(const PersistentHaloExchange&) = delete;
+
+    ~PersistentHaloExchange()
+    {
+        if (started_) {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+        for (auto& request : requests_) {
+            MPI_Request_free(&request);
+        }
+    }
+
+    /// \brief Renumber the rows, e.g. for a reordered copy of the vectors.
+    /// \param ordering The new index of every row.
+    void renumber(const std::vector<std::size_t>& ordering)
+    {
+        for (auto& neighbour : neighbours_) {
+            for (auto& row : neighbour.sendRows) {
+                row = ordering[row];
+            }
+            for (auto& row : neighbour.recvRows) {
+                row = ordering[row];
+            }
+        }
+    }
+
+    /// \brief Start sending the owner rows of x.
+    void start(const Vector& x)
+    {
+        for (auto& neighbour : neighbours_) {
+            auto value = neighbour.sendBuffer.begin();
+            for (const auto row : neighbour.sendRows) {
+                value = std::copy(x[row].begin(), x[row].end(), value);
+            }
+        }
+        if (!requests_.empty()) {
+            MPI_Startall(requests_.size(), requests_.data());
+        }
+        started_ = true;
+    }
+
+    /// \brief Wait for the messages and copy the received values into the non-owner rows of x.
+    void finish(Vector& x)
+    {
+        if (!started_) {
+            return;
+        }
+        if (!requests_.empty()) {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+        started_ = false;
+        for (const auto& neighbour : neighbours_) {
+            auto value = neighbour.recvBuffer.begin();
+            for (const auto row : neighbour.recvRows) {
+                std::copy(value, value + blockSize, x[row].begin());
+                value += blockSize;
+            }
+        }
+    }
+
+    /// \brief The owner rows that are sent to other processes, in any order and possibly repeated.
+    std::vector<std::size_t> sendRows() const
+    {
+        std::vector<std::size_t> rows;
+        for (const auto& neighbour : neighbours_) {
+            rows.insert(rows.end(), neighbour.sendRows.begin(), neighbour.sendRows.end());
+        }
+        return rows;
+    }
+
+private:
+    struct Neighbour
+    {
+        int rank;
+        std::vector<std::size_t> sendRows;
+        std::vector<std::size_t> recvRows;
+        std::vector<field_type> sendBuffer;
+        std::vector<field_type> recvBuffer;
+    };
+
+    MPI_Comm mpiComm_;
+    std::vector<Neighbour> neighbours_;
+    std::vector<MPI_Request> requests_;
+    bool started_ = false;
+};
+
+} // namespace Opm
+
+#endif // HAVE_MPI
+
+#endif // OPM_PERSISTENTHALOEXCHANGE_HEADER_INCLUDED
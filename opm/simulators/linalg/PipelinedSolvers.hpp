@@ -0,0 +1,580 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PIPELINED_SOLVERS_HEADER_INCLUDED
+#define OPM_PIPELINED_SOLVERS_HEADER_INCLUDED
+
+#include <dune/common/timer.hh>
+#include <dune/istl/istlexception.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/owneroverlapcopy.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solver.hh>
+
+#if HAVE_MPI
+#include <dune/common/parallel/mpitraits.hh>
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+
+/// \brief Global dot products whose reduction can be overlapped with
+/// local work.
+///
+/// start() computes the local contributions of a batch of dot products
+/// in one pass and, in parallel runs, posts a single non-blocking
+/// allreduce for all of them. wait() completes the reduction. Only rows
+/// owned by this process contribute, as in the parallel scalar product of
+/// dune-istl, so the vectors must be consistent in the same sense.
+template <class X>
+class NonBlockingDotProducts
+{
+public:
+    using field_type = typename X::field_type;
+    using Pairs = std::vector<std::pair<const X*, const X*>>;
+
+    /// \brief Sequential dot products.
+    NonBlockingDotProducts() = default;
+
+    /// \brief Dot products over the rows owned according to comm.
+    template <class Comm>
+    explicit NonBlockingDotProducts(const Comm& comm)
+    {
+        initialize(comm);
+    }
+
+    ~NonBlockingDotProducts()
+    {
+#if HAVE_MPI
+        if (pending_) {
+            MPI_Wait(&request_, MPI_STATUS_IGNORE);
+        }
+#endif
+    }
+
+    NonBlockingDotProducts(const NonBlockingDotProducts&) = delete;
+    NonBlockingDotProducts& operator=(const NonBlockingDotProducts&) = delete;
+
+    /// \brief Compute the local parts of the dot products and start the global reduction.
+    void start(const Pairs& pairs)
+    {
+        values_.assign(pairs.size(), 0.0);
+        const std::size_t size = pairs.empty() ? 0 : pairs.front().first->size();
+        for (std::size_t row = 0; row < size; ++row) {
+            if (row < mask_.size() && !mask_[row]) {
+                continue;
+            }
+            for (std::size_t k = 0; k < pairs.size(); ++k) {
+                values_[k] += (*pairs[k].first)[row] * (*pairs[k].second)[row];
+            }
+        }
+#if HAVE_MPI
+        if (parallel_) {
+            MPI_Iallreduce(MPI_IN_PLACE, values_.data(), values_.size(),
+                           MPITraits<field_type>::getType(), MPI_SUM, comm_, &request_);
+            pending_ = true;
+        }
+#endif
+    }
+
+    /// \brief Complete the reduction started last and return its results.
+    const std::vector<field_type>& wait()
+    {
+#if HAVE_MPI
+        if (pending_) {
+            MPI_Wait(&request_, MPI_STATUS_IGNORE);
+            pending_ = false;
+        }
+#endif
+        return values_;
+    }
+
+    /// \brief Blocking reduction.
+    const std::vector<field_type>& compute(const Pairs& pairs)
+    {
+        start(pairs);
+        return wait();
+    }
+
+private:
+    template <class Comm>
+    void initialize(const Comm&)
+    {
+    }
+
+#if HAVE_MPI
+    template <class GlobalIndex, class LocalIndex>
+    void initialize(const OwnerOverlapCopyCommunication<GlobalIndex, LocalIndex>& comm)
+    {
+        parallel_ = comm.communicator().size() > 1;
+        comm_ = comm.communicator();
+        for (const auto& index : comm.indexSet()) {
+            const std::size_t local = index.local().local();
+            if (local >= mask_.size()) {
+                mask_.resize(local + 1, true);
+            }
+            mask_[local] = index.local().attribute() == OwnerOverlapCopyAttributeSet::owner;
+        }
+    }
+
+    MPI_Comm comm_ = MPI_COMM_SELF;
+    MPI_Request request_ = MPI_REQUEST_NULL;
+    bool parallel_ = false;
+    bool pending_ = false;
+#endif
+
+    std::vector<bool> mask_;
+    std::vector<field_type> values_;
+};
+
+
+/// \brief Pipelined BiCGSTAB solver.
+///
+/// Right-preconditioned variant of the communication-hiding pipelined
+/// BiCGSTAB method of
+///     S. Cools and W. Vanroose, The communication-hiding pipelined
+///     BiCGStab method for the parallel solution of large unsymmetric
+///     linear systems, Parallel Computing 65 (2017), 1-20.
+/// Each iteration needs two global reductions, like BiCGSTAB, but each of
+/// them is posted non-blocking and overlapped with one preconditioner
+/// application and one matrix-vector product. This comes at the cost of
+/// several additional vector updates per iteration. The preconditioner
+/// must be a fixed linear operator.
+template <class X>
+class PipelinedBiCGSTABSolver : public InverseOperator<X, X>
+{
+public:
+    using field_type = typename X::field_type;
+
+    PipelinedBiCGSTABSolver(LinearOperator<X, X>& op,
+                            NonBlockingDotProducts<X>& dots,
+                            Preconditioner<X, X>& prec,
+                            const double reduction,
+                            const int maxit,
+                            const int verbose)
+        : op_(op)
+        , dots_(dots)
+        , prec_(prec)
+        , reduction_(reduction)
+        , maxit_(maxit)
+        , verbose_(verbose)
+    {
+    }
+
+    virtual void apply(X& x, X& b, InverseOperatorResult& res) override
+    {
+        apply(x, b, reduction_, res);
+    }
+
+    virtual void apply(X& x, X& b, double reduction, InverseOperatorResult& res) override
+    {
+        res.clear();
+        Timer watch;
+        const field_type eps = 1e-80;
+
+        X& r = b; // r = b - A x
+        op_.applyscaleadd(-1.0, x, r);
+        X rstar(r), rhat(x), w(x), what(x), t(x);
+        X phat(x), s(x), shat(x), z(x), zhat(x), v(x);
+        X q(x), qhat(x), y(x);
+        phat = 0.0; s = 0.0; shat = 0.0; z = 0.0; zhat = 0.0; v = 0.0;
+
+        prec_.pre(x, b);
+        rhat = 0.0;
+        prec_.apply(rhat, r);
+        op_.apply(rhat, w);
+        dots_.start({{&r, &r}, {&rstar, &r}, {&rstar, &w}});
+        what = 0.0;
+        prec_.apply(what, w);
+        op_.apply(what, t);
+        auto values = dots_.wait();
+
+        const field_type def0 = std::sqrt(values[0]);
+        field_type def = def0;
+        field_type rho = values[1];
+        field_type alpha = values[1] / nonZero(values[2], eps, "(r*, w)");
+        field_type beta = 0.0;
+        field_type omega = 0.0;
+        printHeader(def0);
+
+        int it = 0;
+        bool converged = def0 < eps;
+        while (!converged && it < maxit_) {
+            ++it;
+            // p = r + beta (p - omega s) and the recurrences for its images.
+            axpby(phat, rhat, beta, -beta * omega, shat);
+            axpby(s, w, beta, -beta * omega, z);
+            axpby(shat, what, beta, -beta * omega, zhat);
+            axpby(z, t, beta, -beta * omega, v);
+            // q = r - alpha s, y = A M^-1 q
+            q = r; q.axpy(-alpha, s);
+            qhat = rhat; qhat.axpy(-alpha, shat);
+            y = w; y.axpy(-alpha, z);
+
+            dots_.start({{&q, &y}, {&y, &y}, {&q, &q}});
+            zhat = 0.0;
+            prec_.apply(zhat, z);
+            op_.apply(zhat, v);
+            values = dots_.wait();
+
+            // q is the residual after the first half of the iteration.
+            const field_type halfDef = std::sqrt(values[2]);
+            if (halfDef < def0 * reduction || halfDef < 1e-30) {
+                x.axpy(alpha, phat);
+                printIteration(it, halfDef, def);
+                def = halfDef;
+                converged = true;
+                break;
+            }
+            omega = values[0] / nonZero(values[1], eps, "(y, y)");
+
+            x.axpy(alpha, phat);
+            x.axpy(omega, qhat);
+            r = q; r.axpy(-omega, y);
+            // rhat = qhat - omega (what - alpha zhat)
+            rhat = qhat; rhat.axpy(-omega, what); rhat.axpy(omega * alpha, zhat);
+            // w = y - omega (t - alpha v)
+            w = y; w.axpy(-omega, t); w.axpy(omega * alpha, v);
+
+            dots_.start({{&r, &r}, {&rstar, &r}, {&rstar, &w}, {&rstar, &s}, {&rstar, &z}});
+            what = 0.0;
+            prec_.apply(what, w);
+            op_.apply(what, t);
+            values = dots_.wait();
+
+            const field_type lastDef = def;
+            def = std::sqrt(values[0]);
+            printIteration(it, def, lastDef);
+            if (def < def0 * reduction || def < 1e-30) {
+                converged = true;
+                break;
+            }
+            beta = (alpha / nonZero(omega, eps, "omega")) * values[1] / nonZero(rho, eps, "rho");
+            rho = values[1];
+            alpha = rho / nonZero(values[2] + beta * values[3] - beta * omega * values[4], eps, "(r*, s)");
+        }
+
+        prec_.post(x);
+        finish(res, it, def, def0, converged, watch.elapsed());
+    }
+
+    virtual SolverCategory::Category category() const override
+    {
+        return op_.category();
+    }
+
+private:
+    // a = b + beta * a + gamma * c
+    static void axpby(X& a, const X& b, const field_type beta, const field_type gamma, const X& c)
+    {
+        a *= beta;
+        a += b;
+        a.axpy(gamma, c);
+    }
+
+    static field_type nonZero(const field_type value, const field_type eps, const char* what)
+    {
+        if (std::abs(value) < eps) {
+            DUNE_THROW(SolverAbort, "breakdown in pipelined BiCGSTAB - " << what << " == 0");
+        }
+        return value;
+    }
+
+    void printHeader(const field_type def0) const
+    {
+        if (verbose_ > 0) {
+            std::cout << "=== PipelinedBiCGSTABSolver" << std::endl;
+            if (verbose_ > 1) {
+                std::cout << std::setw(5) << "Iter" << std::setw(16) << "Defect" << std::setw(16) << "Rate" << std::endl;
+                std::cout << std::setw(5) << 0 << std::setw(16) << def0 << std::endl;
+            }
+        }
+    }
+
+    void printIteration(const int it, const field_type def, const field_type lastDef) const
+    {
+        if (verbose_ > 1) {
+            std::cout << std::setw(5) << it << std::setw(16) << def << std::setw(16) << def / lastDef << std::endl;
+        }
+    }
+
+    void finish(InverseOperatorResult& res, const int it, const field_type def, const field_type def0,
+                const bool converged, const double elapsed) const
+    {
+        res.iterations = it;
+        res.reduction = def0 > 0.0 ? def / def0 : 0.0;
+        res.converged = converged;
+        res.conv_rate = it > 0 ? std::pow(res.reduction, 1.0 / it) : 0.0;
+        res.elapsed = elapsed;
+        if (verbose_ > 0) {
+            std::cout << "=== rate=" << res.conv_rate << ", T=" << res.elapsed
+                      << ", TIT=" << (it > 0 ? res.elapsed / it : 0.0) << ", IT=" << it << std::endl;
+        }
+    }
+
+    LinearOperator<X, X>& op_;
+    NonBlockingDotProducts<X>& dots_;
+    Preconditioner<X, X>& prec_;
+    double reduction_;
+    int maxit_;
+    int verbose_;
+};
+
+
+/// \brief Pipelined restarted GMRES solver.
+///
+/// Right-preconditioned GMRES with a pipeline depth of one, following the
+/// p(1)-GMRES method of
+///     P. Ghysels, T.J. Ashby, K. Meerbergen and W. Vanroose, Hiding
+///     global communication latency in the GMRES algorithm on massively
+///     parallel machines, SIAM J. Sci. Comput. 35 (2013), C48-C71.
+/// The Arnoldi vectors are orthogonalised by classical Gram-Schmidt, and
+/// the dot products of one iteration, including the norm of the new
+/// vector, are reduced together in a single non-blocking reduction. That
+/// reduction is overlapped with the preconditioner application and the
+/// matrix-vector product on the not yet normalised next basis vector.
+/// Dune's RestartedGMResSolver instead needs one blocking reduction per
+/// basis vector. The images A M^-1 v of the basis vectors are kept, which
+/// doubles the memory of the Krylov basis. The preconditioner must be a
+/// fixed linear operator.
+template <class X>
+class PipelinedGMResSolver : public InverseOperator<X, X>
+{
+public:
+    using field_type = typename X::field_type;
+
+    PipelinedGMResSolver(LinearOperator<X, X>& op,
+                         NonBlockingDotProducts<X>& dots,
+                         Preconditioner<X, X>& prec,
+                         const double reduction,
+                         const int restart,
+                         const int maxit,
+                         const int verbose)
+        : op_(op)
+        , dots_(dots)
+        , prec_(prec)
+        , reduction_(reduction)
+        , restart_(std::max(restart, 1))
+        , maxit_(maxit)
+        , verbose_(verbose)
+    {
+    }
+
+    virtual void apply(X& x, X& b, InverseOperatorResult& res) override
+    {
+        apply(x, b, reduction_, res);
+    }
+
+    virtual void apply(X& x, X& b, double reduction, InverseOperatorResult& res) override
+    {
+        res.clear();
+        Timer watch;
+        const int m = restart_;
+        std::vector<X> v(m + 1, x);     // Krylov basis, v[i] is not normalised until its norm is known
+        std::vector<X> z(m + 1, x);     // z[i] = A M^-1 v[i-1]
+        X w(x), tmp(x);
+        std::vector<std::vector<field_type>> H(m + 1, std::vector<field_type>(m, 0.0));
+        std::vector<field_type> g(m + 1, 0.0), cs(m, 0.0), sn(m, 0.0);
+
+        prec_.pre(x, b);
+        if (verbose_ > 0) {
+            std::cout << "=== PipelinedGMResSolver" << std::endl;
+        }
+
+        field_type def0 = -1.0;
+        field_type def = 0.0;
+        int it = 0;
+        bool converged = false;
+        while (!converged && it < maxit_) {
+            // Start a cycle: v[0] = b - A x, z[1] = A M^-1 v[0].
+            v[0] = b;
+            op_.applyscaleadd(-1.0, x, v[0]);
+            applyOperator(v[0], z[1], tmp);
+            dots_.start(dotsOf(v, z, 0, true));
+
+            int k = 0;  // number of completed columns of H
+            for (int i = 1; ; ++i) {
+                // Overlap the reduction with the product for the next basis vector.
+                if (i < m) {
+                    applyOperator(z[i], w, tmp);
+                }
+                const auto values = dots_.wait();
+
+                // The norm of v[i-1] completes column i-2 of H.
+                const field_type eta = std::sqrt(values.back());
+                if (i == 1) {
+                    def = eta;
+                    if (def0 < 0.0) {
+                        def0 = def;
+                        if (verbose_ > 1) {
+                            std::cout << std::setw(5) << "Iter" << std::setw(16) << "Defect" << std::endl;
+                            std::cout << std::setw(5) << 0 << std::setw(16) << def0 << std::endl;
+                        }
+                    }
+                    g.assign(m + 1, 0.0);
+                    g[0] = def;
+                } else {
+                    H[i - 1][i - 2] = eta;
+                    applyGivens(H, g, cs, sn, i - 2);
+                    k = i - 1;
+                    ++it;
+                    def = std::abs(g[k]);
+                    if (verbose_ > 1) {
+                        std::cout << std::setw(5) << it << std::setw(16) << def << std::endl;
+                    }
+                }
+                if (def < def0 * reduction || def < 1e-30) {
+                    converged = true;
+                }
+                if (converged || k == m || it >= maxit_ || eta == 0.0 || i > m) {
+                    break;
+                }
+
+                // Normalise v[i-1] and scale its image accordingly.
+                v[i - 1] *= 1.0 / eta;
+                z[i] *= 1.0 / eta;
+                if (i < m) {
+                    w *= 1.0 / eta;
+                }
+                // Column i-1 of H except its subdiagonal entry.
+                for (int j = 0; j < i - 1; ++j) {
+                    H[j][i - 1] = values[j] / eta;
+                }
+                H[i - 1][i - 1] = values[i - 1] / (eta * eta);
+
+                // v[i] = z[i] - sum_j H[j][i-1] v[j], and its image z[i+1].
+                v[i] = z[i];
+                for (int j = 0; j < i; ++j) {
+                    v[i].axpy(-H[j][i - 1], v[j]);
+                }
+                if (i < m) {
+                    z[i + 1] = w;
+                    for (int j = 0; j < i; ++j) {
+                        z[i + 1].axpy(-H[j][i - 1], z[j + 1]);
+                    }
+                    dots_.start(dotsOf(v, z, i, true));
+                } else {
+                    dots_.start(dotsOf(v, z, i, false));
+                }
+            }
+
+            // Update x += M^-1 V y with H y = g.
+            if (k > 0) {
+                std::vector<field_type> yk(k, 0.0);
+                for (int i = k - 1; i >= 0; --i) {
+                    field_type sum = g[i];
+                    for (int j = i + 1; j < k; ++j) {
+                        sum -= H[i][j] * yk[j];
+                    }
+                    yk[i] = sum / H[i][i];
+                }
+                w = 0.0;
+                for (int j = 0; j < k; ++j) {
+                    w.axpy(yk[j], v[j]);
+                }
+                tmp = 0.0;
+                prec_.apply(tmp, w);
+                x += tmp;
+            }
+            if (k == 0) {
+                break;
+            }
+        }
+
+        prec_.post(x);
+        res.iterations = it;
+        res.reduction = def0 > 0.0 ? def / def0 : 0.0;
+        res.converged = converged;
+        res.conv_rate = it > 0 ? std::pow(res.reduction, 1.0 / it) : 0.0;
+        res.elapsed = watch.elapsed();
+        if (verbose_ > 0) {
+            std::cout << "=== rate=" << res.conv_rate << ", T=" << res.elapsed
+                      << ", TIT=" << (it > 0 ? res.elapsed / it : 0.0) << ", IT=" << it << std::endl;
+        }
+    }
+
+    virtual SolverCategory::Category category() const override
+    {
+        return op_.category();
+    }
+
+private:
+    // out = A M^-1 in, using tmp as scratch space.
+    void applyOperator(const X& in, X& out, X& tmp)
+    {
+        tmp = 0.0;
+        prec_.apply(tmp, in);
+        op_.apply(tmp, out);
+    }
+
+    // The dot products of z[i+1] with v[0..i], if withImage, followed by the squared norm of v[i].
+    static typename NonBlockingDotProducts<X>::Pairs
+    dotsOf(const std::vector<X>& v, const std::vector<X>& z, const int i, const bool withImage)
+    {
+        typename NonBlockingDotProducts<X>::Pairs pairs;
+        if (withImage) {
+            for (int j = 0; j <= i; ++j) {
+                pairs.emplace_back(&z[i + 1], &v[j]);
+            }
+        }
+        pairs.emplace_back(&v[i], &v[i]);
+        return pairs;
+    }
+
+    // Apply the previous rotations to column col of H, then the new one to H and g.
+    static void applyGivens(std::vector<std::vector<field_type>>& H, std::vector<field_type>& g,
+                            std::vector<field_type>& cs, std::vector<field_type>& sn, const int col)
+    {
+        for (int j = 0; j < col; ++j) {
+            const field_type temp = cs[j] * H[j][col] + sn[j] * H[j + 1][col];
+            H[j + 1][col] = -sn[j] * H[j][col] + cs[j] * H[j + 1][col];
+            H[j][col] = temp;
+        }
+        const field_type a = H[col][col];
+        const field_type b = H[col + 1][col];
+        const field_type r = std::hypot(a, b);
+        cs[col] = r > 0.0 ? a / r : 1.0;
+        sn[col] = r > 0.0 ? b / r : 0.0;
+        H[col][col] = r;
+        H[col + 1][col] = 0.0;
+        g[col + 1] = -sn[col] * g[col];
+        g[col] = cs[col] * g[col];
+    }
+
+    LinearOperator<X, X>& op_;
+    NonBlockingDotProducts<X>& dots_;
+    Preconditioner<X, X>& prec_;
+    double reduction_;
+    int restart_;
+    int maxit_;
+    int verbose_;
+};
+
+} // namespace Dune
+
+#endif // OPM_PIPELINED_SOLVERS_HEADER_INCLUDED
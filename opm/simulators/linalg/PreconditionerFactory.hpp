@@ -22,6 +22,9 @@
 #ifndef OPM_PRECONDITIONERFACTORY_HEADER
 #define OPM_PRECONDITIONERFACTORY_HEADER
 
+#include <opm/simulators/linalg/BISAI.hpp>
+#include <opm/simulators/linalg/BlockJacobiILU0.hpp>
+#include <opm/simulators/linalg/ChowPatelILU0.hpp>
 #include <opm/simulators/linalg/OwningBlockPreconditioner.hpp>
 #include <opm/simulators/linalg/OwningTwoLevelPreconditioner.hpp>
 #include <opm/simulators/linalg/ParallelOverlappingILU0.hpp>
@@ -64,9 +67,9 @@ public:
 
     /// The type of creator functions passed to addCreator().
     using Creator = std::function<PrecPtr(const Operator&, const PropertyTree&,
-                                          const std::function<Vector()>&, std::size_t)>;
+                                          const std::function<void(Vector&)>&, std::size_t)>;
     using ParCreator = std::function<PrecPtr(const Operator&, const PropertyTree&,
-                                             const std::function<Vector()>&, std::size_t, const Comm&)>;
+                                             const std::function<void(Vector&)>&, std::size_t, const Comm&)>;
 
     /// Create a new serial preconditioner and return a pointer to it.
     /// \param op    operator to be preconditioned.
@@ -74,7 +77,7 @@ public:
     /// \param weightsCalculator Calculator for weights used in CPR.
     /// \return      (smart) pointer to the created preconditioner.
     static PrecPtr create(const Operator& op, const PropertyTree& prm,
-                          const std::function<Vector()>& weightsCalculator = {},
+                          const std::function<void(Vector&)>& weightsCalculator = {},
                           std::size_t pressureIndex = std::numeric_limits<std::size_t>::max())
     {
         return instance().doCreate(op, prm, weightsCalculator, pressureIndex);
@@ -87,7 +90,7 @@ public:
     /// \param weightsCalculator Calculator for weights used in CPR.
     /// \return      (smart) pointer to the created preconditioner.
     static PrecPtr create(const Operator& op, const PropertyTree& prm,
-                          const std::function<Vector()>& weightsCalculator, const Comm& comm,
+                          const std::function<void(Vector&)>& weightsCalculator, const Comm& comm,
                           std::size_t pressureIndex = std::numeric_limits<std::size_t>::max())
     {
         return instance().doCreate(op, prm, weightsCalculator, pressureIndex, comm);
@@ -101,7 +104,7 @@ public:
     static PrecPtr create(const Operator& op, const PropertyTree& prm, const Comm& comm,
                           std::size_t pressureIndex = std::numeric_limits<std::size_t>::max())
     {
-        return instance().doCreate(op, prm, std::function<Vector()>(), pressureIndex, comm);
+        return instance().doCreate(op, prm, std::function<void(Vector&)>(), pressureIndex, comm);
     }
     /// Add a creator for a serial preconditioner to the PreconditionerFactory.
     /// After the call, the user may obtain a preconditioner by
@@ -191,6 +194,8 @@ private:
         smootherArgs.setN(iluwitdh);
         const MILU_VARIANT milu = convertString2Milu(prm.get<std::string>("milutype", std::string("ilu")));
         smootherArgs.setMilu(milu);
+        smootherArgs.setLevelScheduling(prm.get<bool>("level_scheduling", false));
+        smootherArgs.setStorage(convertString2ILUStorage(prm.get<std::string>("ilu_storage", "double")));
         // smootherArgs.overlap=SmootherArgs::vertex;
         // smootherArgs.overlap=SmootherArgs::none;
         // smootherArgs.overlap=SmootherArgs::aggregate;
@@ -245,14 +250,18 @@ private:
         const double w = prm.get<double>("relaxation", 1.0);
         const bool redblack = prm.get<bool>("redblack", false);
         const bool reorder_spheres = prm.get<bool>("reorder_spheres", false);
+        const bool level_scheduling = prm.get<bool>("level_scheduling", false);
+        const ILUStorage storage = convertString2ILUStorage(prm.get<std::string>("ilu_storage", "double"));
         // Already a parallel preconditioner. Need to pass comm, but no need to wrap it in a BlockPreconditioner.
         if (ilulevel == 0) {
             const size_t num_interior = interiorIfGhostLast(comm);
+            const bool overlap_communication = prm.get<bool>("overlap_communication", false);
             return std::make_shared<Opm::ParallelOverlappingILU0<Matrix, Vector, Vector, Comm>>(
-                op.getmat(), comm, w, Opm::MILU_VARIANT::ILU, num_interior, redblack, reorder_spheres);
+                op.getmat(), comm, w, Opm::MILU_VARIANT::ILU, num_interior, redblack, reorder_spheres, level_scheduling, storage,
+                overlap_communication);
         } else {
             return std::make_shared<Opm::ParallelOverlappingILU0<Matrix, Vector, Vector, Comm>>(
-                op.getmat(), comm, ilulevel, w, Opm::MILU_VARIANT::ILU, redblack, reorder_spheres);
+                op.getmat(), comm, ilulevel, w, Opm::MILU_VARIANT::ILU, redblack, reorder_spheres, level_scheduling, storage);
         }
     }
 
@@ -268,43 +277,63 @@ private:
         using V = Vector;
         using P = PropertyTree;
         using C = Comm;
-        doAddCreator("ILU0", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("ILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             return createParILU(op, prm, comm, 0);
         });
-        doAddCreator("ParOverILU0", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("ParOverILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             return createParILU(op, prm, comm, prm.get<int>("ilulevel", 0));
         });
-        doAddCreator("ILUn", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("ILUn", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             return createParILU(op, prm, comm, prm.get<int>("ilulevel", 0));
         });
-        doAddCreator("Jac", [](const O& op, const P& prm, const std::function<Vector()>&,
+        doAddCreator("Jac", [](const O& op, const P& prm, const std::function<void(Vector&)>&,
                                std::size_t, const C& comm) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapBlockPreconditioner<DummyUpdatePreconditioner<SeqJac<M, V, V>>>(comm, op.getmat(), n, w);
         });
-        doAddCreator("GS", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("GS", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapBlockPreconditioner<DummyUpdatePreconditioner<SeqGS<M, V, V>>>(comm, op.getmat(), n, w);
         });
-        doAddCreator("SOR", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("SOR", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapBlockPreconditioner<DummyUpdatePreconditioner<SeqSOR<M, V, V>>>(comm, op.getmat(), n, w);
         });
-        doAddCreator("SSOR", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+        doAddCreator("SSOR", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapBlockPreconditioner<DummyUpdatePreconditioner<SeqSSOR<M, V, V>>>(comm, op.getmat(), n, w);
         });
+        doAddCreator("ChowPatelILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
+            const int sweeps = prm.get<int>("sweeps", 3);
+            const int apply_sweeps = prm.get<int>("apply_sweeps", 3);
+            const double w = prm.get<double>("relaxation", 1.0);
+            return wrapBlockPreconditioner<Opm::ChowPatelILU0<M, V, V>>(comm, op.getmat(), sweeps, apply_sweeps, w);
+        });
+        doAddCreator("BISAI", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
+            const double w = prm.get<double>("relaxation", 1.0);
+            return wrapBlockPreconditioner<Opm::BISAI<M, V, V>>(comm, op.getmat(), w);
+        });
+        doAddCreator("BlockJacobiILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
+            using Prec = Opm::BlockJacobiILU0<M, V, V>;
+            const double w = prm.get<double>("relaxation", 1.0);
+            const auto partition = prm.get<std::string>("partition", "");
+            if (!partition.empty()) {
+                return wrapBlockPreconditioner<Prec>(comm, op.getmat(), Opm::BlockJacobiPartitions::get(partition), w);
+            }
+            const int blocks = prm.get<int>("blocks", 0);
+            return wrapBlockPreconditioner<Prec>(comm, op.getmat(), blocks, w);
+        });
 
         // Only add AMG preconditioners to the factory if the operator
         // is the overlapping schwarz operator. This could be extended
         // later, but at this point no other operators are compatible
         // with the AMG hierarchy construction.
         if constexpr (std::is_same_v<O, Dune::OverlappingSchwarzOperator<M, V, V, C>>) {
-            doAddCreator("amg", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t, const C& comm) {
+            doAddCreator("amg", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t, const C& comm) {
                 const std::string smoother = prm.get<std::string>("smoother", "ParOverILU0");
                 if (smoother == "ILU0" || smoother == "ParOverILU0") {
                     using Smoother = Opm::ParallelOverlappingILU0<M, V, V, C>;
@@ -317,7 +346,7 @@ private:
             });
         }
 
-        doAddCreator("cpr", [](const O& op, const P& prm, const std::function<Vector()> weightsCalculator, std::size_t pressureIndex, const C& comm) {
+        doAddCreator("cpr", [](const O& op, const P& prm, const std::function<void(Vector&)> weightsCalculator, std::size_t pressureIndex, const C& comm) {
             assert(weightsCalculator);
             if (pressureIndex == std::numeric_limits<std::size_t>::max())
             {
@@ -326,7 +355,7 @@ private:
             using LevelTransferPolicy = Opm::PressureTransferPolicy<O, Comm, false>;
             return std::make_shared<OwningTwoLevelPreconditioner<O, V, LevelTransferPolicy, Comm>>(op, prm, weightsCalculator, pressureIndex, comm);
         });
-        doAddCreator("cprt", [](const O& op, const P& prm, const std::function<Vector()> weightsCalculator, std::size_t pressureIndex, const C& comm) {
+        doAddCreator("cprt", [](const O& op, const P& prm, const std::function<void(Vector&)> weightsCalculator, std::size_t pressureIndex, const C& comm) {
             assert(weightsCalculator);
             if (pressureIndex == std::numeric_limits<std::size_t>::max())
             {
@@ -338,7 +367,7 @@ private:
 
         if constexpr (std::is_same_v<O, WellModelGhostLastMatrixAdapter<M, V, V, true>>) {
             doAddCreator("cprw",
-                         [](const O& op, const P& prm, const std::function<Vector()> weightsCalculator, std::size_t pressureIndex, const C& comm) {
+                         [](const O& op, const P& prm, const std::function<void(Vector&)> weightsCalculator, std::size_t pressureIndex, const C& comm) {
                              assert(weightsCalculator);
                              if (pressureIndex == std::numeric_limits<std::size_t>::max()) {
                                  OPM_THROW(std::logic_error, "Pressure index out of bounds. It needs to specified for CPR");
@@ -359,48 +388,74 @@ private:
         using M = Matrix;
         using V = Vector;
         using P = PropertyTree;
-        doAddCreator("ILU0", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("ILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const double w = prm.get<double>("relaxation", 1.0);
+            const bool level_scheduling = prm.get<bool>("level_scheduling", false);
+            const ILUStorage storage = convertString2ILUStorage(prm.get<std::string>("ilu_storage", "double"));
             return std::make_shared<Opm::ParallelOverlappingILU0<M, V, V>>(
-                op.getmat(), 0, w, Opm::MILU_VARIANT::ILU);
+                op.getmat(), 0, w, Opm::MILU_VARIANT::ILU, false, true, level_scheduling, storage);
         });
-        doAddCreator("ParOverILU0", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("ParOverILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const double w = prm.get<double>("relaxation", 1.0);
             const int n = prm.get<int>("ilulevel", 0);
+            const bool level_scheduling = prm.get<bool>("level_scheduling", false);
+            const ILUStorage storage = convertString2ILUStorage(prm.get<std::string>("ilu_storage", "double"));
             return std::make_shared<Opm::ParallelOverlappingILU0<M, V, V>>(
-                op.getmat(), n, w, Opm::MILU_VARIANT::ILU);
+                op.getmat(), n, w, Opm::MILU_VARIANT::ILU, false, true, level_scheduling, storage);
         });
-        doAddCreator("ILUn", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("ILUn", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const int n = prm.get<int>("ilulevel", 0);
             const double w = prm.get<double>("relaxation", 1.0);
+            const bool level_scheduling = prm.get<bool>("level_scheduling", false);
+            const ILUStorage storage = convertString2ILUStorage(prm.get<std::string>("ilu_storage", "double"));
             return std::make_shared<Opm::ParallelOverlappingILU0<M, V, V>>(
-                op.getmat(), n, w, Opm::MILU_VARIANT::ILU);
+                op.getmat(), n, w, Opm::MILU_VARIANT::ILU, false, true, level_scheduling, storage);
         });
-        doAddCreator("Jac", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("Jac", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapPreconditioner<SeqJac<M, V, V>>(op.getmat(), n, w);
         });
-        doAddCreator("GS", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("GS", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapPreconditioner<SeqGS<M, V, V>>(op.getmat(), n, w);
         });
-        doAddCreator("SOR", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("SOR", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapPreconditioner<SeqSOR<M, V, V>>(op.getmat(), n, w);
         });
-        doAddCreator("SSOR", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+        doAddCreator("SSOR", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
             const int n = prm.get<int>("repeats", 1);
             const double w = prm.get<double>("relaxation", 1.0);
             return wrapPreconditioner<SeqSSOR<M, V, V>>(op.getmat(), n, w);
         });
+        doAddCreator("ChowPatelILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
+            const int sweeps = prm.get<int>("sweeps", 3);
+            const int apply_sweeps = prm.get<int>("apply_sweeps", 3);
+            const double w = prm.get<double>("relaxation", 1.0);
+            return std::make_shared<Opm::ChowPatelILU0<M, V, V>>(op.getmat(), sweeps, apply_sweeps, w);
+        });
+        doAddCreator("BISAI", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
+            const double w = prm.get<double>("relaxation", 1.0);
+            return std::make_shared<Opm::BISAI<M, V, V>>(op.getmat(), w);
+        });
+        doAddCreator("BlockJacobiILU0", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
+            using Prec = Opm::BlockJacobiILU0<M, V, V>;
+            const double w = prm.get<double>("relaxation", 1.0);
+            const auto partition = prm.get<std::string>("partition", "");
+            if (!partition.empty()) {
+                return std::make_shared<Prec>(op.getmat(), Opm::BlockJacobiPartitions::get(partition), w);
+            }
+            const int blocks = prm.get<int>("blocks", 0);
+            return std::make_shared<Prec>(op.getmat(), blocks, w);
+        });
 
         // Only add AMG preconditioners to the factory if the operator
         // is an actual matrix operator.
         if constexpr (std::is_same_v<O, Dune::MatrixAdapter<M, V, V>>) {
-            doAddCreator("amg", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+            doAddCreator("amg", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
                 const std::string smoother = prm.get<std::string>("smoother", "ParOverILU0");
                 if (smoother == "ILU0" || smoother == "ParOverILU0") {
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 7)
@@ -429,7 +484,7 @@ private:
                     OPM_THROW(std::invalid_argument, "Properties: No smoother with name " << smoother << ".");
                 }
             });
-            doAddCreator("kamg", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+            doAddCreator("kamg", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
                 const std::string smoother = prm.get<std::string>("smoother", "ParOverILU0");
                 if (smoother == "ILU0" || smoother == "ParOverILU0") {
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 7)
@@ -461,7 +516,7 @@ private:
                     OPM_THROW(std::invalid_argument, "Properties: No smoother with name " << smoother << ".");
                 }
             });
-            doAddCreator("famg", [](const O& op, const P& prm, const std::function<Vector()>&, std::size_t) {
+            doAddCreator("famg", [](const O& op, const P& prm, const std::function<void(Vector&)>&, std::size_t) {
                 auto crit = amgCriterion(prm);
                 Dune::Amg::Parameters parms;
                 parms.setNoPreSmoothSteps(1);
@@ -470,7 +525,7 @@ private:
             });
         }
         if constexpr (std::is_same_v<O, WellModelMatrixAdapter<M, V, V, false>>) {
-            doAddCreator("cprw", [](const O& op, const P& prm, const std::function<Vector()>& weightsCalculator, std::size_t pressureIndex) {
+            doAddCreator("cprw", [](const O& op, const P& prm, const std::function<void(Vector&)>& weightsCalculator, std::size_t pressureIndex) {
                 if (pressureIndex == std::numeric_limits<std::size_t>::max()) {
                     OPM_THROW(std::logic_error, "Pressure index out of bounds. It needs to specified for CPR");
                 }
@@ -479,7 +534,7 @@ private:
             });
             }
 
-        doAddCreator("cpr", [](const O& op, const P& prm, const std::function<Vector()>& weightsCalculator, std::size_t pressureIndex) {
+        doAddCreator("cpr", [](const O& op, const P& prm, const std::function<void(Vector&)>& weightsCalculator, std::size_t pressureIndex) {
                                 if (pressureIndex == std::numeric_limits<std::size_t>::max())
                                 {
                                     OPM_THROW(std::logic_error, "Pressure index out of bounds. It needs to specified for CPR");
@@ -487,7 +542,7 @@ private:
                                 using LevelTransferPolicy = Opm::PressureTransferPolicy<O, Dune::Amg::SequentialInformation, false>;
                                 return std::make_shared<OwningTwoLevelPreconditioner<O, V, LevelTransferPolicy>>(op, prm, weightsCalculator, pressureIndex);
         });
-        doAddCreator("cprt", [](const O& op, const P& prm, const std::function<Vector()>& weightsCalculator, std::size_t pressureIndex) {
+        doAddCreator("cprt", [](const O& op, const P& prm, const std::function<void(Vector&)>& weightsCalculator, std::size_t pressureIndex) {
                                 if (pressureIndex == std::numeric_limits<std::size_t>::max())
                                 {
                                     OPM_THROW(std::logic_error, "Pressure index out of bounds. It needs to specified for CPR");
@@ -515,7 +570,7 @@ private:
 
     // Actually creates the product object.
     PrecPtr doCreate(const Operator& op, const PropertyTree& prm,
-                     const std::function<Vector()> weightsCalculator,
+                     const std::function<void(Vector&)> weightsCalculator,
                      std::size_t pressureIndex)
     {
         const std::string& type = prm.get<std::string>("type", "ParOverILU0");
@@ -533,7 +588,7 @@ private:
     }
 
     PrecPtr doCreate(const Operator& op, const PropertyTree& prm,
-                     const std::function<Vector()> weightsCalculator,
+                     const std::function<void(Vector&)> weightsCalculator,
                      std::size_t pressureIndex, const Comm& comm)
     {
         const std::string& type = prm.get<std::string>("type", "ParOverILU0");
@@ -0,0 +1,90 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/simulators/linalg/PreconditionerReusePolicy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+namespace
+{
+    // Growth of the iterations over the baseline that triggers a numeric
+    // update, and a rebuild. Small iteration counts are not compared, as
+    // they vary by a few iterations anyway.
+    constexpr double updateIterationGrowth = 1.5;
+    constexpr double rebuildIterationGrowth = 3.0;
+    constexpr int minBaselineIterations = 5;
+} // anonymous namespace
+
+PreconditionerReusePolicy::PreconditionerReusePolicy(const double updateTolerance,
+                                                     const double rebuildTolerance)
+    : updateTolerance_(updateTolerance)
+    , rebuildTolerance_(rebuildTolerance)
+{
+}
+
+PreconditionerReusePolicy::Action
+PreconditionerReusePolicy::choose(const double changeSinceRebuild,
+                                  const double changeSinceUpdate,
+                                  const bool restart)
+{
+    const double baseline = std::max(baselineIterations_, minBaselineIterations);
+    const bool known = baselineIterations_ >= 0;
+    Action action = Action::Reuse;
+    if (restart || !lastConverged_
+        || changeSinceRebuild > rebuildTolerance_
+        || (known && lastIterations_ > rebuildIterationGrowth * baseline)) {
+        action = Action::Rebuild;
+    } else if (known && lastIterations_ > updateIterationGrowth * baseline) {
+        // Rebuild if the last numeric update did not bring the iterations down.
+        action = lastAction_ == Action::Update ? Action::Rebuild : Action::Update;
+    } else if (changeSinceUpdate > updateTolerance_) {
+        action = Action::Update;
+    }
+
+    if (action == Action::Rebuild) {
+        baselineIterations_ = -1;
+    }
+    lastAction_ = action;
+    ++counts_[static_cast<int>(action)];
+    return action;
+}
+
+void PreconditionerReusePolicy::record(const int iterations, const bool converged)
+{
+    lastIterations_ = iterations;
+    lastConverged_ = converged;
+    if (baselineIterations_ < 0 && converged) {
+        baselineIterations_ = iterations;
+    }
+}
+
+double PreconditionerReusePolicy::relativeChange(const double difference, const double reference)
+{
+    if (reference > 0.0) {
+        return std::sqrt(difference / reference);
+    }
+    return difference > 0.0 ? 1.0 : 0.0;
+}
+
+} // namespace Opm
@@ -0,0 +1,152 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PRECONDITIONERREUSEPOLICY_HEADER_INCLUDED
+#define OPM_PRECONDITIONERREUSEPOLICY_HEADER_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Decide from the changes of the linear system whether to reuse the preconditioner.
+///
+/// Before every solve, the caller passes samples of the system, e.g.
+/// every n-th diagonal block of the matrix and the response of the wells
+/// to a fixed vector. The largest relative change of the samples since
+/// the last full setup and since the last numeric update, together with
+/// the iterations of the last solve, gives one of three actions:
+///  - Rebuild the preconditioner, including the parts that depend on the
+///    sparsity and the strength of the couplings, such as AMG aggregates.
+///    Done after well events, failed solves, a large change of the system,
+///    or when the iterations grew strongly or a numeric update did not
+///    bring them down again.
+///  - Update it numerically, keeping the structure of the last setup,
+///    after a moderate change or growth of the iterations.
+///  - Reuse it as it is, while the system barely changes.
+/// The number of iterations of the first solve after a full setup is the
+/// baseline for the growth of the iterations.
+class PreconditionerReusePolicy
+{
+public:
+    enum class Action { Reuse, Update, Rebuild };
+
+    /// \param updateTolerance   Relative change of the sample since the
+    ///                          last update that triggers a numeric update.
+    /// \param rebuildTolerance  Relative change of the sample since the
+    ///                          last full setup that triggers a rebuild.
+    PreconditionerReusePolicy(double updateTolerance, double rebuildTolerance);
+
+    /// \brief Choose the action for the next solve.
+    ///
+    /// \param samples    The local samples of the system, each compared on its own.
+    ///                   A change of their layout forces a rebuild.
+    /// \param restart    True if the wells were opened, shut or otherwise changed.
+    /// \param comm       Collective communication, so that all processes choose alike.
+    template <class Comm>
+    Action decide(const std::vector<std::vector<double>>& samples, const bool restart, const Comm& comm)
+    {
+        // Squared norms of the differences and the references for every
+        // sample, and the restart flag last.
+        const std::size_t numSamples = samples.size();
+        std::vector<double> sums(4 * numSamples + 1, 0.0);
+        bool sameLayout = numSamples == rebuildSamples_.size();
+        for (std::size_t s = 0; sameLayout && s < numSamples; ++s) {
+            const auto& sample = samples[s];
+            const auto& rebuild = rebuildSamples_[s];
+            const auto& update = updateSamples_[s];
+            sameLayout = sample.size() == rebuild.size() && sample.size() == update.size();
+            for (std::size_t i = 0; sameLayout && i < sample.size(); ++i) {
+                sums[4 * s] += (sample[i] - rebuild[i]) * (sample[i] - rebuild[i]);
+                sums[4 * s + 1] += rebuild[i] * rebuild[i];
+                sums[4 * s + 2] += (sample[i] - update[i]) * (sample[i] - update[i]);
+                sums[4 * s + 3] += update[i] * update[i];
+            }
+        }
+        sums.back() = (restart || !sameLayout) ? 1.0 : 0.0;
+        comm.sum(sums.data(), sums.size());
+
+        double changeSinceRebuild = 0.0;
+        double changeSinceUpdate = 0.0;
+        for (std::size_t s = 0; s < numSamples; ++s) {
+            changeSinceRebuild = std::max(changeSinceRebuild, relativeChange(sums[4 * s], sums[4 * s + 1]));
+            changeSinceUpdate = std::max(changeSinceUpdate, relativeChange(sums[4 * s + 2], sums[4 * s + 3]));
+        }
+        const Action action = choose(changeSinceRebuild, changeSinceUpdate, sums.back() > 0.0);
+        if (action == Action::Rebuild) {
+            rebuildSamples_ = samples;
+        }
+        if (action != Action::Reuse) {
+            updateSamples_ = samples;
+        }
+        return action;
+    }
+
+    /// \brief Choose the action from the relative changes of the system.
+    /// \param restart  Force a rebuild, e.g. after a well event.
+    Action choose(double changeSinceRebuild, double changeSinceUpdate, bool restart);
+
+    /// \brief Record the outcome of the solve with the chosen action.
+    void record(int iterations, bool converged);
+
+    /// \brief Number of times every action was chosen, indexed by the action.
+    const std::array<int, 3>& counts() const
+    {
+        return counts_;
+    }
+
+    /// \brief Append the entries of every n-th diagonal block, for at most maxRows rows.
+    template <class Matrix>
+    static void sampleDiagonal(const Matrix& A, const std::size_t maxRows, std::vector<double>& sample)
+    {
+        const std::size_t stride = std::max<std::size_t>(1, A.N() / std::max<std::size_t>(maxRows, 1));
+        for (std::size_t row = 0; row < A.N(); row += stride) {
+            const auto diagonal = A[row].find(row);
+            if (diagonal == A[row].end()) {
+                continue;
+            }
+            for (const auto& blockRow : *diagonal) {
+                sample.insert(sample.end(), blockRow.begin(), blockRow.end());
+            }
+        }
+    }
+
+private:
+    static double relativeChange(double difference, double reference);
+
+    double updateTolerance_;
+    double rebuildTolerance_;
+
+    //! \brief The samples at the last full setup and at the last update.
+    std::vector<std::vector<double>> rebuildSamples_;
+    std::vector<std::vector<double>> updateSamples_;
+    Action lastAction_ = Action::Rebuild;
+    bool lastConverged_ = true;
+    int lastIterations_ = 0;
+    //! \brief Iterations of the first solve after the last full setup, -1 until known.
+    int baselineIterations_ = -1;
+    std::array<int, 3> counts_{};
+};
+
+} // namespace Opm
+
+#endif // OPM_PRECONDITIONERREUSEPOLICY_HEADER_INCLUDED
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <opm/simulators/linalg/PressureTransferKernels.hpp>
 #include <opm/simulators/linalg/twolevelmethodcpr.hh>
 #include <dune/istl/paamg/pinfo.hh>
 
@@ -155,6 +156,7 @@ namespace Opm
                 extendCommunicatorWithWells(*communication_, coarseLevelCommunication_, nw);
             }
         }
+        Details::checkPressurePattern(fineLevelMatrix, *coarseLevelMatrix_);
         calculateCoarseEntries(fineOperator);
 
         this->lhs_.resize(this->coarseLevelMatrix_->M());
@@ -172,79 +174,32 @@ namespace Opm
     virtual void calculateCoarseEntries(const FineOperator& fineOperator) override
     {
         const auto& fineMatrix = fineOperator.getmat();
-        *coarseLevelMatrix_ = 0;
-        auto rowCoarse = coarseLevelMatrix_->begin();
-        for (auto row = fineMatrix.begin(), rowEnd = fineMatrix.end(); row != rowEnd; ++row, ++rowCoarse) {
-            assert(row.index() == rowCoarse.index());
-            auto entryCoarse = rowCoarse->begin();
-            for (auto entry = row->begin(), entryEnd = row->end(); entry != entryEnd; ++entry, ++entryCoarse) {
-                assert(entry.index() == entryCoarse.index());
-                double matrix_el = 0;
-                if (transpose) {
-                    const auto& bw = weights_[entry.index()];
-                    for (size_t i = 0; i < bw.size(); ++i) {
-                        matrix_el += (*entry)[pressure_var_index_][i] * bw[i];
-                    }
-                } else {
-                    const auto& bw = weights_[row.index()];
-                    for (size_t i = 0; i < bw.size(); ++i) {
-                        matrix_el += (*entry)[i][pressure_var_index_] * bw[i];
-                    }
-                }
-                (*entryCoarse) = matrix_el;
-            }
-        }
+        Details::calculatePressureEntries<transpose>(fineMatrix, *coarseLevelMatrix_,
+                                                     weights_, pressure_var_index_);
         if (prm_.get<bool>("add_wells")) {
             assert(transpose == false); // not implemented
+            for (auto row = fineMatrix.N(); row < coarseLevelMatrix_->N(); ++row) {
+                (*coarseLevelMatrix_)[row] = 0;
+            }
             bool use_well_weights = prm_.get<bool>("use_well_weights");
             fineOperator.addWellPressureEquations(*coarseLevelMatrix_, weights_, use_well_weights);
-#ifndef NDEBUG
-            std::advance(rowCoarse, fineOperator.getNumberOfExtraEquations());
-            assert(rowCoarse == coarseLevelMatrix_->end());
-#endif
-
         }
     }
 
     virtual void moveToCoarseLevel(const typename ParentType::FineRangeType& fine) override
     {
         //NB we iterate over fine assumming welldofs is at the end
-        // Set coarse vector to zero
-        this->rhs_ = 0;
-
-        auto end = fine.end(), begin = fine.begin();
-
-        for (auto block = begin; block != end; ++block) {
-            const auto& bw = weights_[block.index()];
-            double rhs_el = 0.0;
-            if (transpose) {
-                rhs_el = (*block)[pressure_var_index_];
-            } else {
-                for (size_t i = 0; i < block->size(); ++i) {
-                    rhs_el += (*block)[i] * bw[i];
-                }
-            }
-            this->rhs_[block - begin] = rhs_el;
+        Details::restrictToPressure<transpose>(fine, this->rhs_, weights_, pressure_var_index_);
+        for (auto row = fine.size(); row < this->rhs_.size(); ++row) {
+            this->rhs_[row] = 0;
         }
-
         this->lhs_ = 0;
     }
 
     virtual void moveToFineLevel(typename ParentType::FineDomainType& fine) override
     {
         //NB we iterate over fine assumming welldofs is at the end
-        auto end = fine.end(), begin = fine.begin();
-
-        for (auto block = begin; block != end; ++block) {
-            if (transpose) {
-                const auto& bw = weights_[block.index()];
-                for (size_t i = 0; i < block->size(); ++i) {
-                    (*block)[i] = this->lhs_[block - begin] * bw[i];
-                }
-            } else {
-                (*block)[pressure_var_index_] = this->lhs_[block - begin];
-            }
-        }
+        Details::prolongateFromPressure<transpose>(this->lhs_, fine, weights_, pressure_var_index_);
     }
 
     virtual PressureBhpTransferPolicy* clone() const override
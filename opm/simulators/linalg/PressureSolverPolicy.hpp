@@ -65,7 +65,7 @@ namespace Amg
                 assert(op.category() == Dune::SolverCategory::overlapping);
                 // Assuming that we do not use Cpr as Pressure solver and use hard
                 // coded pressure index that might be wrong but should be unused.
-                linsolver_ = std::make_unique<Solver>(op, comm, prm, std::function<X()>(),
+                linsolver_ = std::make_unique<Solver>(op, comm, prm, std::function<void(X&)>(),
                                                       /* pressureIndex = */ 1);
             }
 #endif // HAVE_MPI
@@ -78,7 +78,7 @@ namespace Amg
                 assert(op.category() != Dune::SolverCategory::overlapping);
                 // Assuming that we do not use Cpr as Pressure solver and use hard
                 // coded pressure index that might be wrong but should be unused.
-                linsolver_ = std::make_unique<Solver>(op, prm, std::function<X()>(),
+                linsolver_ = std::make_unique<Solver>(op, prm, std::function<void(X&)>(),
                                                       /* pressureIndex = */ 1);
             }
 
@@ -0,0 +1,154 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PRESSURE_TRANSFER_KERNELS_HEADER_INCLUDED
+#define OPM_PRESSURE_TRANSFER_KERNELS_HEADER_INCLUDED
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace Opm
+{
+
+namespace Details
+{
+    /// \brief Check that every row of the coarse pressure matrix starts
+    /// with the sparsity pattern of the corresponding fine row.
+    ///
+    /// The coarse matrices of the pressure transfer policies are created
+    /// from the pattern of the fine matrix, possibly with additional
+    /// (well) columns at the end of a row. Hence the k-th block of a fine
+    /// row maps to the k-th entry of the coarse row, and the kernels below
+    /// can stream through the contiguous row storage of both matrices
+    /// without any index lookup. This is verified once, when the coarse
+    /// system is created.
+    template <class FineMatrix, class CoarseMatrix>
+    void checkPressurePattern(const FineMatrix& fine, const CoarseMatrix& coarse)
+    {
+        for (std::size_t row = 0; row < fine.N(); ++row) {
+            const auto& fineRow = fine[row];
+            const auto& coarseRow = coarse[row];
+            const auto* fineCols = fineRow.getindexptr();
+            const auto* coarseCols = coarseRow.getindexptr();
+            bool match = coarseRow.size() >= fineRow.size();
+            for (std::size_t k = 0; match && k < fineRow.size(); ++k) {
+                match = fineCols[k] == coarseCols[k];
+            }
+            if (!match) {
+                OPM_THROW(std::logic_error, "Coarse pressure matrix pattern does not extend the fine pattern in row " << row);
+            }
+        }
+    }
+
+    /// \brief Compute the entries of the coarse pressure matrix belonging
+    /// to the fine matrix: the weighted sum of the pressure column (or of
+    /// the pressure row if transpose is true) of every fine block. Any
+    /// trailing entries of the coarse rows are set to zero.
+    template <bool transpose, class FineMatrix, class CoarseMatrix, class Weights>
+    void calculatePressureEntries(const FineMatrix& fine, CoarseMatrix& coarse,
+                                  const Weights& weights, const std::size_t pressureIndex)
+    {
+        constexpr int N = FineMatrix::block_type::rows;
+        const std::ptrdiff_t numRows = fine.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            const auto& fineRow = fine[row];
+            auto& coarseRow = coarse[row];
+            const auto* fineBlocks = fineRow.getptr();
+            const auto* fineCols = fineRow.getindexptr();
+            auto* coarseBlocks = coarseRow.getptr();
+            const std::size_t size = fineRow.size();
+            for (std::size_t k = 0; k < size; ++k) {
+                const auto& block = fineBlocks[k];
+                double matrix_el = 0;
+                if constexpr (transpose) {
+                    const auto& bw = weights[fineCols[k]];
+                    for (int i = 0; i < N; ++i) {
+                        matrix_el += block[pressureIndex][i] * bw[i];
+                    }
+                } else {
+                    const auto& bw = weights[row];
+                    for (int i = 0; i < N; ++i) {
+                        matrix_el += block[i][pressureIndex] * bw[i];
+                    }
+                }
+                coarseBlocks[k] = matrix_el;
+            }
+            for (std::size_t k = size; k < coarseRow.size(); ++k) {
+                coarseBlocks[k] = 0;
+            }
+        }
+    }
+
+    /// \brief Restrict the fine residual to the pressure equation.
+    template <bool transpose, class FineVector, class CoarseVector, class Weights>
+    void restrictToPressure(const FineVector& fine, CoarseVector& coarse,
+                            const Weights& weights, const std::size_t pressureIndex)
+    {
+        constexpr int N = FineVector::block_type::dimension;
+        const std::ptrdiff_t size = fine.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < size; ++row) {
+            const auto& block = fine[row];
+            double rhs_el = 0.0;
+            if constexpr (transpose) {
+                rhs_el = block[pressureIndex];
+            } else {
+                const auto& bw = weights[row];
+                for (int i = 0; i < N; ++i) {
+                    rhs_el += block[i] * bw[i];
+                }
+            }
+            coarse[row] = rhs_el;
+        }
+    }
+
+    /// \brief Prolongate the pressure correction to the fine level.
+    template <bool transpose, class FineVector, class CoarseVector, class Weights>
+    void prolongateFromPressure(const CoarseVector& coarse, FineVector& fine,
+                                const Weights& weights, const std::size_t pressureIndex)
+    {
+        constexpr int N = FineVector::block_type::dimension;
+        const std::ptrdiff_t size = fine.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < size; ++row) {
+            auto& block = fine[row];
+            if constexpr (transpose) {
+                const auto& bw = weights[row];
+                for (int i = 0; i < N; ++i) {
+                    block[i] = coarse[row] * bw[i];
+                }
+            } else {
+                block[pressureIndex] = coarse[row];
+            }
+        }
+    }
+} // namespace Details
+
+} // namespace Opm
+
+#endif // OPM_PRESSURE_TRANSFER_KERNELS_HEADER_INCLUDED
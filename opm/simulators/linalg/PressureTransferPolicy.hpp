@@ -22,6 +22,7 @@
 #define OPM_PRESSURE_TRANSFER_POLICY_HEADER_INCLUDED
 
 
+#include <opm/simulators/linalg/PressureTransferKernels.hpp>
 #include <opm/simulators/linalg/twolevelmethodcpr.hh>
 #include <opm/simulators/linalg/PropertyTree.hpp>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -81,6 +82,7 @@ public:
             ++createIter;
         }
 
+        Details::checkPressurePattern(fineLevelMatrix, *coarseLevelMatrix_);
         calculateCoarseEntries(fineOperator);
         coarseLevelCommunication_.reset(communication_, [](Communication*) {});
 
@@ -98,69 +100,19 @@ public:
 
     virtual void calculateCoarseEntries(const FineOperator& fineOperator) override
     {
-        const auto& fineMatrix = fineOperator.getmat();
-        *coarseLevelMatrix_ = 0;
-        auto rowCoarse = coarseLevelMatrix_->begin();
-        for (auto row = fineMatrix.begin(), rowEnd = fineMatrix.end(); row != rowEnd; ++row, ++rowCoarse) {
-            assert(row.index() == rowCoarse.index());
-            auto entryCoarse = rowCoarse->begin();
-            for (auto entry = row->begin(), entryEnd = row->end(); entry != entryEnd; ++entry, ++entryCoarse) {
-                assert(entry.index() == entryCoarse.index());
-                double matrix_el = 0;
-                if (transpose) {
-                    const auto& bw = weights_[entry.index()];
-                    for (size_t i = 0; i < bw.size(); ++i) {
-                        matrix_el += (*entry)[pressure_var_index_][i] * bw[i];
-                    }
-                } else {
-                    const auto& bw = weights_[row.index()];
-                    for (size_t i = 0; i < bw.size(); ++i) {
-                        matrix_el += (*entry)[i][pressure_var_index_] * bw[i];
-                    }
-                }
-                (*entryCoarse) = matrix_el;
-            }
-        }
-        assert(rowCoarse == coarseLevelMatrix_->end());
+        Details::calculatePressureEntries<transpose>(fineOperator.getmat(), *coarseLevelMatrix_,
+                                                     weights_, pressure_var_index_);
     }
 
     virtual void moveToCoarseLevel(const typename ParentType::FineRangeType& fine) override
     {
-        // Set coarse vector to zero
-        this->rhs_ = 0;
-
-        auto end = fine.end(), begin = fine.begin();
-
-        for (auto block = begin; block != end; ++block) {
-            const auto& bw = weights_[block.index()];
-            double rhs_el = 0.0;
-            if (transpose) {
-                rhs_el = (*block)[pressure_var_index_];
-            } else {
-                for (size_t i = 0; i < block->size(); ++i) {
-                    rhs_el += (*block)[i] * bw[i];
-                }
-            }
-            this->rhs_[block - begin] = rhs_el;
-        }
-
+        Details::restrictToPressure<transpose>(fine, this->rhs_, weights_, pressure_var_index_);
         this->lhs_ = 0;
     }
 
     virtual void moveToFineLevel(typename ParentType::FineDomainType& fine) override
     {
-        auto end = fine.end(), begin = fine.begin();
-
-        for (auto block = begin; block != end; ++block) {
-            if (transpose) {
-                const auto& bw = weights_[block.index()];
-                for (size_t i = 0; i < block->size(); ++i) {
-                    (*block)[i] = this->lhs_[block - begin] * bw[i];
-                }
-            } else {
-                (*block)[pressure_var_index_] = this->lhs_[block - begin];
-            }
-        }
+        Details::prolongateFromPressure<transpose>(this->lhs_, fine, weights_, pressure_var_index_);
     }
 
     virtual PressureTransferPolicy* clone() const override
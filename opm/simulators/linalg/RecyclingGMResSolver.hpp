@@ -0,0 +1,341 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_RECYCLING_GMRES_SOLVER_HEADER_INCLUDED
+#define OPM_RECYCLING_GMRES_SOLVER_HEADER_INCLUDED
+
+#include <dune/common/timer.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/scalarproducts.hh>
+#include <dune/istl/solver.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace Dune
+{
+
+/// \brief Subspace that is recycled between linear solves.
+///
+/// Holds the search directions u_i in terms of the unknowns. The images
+/// c_i = A u_i depend on the matrix and are recomputed by the solver at
+/// the start of every solve. The space may be shared by several solvers
+/// in turn, so that it survives when a solver is recreated.
+template <class X>
+struct RecycleSpace
+{
+    std::deque<X> directions;
+};
+
+
+/// \brief Restarted flexible GMRES with a recycled subspace.
+///
+/// GCRO-type method (de Sturler) that solves Ax = b while keeping the
+/// residual orthogonal to the images C = AU of a small subspace U, which is
+/// kept between solves:
+///  - At the start of a solve C = AU is recomputed for the current matrix
+///    and orthonormalised, and the part of the residual in range(C) is
+///    eliminated exactly by x += U C^T r.
+///  - GMRES is then run on the projected operator (I - CC^T) A M^-1, and
+///    the solution update is corrected for the projection.
+///  - After every cycle its update d, and its image Ad which is available
+///    from the Arnoldi relation, are added to the subspace, and the oldest
+///    direction is dropped once the capacity is exceeded.
+/// Hence the subspace captures the slowly converging error components of
+/// the previous solves. For a sequence of slowly varying matrices, such as
+/// the Jacobians of successive Newton iterations, this reduces the number
+/// of iterations. The preconditioned Arnoldi vectors are stored, so the
+/// preconditioner may vary between iterations (e.g. CPR with an
+/// iterative coarse solver).
+template <class X>
+class RecyclingGMResSolver : public InverseOperator<X, X>
+{
+public:
+    using field_type = typename X::field_type;
+
+    RecyclingGMResSolver(LinearOperator<X, X>& op,
+                         ScalarProduct<X>& sp,
+                         Preconditioner<X, X>& prec,
+                         const double reduction,
+                         const int restart,
+                         const int recycle,
+                         const int maxit,
+                         const int verbose)
+        : op_(op)
+        , sp_(sp)
+        , prec_(prec)
+        , space_(std::make_shared<RecycleSpace<X>>())
+        , reduction_(reduction)
+        , restart_(std::max(restart, 1))
+        , recycle_(std::max(recycle, 0))
+        , maxit_(maxit)
+        , verbose_(verbose)
+    {
+    }
+
+    /// \brief Use the given recycled subspace, e.g. one kept from an earlier solver.
+    void setRecycleSpace(const std::shared_ptr<RecycleSpace<X>>& space)
+    {
+        space_ = space;
+    }
+
+    virtual void apply(X& x, X& b, InverseOperatorResult& res) override
+    {
+        apply(x, b, reduction_, res);
+    }
+
+    virtual void apply(X& x, X& b, double reduction, InverseOperatorResult& res) override
+    {
+        res.clear();
+        Timer watch;
+        const int m = restart_;
+        std::vector<X> v(m + 1, x);     // orthonormal basis
+        std::vector<X> z(m, x);         // z[j] = M^-1 v[j]
+        X w(x);
+        std::vector<std::vector<field_type>> H(m + 1, std::vector<field_type>(m, 0.0));
+        std::vector<std::vector<field_type>> Harnoldi(H);
+        std::vector<std::vector<field_type>> B;  // B[i][j] = (c_i, A z[j])
+        std::vector<field_type> g(m + 1, 0.0), cs(m, 0.0), sn(m, 0.0);
+
+        X& r = b;
+        op_.applyscaleadd(-1.0, x, r);
+        const field_type def0 = sp_.norm(r);
+        field_type def = def0;
+        if (verbose_ > 0) {
+            std::cout << "=== RecyclingGMResSolver" << std::endl;
+            if (verbose_ > 1) {
+                std::cout << std::setw(5) << "Iter" << std::setw(16) << "Defect" << std::endl;
+                std::cout << std::setw(5) << 0 << std::setw(16) << def0 << std::endl;
+            }
+        }
+
+        prec_.pre(x, b);
+        setupRecycleSpace(x);
+
+        int it = 0;
+        bool converged = def0 < 1e-30;
+        while (!converged && it < maxit_) {
+            // Remove the part of the residual in range(C).
+            for (std::size_t i = 0; i < c_.size(); ++i) {
+                const field_type alpha = sp_.dot(c_[i], r);
+                x.axpy(alpha, space_->directions[i]);
+                r.axpy(-alpha, c_[i]);
+            }
+            def = sp_.norm(r);
+            if (def < def0 * reduction || def < 1e-30) {
+                converged = true;
+                break;
+            }
+
+            // Arnoldi process for the projected operator.
+            B.assign(c_.size(), std::vector<field_type>(m, 0.0));
+            v[0] = r;
+            v[0] *= 1.0 / def;
+            g.assign(m + 1, 0.0);
+            g[0] = def;
+            int k = 0;
+            for (int j = 0; j < m && it < maxit_; ++j) {
+                z[j] = 0.0;
+                prec_.apply(z[j], v[j]);
+                op_.apply(z[j], w);
+                for (std::size_t i = 0; i < c_.size(); ++i) {
+                    B[i][j] = sp_.dot(c_[i], w);
+                    w.axpy(-B[i][j], c_[i]);
+                }
+                for (int i = 0; i <= j; ++i) {
+                    H[i][j] = sp_.dot(v[i], w);
+                    w.axpy(-H[i][j], v[i]);
+                }
+                H[j + 1][j] = sp_.norm(w);
+                for (int i = 0; i <= j + 1; ++i) {
+                    Harnoldi[i][j] = H[i][j];
+                }
+                if (H[j + 1][j] != 0.0) {
+                    v[j + 1] = w;
+                    v[j + 1] *= 1.0 / H[j + 1][j];
+                }
+                applyGivens(H, g, cs, sn, j);
+                k = j + 1;
+                ++it;
+                def = std::abs(g[j + 1]);
+                if (verbose_ > 1) {
+                    std::cout << std::setw(5) << it << std::setw(16) << def << std::endl;
+                }
+                if (def < def0 * reduction || def < 1e-30 || Harnoldi[j + 1][j] == 0.0) {
+                    converged = def < def0 * reduction || def < 1e-30;
+                    break;
+                }
+            }
+
+            // y solves the least squares problem, the update is
+            // d = Z y - U B y with the image Ad = V Harnoldi y.
+            std::vector<field_type> y(k, 0.0);
+            for (int i = k - 1; i >= 0; --i) {
+                field_type sum = g[i];
+                for (int j = i + 1; j < k; ++j) {
+                    sum -= H[i][j] * y[j];
+                }
+                y[i] = sum / H[i][i];
+            }
+            X d(x);
+            d = 0.0;
+            for (int j = 0; j < k; ++j) {
+                d.axpy(y[j], z[j]);
+            }
+            for (std::size_t i = 0; i < c_.size(); ++i) {
+                field_type by = 0.0;
+                for (int j = 0; j < k; ++j) {
+                    by += B[i][j] * y[j];
+                }
+                d.axpy(-by, space_->directions[i]);
+            }
+            w = 0.0;
+            for (int i = 0; i <= k; ++i) {
+                field_type hy = 0.0;
+                for (int j = std::max(i - 1, 0); j < k; ++j) {
+                    hy += Harnoldi[i][j] * y[j];
+                }
+                if (hy != 0.0) {
+                    w.axpy(hy, v[i]);
+                }
+            }
+            x += d;
+            r -= w;
+            addDirection(d, w);
+        }
+
+        prec_.post(x);
+        res.iterations = it;
+        res.reduction = def0 > 0.0 ? def / def0 : 0.0;
+        res.converged = converged;
+        res.conv_rate = it > 0 ? std::pow(res.reduction, 1.0 / it) : 0.0;
+        res.elapsed = watch.elapsed();
+        if (verbose_ > 0) {
+            std::cout << "=== rate=" << res.conv_rate << ", T=" << res.elapsed
+                      << ", TIT=" << (it > 0 ? res.elapsed / it : 0.0) << ", IT=" << it
+                      << ", recycled=" << space_->directions.size() << std::endl;
+        }
+    }
+
+    virtual SolverCategory::Category category() const override
+    {
+        return op_.category();
+    }
+
+private:
+    /// \brief Compute C = AU for the current matrix and orthonormalise it,
+    /// transforming U accordingly. Directions that have become linearly
+    /// dependent are dropped.
+    void setupRecycleSpace(const X& x)
+    {
+        auto& directions = space_->directions;
+        if (!directions.empty() && directions.front().size() != x.size()) {
+            directions.clear();
+        }
+        c_.clear();
+        for (auto u = directions.begin(); u != directions.end(); ) {
+            X c(x);
+            op_.apply(*u, c);
+            if (orthonormalise(*u, c)) {
+                c_.push_back(c);
+                ++u;
+            } else {
+                u = directions.erase(u);
+            }
+        }
+    }
+
+    /// \brief Add the pair (d, c = Ad) to the subspace.
+    void addDirection(X& d, X& c)
+    {
+        if (recycle_ == 0 || !orthonormalise(d, c)) {
+            return;
+        }
+        auto& directions = space_->directions;
+        if (static_cast<int>(directions.size()) == recycle_) {
+            directions.pop_front();
+            c_.erase(c_.begin());
+        }
+        directions.push_back(d);
+        c_.push_back(c);
+    }
+
+    /// \brief Orthonormalise c against C by modified Gram-Schmidt, applying
+    /// the same transformation to u. Returns false if c is (numerically)
+    /// in range(C).
+    bool orthonormalise(X& u, X& c) const
+    {
+        const field_type norm0 = sp_.norm(c);
+        for (std::size_t i = 0; i < c_.size(); ++i) {
+            const field_type alpha = sp_.dot(c_[i], c);
+            c.axpy(-alpha, c_[i]);
+            u.axpy(-alpha, space_->directions[i]);
+        }
+        const field_type norm = sp_.norm(c);
+        if (!(norm > 1e-10 * norm0) || norm0 == 0.0) {
+            return false;
+        }
+        c *= 1.0 / norm;
+        u *= 1.0 / norm;
+        return true;
+    }
+
+    /// \brief Apply the previous rotations to column col of H, then the new one to H and g.
+    static void applyGivens(std::vector<std::vector<field_type>>& H, std::vector<field_type>& g,
+                            std::vector<field_type>& cs, std::vector<field_type>& sn, const int col)
+    {
+        for (int j = 0; j < col; ++j) {
+            const field_type temp = cs[j] * H[j][col] + sn[j] * H[j + 1][col];
+            H[j + 1][col] = -sn[j] * H[j][col] + cs[j] * H[j + 1][col];
+            H[j][col] = temp;
+        }
+        const field_type a = H[col][col];
+        const field_type b = H[col + 1][col];
+        const field_type r = std::hypot(a, b);
+        cs[col] = r > 0.0 ? a / r : 1.0;
+        sn[col] = r > 0.0 ? b / r : 0.0;
+        H[col][col] = r;
+        H[col + 1][col] = 0.0;
+        g[col + 1] = -sn[col] * g[col];
+        g[col] = cs[col] * g[col];
+    }
+
+    LinearOperator<X, X>& op_;
+    ScalarProduct<X>& sp_;
+    Preconditioner<X, X>& prec_;
+    std::shared_ptr<RecycleSpace<X>> space_;
+    //! \brief The images A u_i of the recycled directions for the current matrix.
+    std::vector<X> c_;
+    double reduction_;
+    int restart_;
+    int recycle_;
+    int maxit_;
+    int verbose_;
+};
+
+} // namespace Dune
+
+#endif // OPM_RECYCLING_GMRES_SOLVER_HEADER_INCLUDED
@@ -0,0 +1,312 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_REORDERED_LINEAR_SYSTEM_HEADER_INCLUDED
+#define OPM_REORDERED_LINEAR_SYSTEM_HEADER_INCLUDED
+
+#include <opm/simulators/linalg/WellOperators.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+
+namespace Details
+{
+    /// \brief Reverse Cuthill-McKee ordering of the first numReordered rows of A.
+    ///
+    /// Only the connections among the first numReordered rows are taken
+    /// into account, and the remaining rows keep their position. Every
+    /// connected component is started from a pseudo-peripheral row, found
+    /// by a breadth-first search from a row of minimum degree.
+    ///
+    /// \return The permutation, the row with index i is moved to perm[i].
+    template <class Matrix>
+    std::vector<std::size_t> reverseCuthillMcKee(const Matrix& A, const std::size_t numReordered)
+    {
+        const std::size_t n = numReordered;
+        std::vector<std::size_t> degree(n, 0);
+        for (std::size_t row = 0; row < n; ++row) {
+            for (auto col = A[row].begin(); col != A[row].end(); ++col) {
+                if (col.index() < n && col.index() != row) {
+                    ++degree[row];
+                }
+            }
+        }
+
+        std::vector<std::size_t> order;
+        order.reserve(n);
+        std::vector<bool> visited(n, false);
+        std::vector<std::size_t> neighbours;
+
+        // Breadth-first search from root, visiting the neighbours in order
+        // of increasing degree. Appends the visited rows to order and
+        // returns the index in order of the first row of the last level.
+        const auto bfs = [&](const std::size_t root) {
+            std::size_t levelStart = order.size();
+            std::size_t lastLevelStart = levelStart;
+            order.push_back(root);
+            visited[root] = true;
+            std::size_t levelEnd = order.size();
+            while (levelStart < levelEnd) {
+                lastLevelStart = levelStart;
+                for (std::size_t k = levelStart; k < levelEnd; ++k) {
+                    const std::size_t row = order[k];
+                    neighbours.clear();
+                    for (auto col = A[row].begin(); col != A[row].end(); ++col) {
+                        if (col.index() < n && !visited[col.index()]) {
+                            visited[col.index()] = true;
+                            neighbours.push_back(col.index());
+                        }
+                    }
+                    std::sort(neighbours.begin(), neighbours.end(),
+                              [&degree](const std::size_t a, const std::size_t b) {
+                                  return degree[a] < degree[b] || (degree[a] == degree[b] && a < b);
+                              });
+                    order.insert(order.end(), neighbours.begin(), neighbours.end());
+                }
+                levelStart = levelEnd;
+                levelEnd = order.size();
+            }
+            return lastLevelStart;
+        };
+
+        const auto restart = [&](const std::size_t componentStart) {
+            for (std::size_t k = componentStart; k < order.size(); ++k) {
+                visited[order[k]] = false;
+            }
+            order.resize(componentStart);
+        };
+
+        for (std::size_t start = 0; start < n; ++start) {
+            if (visited[start]) {
+                continue;
+            }
+            // Find the row of minimum degree in this component.
+            const std::size_t componentStart = order.size();
+            bfs(start);
+            std::size_t root = start;
+            for (std::size_t k = componentStart; k < order.size(); ++k) {
+                if (degree[order[k]] < degree[root]) {
+                    root = order[k];
+                }
+            }
+            restart(componentStart);
+
+            // Start from the row of minimum degree in the last level of a
+            // search from that row.
+            const std::size_t lastLevel = bfs(root);
+            std::size_t peripheral = order[lastLevel];
+            for (std::size_t k = lastLevel; k < order.size(); ++k) {
+                if (degree[order[k]] < degree[peripheral]) {
+                    peripheral = order[k];
+                }
+            }
+            restart(componentStart);
+            bfs(peripheral);
+        }
+
+        std::vector<std::size_t> perm(A.N());
+        for (std::size_t k = 0; k < n; ++k) {
+            perm[order[k]] = n - 1 - k;
+        }
+        for (std::size_t row = n; row < A.N(); ++row) {
+            perm[row] = row;
+        }
+        return perm;
+    }
+} // namespace Details
+
+
+/// \brief Copy of a linear system in a bandwidth-reducing row order.
+///
+/// The permutation (reverse Cuthill-McKee) and the sparsity pattern of the
+/// reordered matrix are computed once at construction, later updates of
+/// the matrix entries only stream the blocks into the new positions. Rows
+/// beyond numReordered (e.g. the overlap rows in a parallel run) keep
+/// their position, so the split into interior and overlap rows is
+/// preserved.
+template <class Matrix, class Vector>
+class ReorderedLinearSystem
+{
+public:
+    ReorderedLinearSystem(const Matrix& A, const std::size_t numReordered)
+        : perm_(Details::reverseCuthillMcKee(A, numReordered))
+        , inverse_(perm_.size())
+        , matrix_(A.N(), A.M(), A.nonzeroes(), Matrix::row_wise)
+    {
+        for (std::size_t row = 0; row < perm_.size(); ++row) {
+            inverse_[perm_[row]] = row;
+        }
+        for (auto row = matrix_.createbegin(); row != matrix_.createend(); ++row) {
+            const auto& source = A[inverse_[row.index()]];
+            for (auto col = source.begin(); col != source.end(); ++col) {
+                row.insert(perm_[col.index()]);
+            }
+        }
+
+        // Position in the source row of every block of the reordered matrix.
+        rowStart_.assign(A.N() + 1, 0);
+        source_.resize(A.nonzeroes());
+        for (std::size_t row = 0; row < A.N(); ++row) {
+            const auto& sourceRow = A[inverse_[row]];
+            const auto& targetRow = matrix_[row];
+            rowStart_[row + 1] = rowStart_[row] + targetRow.size();
+            const auto* targetCols = targetRow.getindexptr();
+            const auto* sourceCols = sourceRow.getindexptr();
+            for (std::size_t k = 0; k < sourceRow.size(); ++k) {
+                const auto pos = std::lower_bound(targetCols, targetCols + targetRow.size(), perm_[sourceCols[k]]) - targetCols;
+                source_[rowStart_[row] + pos] = k;
+            }
+        }
+        updateMatrix(A);
+    }
+
+    /// \brief The permutation, row i of the original system is row perm[i] of the reordered one.
+    const std::vector<std::size_t>& permutation() const
+    {
+        return perm_;
+    }
+
+    /// \brief The reordered matrix.
+    Matrix& matrix()
+    {
+        return matrix_;
+    }
+
+    /// \brief Copy the entries of A, which must have the pattern given at construction.
+    void updateMatrix(const Matrix& A)
+    {
+        if (A.N() != matrix_.N() || A.nonzeroes() != matrix_.nonzeroes()) {
+            OPM_THROW(std::logic_error, "The sparsity pattern of the reordered system has changed.");
+        }
+        const std::ptrdiff_t numRows = matrix_.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            const auto* source = A[inverse_[row]].getptr();
+            auto* target = matrix_[row].getptr();
+            const std::size_t begin = rowStart_[row];
+            const std::size_t size = rowStart_[row + 1] - begin;
+            for (std::size_t k = 0; k < size; ++k) {
+                target[k] = source[source_[begin + k]];
+            }
+        }
+    }
+
+    /// \brief out = P in, from the original to the new order.
+    void toReordered(const Vector& in, Vector& out) const
+    {
+        out.resize(in.size());
+        for (std::size_t row = 0; row < in.size(); ++row) {
+            out[perm_[row]] = in[row];
+        }
+    }
+
+    /// \brief out = P^T in, from the new to the original order.
+    void fromReordered(const Vector& in, Vector& out) const
+    {
+        out.resize(in.size());
+        for (std::size_t row = 0; row < in.size(); ++row) {
+            out[row] = in[perm_[row]];
+        }
+    }
+
+private:
+    std::vector<std::size_t> perm_;
+    std::vector<std::size_t> inverse_;
+    Matrix matrix_;
+    std::vector<std::size_t> rowStart_;
+    std::vector<std::size_t> source_;
+};
+
+
+/// \brief Well operator acting on reordered vectors.
+///
+/// Wraps a well operator that works in the original cell order, so it can
+/// be combined with a reordered matrix. The well contributions to the
+/// pressure equation of CPR can not be reordered and are not supported.
+template <class Matrix, class X, class Y>
+class ReorderedWellOperator : public LinearOperatorExtra<X, Y>
+{
+public:
+    using Base = LinearOperatorExtra<X, Y>;
+    using field_type = typename Base::field_type;
+    using PressureMatrix = typename Base::PressureMatrix;
+
+    ReorderedWellOperator(const LinearOperatorExtra<X, Y>& wellOper,
+                          const ReorderedLinearSystem<Matrix, X>& system)
+        : wellOper_(wellOper)
+        , system_(system)
+    {
+    }
+
+    void apply(const X& x, Y& y) const override
+    {
+        system_.fromReordered(x, x_);
+        system_.fromReordered(y, y_);
+        wellOper_.apply(x_, y_);
+        system_.toReordered(y_, y);
+    }
+
+    void applyscaleadd(field_type alpha, const X& x, Y& y) const override
+    {
+        system_.fromReordered(x, x_);
+        system_.fromReordered(y, y_);
+        wellOper_.applyscaleadd(alpha, x_, y_);
+        system_.toReordered(y_, y);
+    }
+
+    Dune::SolverCategory::Category category() const override
+    {
+        return wellOper_.category();
+    }
+
+    void addWellPressureEquations(PressureMatrix&, const X&, const bool) const override
+    {
+        OPM_THROW(std::logic_error, "Well pressure equations are not supported for a reordered linear system.");
+    }
+
+    void addWellPressureEquationsStruct(PressureMatrix&) const override
+    {
+        OPM_THROW(std::logic_error, "Well pressure equations are not supported for a reordered linear system.");
+    }
+
+    int getNumberOfExtraEquations() const override
+    {
+        return wellOper_.getNumberOfExtraEquations();
+    }
+
+private:
+    const LinearOperatorExtra<X, Y>& wellOper_;
+    const ReorderedLinearSystem<Matrix, X>& system_;
+    mutable X x_;
+    mutable Y y_;
+};
+
+} // namespace Opm
+
+#endif // OPM_REORDERED_LINEAR_SYSTEM_HEADER_INCLUDED
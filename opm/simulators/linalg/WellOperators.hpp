@@ -22,6 +22,8 @@
 #ifndef OPM_WELLOPERATORS_HEADER_INCLUDED
 #define OPM_WELLOPERATORS_HEADER_INCLUDED
 
+#include <opm/simulators/linalg/BlockSpMV.hpp>
+
 #include <dune/istl/operators.hh>
 
 namespace Opm
@@ -148,7 +150,7 @@ public:
 
   virtual void apply( const X& x, Y& y ) const override
   {
-    A_.mv( x, y );
+    Opm::blockSpMV( A_, x, y, A_.N() );
 
     // add well model modification to y
     wellOper_.apply(x, y );
@@ -162,7 +164,7 @@ public:
   // y += \alpha * A * x
   virtual void applyscaleadd (field_type alpha, const X& x, Y& y) const override
   {
-    A_.usmv(alpha,x,y);
+    Opm::blockSpMVScaleAdd( alpha, A_, x, y, A_.N() );
 
     // add scaled well model modification to y
     wellOper_.applyscaleadd( alpha, x, y );
@@ -175,6 +177,9 @@ public:
 
   virtual const matrix_type& getmat() const override { return A_; }
 
+  //! the operator of the wells, without the matrix
+  const Opm::LinearOperatorExtra<X, Y>& wellOperator() const { return wellOper_; }
+
     void addWellPressureEquations(PressureMatrix& jacobian, const X& weights,const bool use_well_weights) const
     {
         wellOper_.addWellPressureEquations(jacobian, weights, use_well_weights);
@@ -234,13 +239,7 @@ public:
 
     virtual void apply( const X& x, Y& y ) const override
     {
-        for (auto row = A_.begin(); row.index() < interiorSize_; ++row)
-        {
-            y[row.index()]=0;
-            auto endc = (*row).end();
-            for (auto col = (*row).begin(); col != endc; ++col)
-                (*col).umv(x[col.index()], y[row.index()]);
-        }
+        Opm::blockSpMV( A_, x, y, interiorSize_ );
 
         // add well model modification to y
         wellOper_.apply(x, y );
@@ -251,12 +250,7 @@ public:
     // y += \alpha * A * x
     virtual void applyscaleadd (field_type alpha, const X& x, Y& y) const override
     {
-        for (auto row = A_.begin(); row.index() < interiorSize_; ++row)
-        {
-            auto endc = (*row).end();
-            for (auto col = (*row).begin(); col != endc; ++col)
-                (*col).usmv(alpha, x[col.index()], y[row.index()]);
-        }
+        Opm::blockSpMVScaleAdd( alpha, A_, x, y, interiorSize_ );
         // add scaled well model modification to y
         wellOper_.applyscaleadd( alpha, x, y );
 
@@ -265,6 +259,12 @@ public:
 
     virtual const matrix_type& getmat() const override { return A_; }
 
+    //! the operator of the wells, without the matrix
+    const Opm::LinearOperatorExtra<X, Y>& wellOperator() const { return wellOper_; }
+
+    //! the number of interior rows, the ghost rows follow them
+    size_t interiorSize() const { return interiorSize_; }
+
     void addWellPressureEquations(PressureMatrix& jacobian, const X& weights,const bool use_well_weights) const
     {
         wellOper_.addWellPressureEquations(jacobian, weights, use_well_weights);
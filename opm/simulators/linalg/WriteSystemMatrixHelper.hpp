@@ -21,20 +21,28 @@
 #define OPM_WRITESYSTEMMATRIXHELPER_HEADER_INCLUDED
 
 #include <dune/istl/matrixmarket.hh>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/simulators/linalg/BinarySystemFile.hpp>
 #include <opm/simulators/linalg/MatrixMarketSpecializations.hpp>
 
+#include <cstddef>
 #include <filesystem>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 
 namespace Opm
 {
 namespace Helper
 {
-    template <class SimulatorType, class MatrixType, class VectorType, class Communicator>
-    void writeSystem(const SimulatorType& simulator,
-                     const MatrixType& matrix,
-                     const VectorType& rhs,
-                     [[maybe_unused]] const Communicator* comm)
+    /// \brief Common prefix of the files written for the current linear system.
+    template <class SimulatorType>
+    std::string systemFilePrefix(const SimulatorType& simulator)
     {
         std::string dir = simulator.problem().outputDir();
         if (dir == ".") {
@@ -57,28 +65,96 @@ namespace Helper
         oss << "_nit_" << nit << "_";
         std::string output_file(oss.str());
         fs::path full_path = output_dir / output_file;
-        std::string prefix = full_path.string();
-        {
-            std::string filename = prefix + "matrix_istl";
+        return full_path.string();
+    }
+
+    /// \brief Write a matrix or vector in matrix market format, one file
+    /// per process together with its index set in parallel runs.
+    template <class ObjectType, class Communicator>
+    void writeMatrixMarket(const ObjectType& object,
+                           const std::string& filename,
+                           [[maybe_unused]] const Communicator* comm)
+    {
 #if HAVE_MPI
-            if (comm != nullptr) { // comm is not set in serial runs
-                Dune::storeMatrixMarket(matrix, filename, *comm, true);
-            } else
+        if (comm != nullptr) { // comm is not set in serial runs
+            Dune::storeMatrixMarket(object, filename, *comm, true);
+        } else
 #endif
-            {
-                Dune::storeMatrixMarket(matrix, filename + ".mm");
+        {
+            Dune::storeMatrixMarket(object, filename + ".mm");
+        }
+    }
+
+    /// \brief Assemble the well contributions -C D^-1 B of the local wells
+    /// into a separate matrix with the rows of the system matrix.
+    ///
+    /// Every well adds its blocks from its own B, C and D^-1, exactly as when
+    /// the contributions are added to the system matrix, so no process waits
+    /// for the others. The pattern couples the perforated cells of each well.
+    template <class WellModel, class SparseMatrixAdapter>
+    void assembleWellMatrix(const WellModel& wellModel,
+                            const std::size_t numRows,
+                            SparseMatrixAdapter& wells)
+    {
+        std::vector<std::set<unsigned>> neighbors(numRows);
+        for (const auto& well : wellModel.localNonshutWells()) {
+            const auto& cells = well->cells();
+            for (const int cell : cells) {
+                neighbors[cell].insert(cells.begin(), cells.end());
             }
         }
-        {
-            std::string filename = prefix + "rhs_istl";
+        wells.reserve(neighbors);
+        wells.clear();
+        wellModel.addWellContributions(wells);
+    }
+
+    template <class SimulatorType, class MatrixType, class VectorType, class Communicator>
+    void writeSystem(const SimulatorType& simulator,
+                     const MatrixType& matrix,
+                     const VectorType& rhs,
+                     const Communicator* comm)
+    {
+        const std::string prefix = systemFilePrefix(simulator);
+        writeMatrixMarket(matrix, prefix + "matrix_istl", comm);
+        writeMatrixMarket(rhs, prefix + "rhs_istl", comm);
+    }
+
+    /// \brief Write the linear system, together with the matrix of the
+    /// well contributions if these are applied by a separate operator.
+    ///
+    /// In the "matrixmarket" format the wells are written as
+    /// "<prefix>wells_istl", so that the system (matrix + wells) can be
+    /// replayed outside of the simulator. The "binary" format writes all
+    /// parts of the system to "<prefix>system_istl[_<rank>].bin", see
+    /// BinarySystemHeader, which is much faster to write and read for
+    /// large systems.
+    template <class SimulatorType, class MatrixType, class VectorType, class Communicator>
+    void writeSystem(const SimulatorType& simulator,
+                     const MatrixType& matrix,
+                     const VectorType& rhs,
+                     const MatrixType* wells,
+                     const Communicator* comm,
+                     const std::string& format = "matrixmarket")
+    {
+        if (format != "matrixmarket" && format != "binary") {
+            OPM_THROW(std::invalid_argument, "Unknown linear system dump format " << format
+                      << ", use matrixmarket or binary.");
+        }
+        const std::string prefix = systemFilePrefix(simulator);
+        if (format == "binary") {
+            std::string filename = prefix + "system_istl";
 #if HAVE_MPI
             if (comm != nullptr) { // comm is not set in serial runs
-                Dune::storeMatrixMarket(rhs, filename, *comm, true);
-            } else
-#endif
-            {
-                Dune::storeMatrixMarket(rhs, filename + ".mm");
+                filename += "_" + std::to_string(comm->communicator().rank());
             }
+#endif
+            writeBinarySystem(filename + ".bin", matrix, rhs, wells, comm);
+            return;
+        }
+        writeMatrixMarket(matrix, prefix + "matrix_istl", comm);
+        writeMatrixMarket(rhs, prefix + "rhs_istl", comm);
+        if (wells) {
+            writeMatrixMarket(*wells, prefix + "wells_istl", comm);
         }
     }
 
@@ -20,12 +20,21 @@
 #ifndef OPM_GET_QUASI_IMPES_WEIGHTS_HEADER_INCLUDED
 #define OPM_GET_QUASI_IMPES_WEIGHTS_HEADER_INCLUDED
 
+#include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 
+#include <opm/common/ErrorMacros.hpp>
 #include <opm/simulators/utils/DeferredLoggingErrorHelpers.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Opm
 {
@@ -42,49 +51,98 @@ namespace Details
 
         return tmp;
     }
+
+    /// \brief Whether LocalResidual::computeStorage(storage, intQuants) exists,
+    /// which evaluates the storage terms without an element context.
+    template <class LocalResidual, class IntensiveQuantities, class Storage, class = void>
+    struct HasIntensiveQuantitiesStorage : std::false_type
+    {
+    };
+
+    template <class LocalResidual, class IntensiveQuantities, class Storage>
+    struct HasIntensiveQuantitiesStorage<LocalResidual, IntensiveQuantities, Storage,
+        std::void_t<decltype(LocalResidual::computeStorage(std::declval<Storage&>(),
+                                                           std::declval<const IntensiveQuantities&>()))>>
+        : std::true_type
+    {
+    };
 } // namespace Details
 
 namespace Amg
 {
+    /// \brief Compute the quasi-IMPES weights of all rows in place.
+    ///
+    /// The weights of a row solve D^T w = e_p (or D w = e_p if transpose
+    /// is true) for its diagonal block D, scaled such that the largest
+    /// entry has magnitude one. The rows are independent and distributed
+    /// among the OpenMP threads.
+    ///
+    /// \param weights         Output, must have one block per row of the matrix.
+    /// \param diagonalOffsets Cache of the position of the diagonal block
+    ///                        within every row. It is built when its size does
+    ///                        not match the matrix, and otherwise trusted, so
+    ///                        the caller must clear it whenever the sparsity
+    ///                        pattern of the matrix changes.
     template <class Matrix, class Vector>
-    void getQuasiImpesWeights(const Matrix& matrix, const int pressureVarIndex, const bool transpose, Vector& weights)
+    void getQuasiImpesWeights(const Matrix& matrix, const int pressureVarIndex, const bool transpose, Vector& weights,
+                              std::vector<std::size_t>& diagonalOffsets)
     {
         using VectorBlockType = typename Vector::block_type;
         using MatrixBlockType = typename Matrix::block_type;
         const Matrix& A = matrix;
         VectorBlockType rhs(0.0);
         rhs[pressureVarIndex] = 1.0;
-        const auto endi = A.end();
-        for (auto i = A.begin(); i != endi; ++i) {
-            const auto endj = (*i).end();
+        const std::ptrdiff_t numRows = A.N();
+        const bool rebuild = diagonalOffsets.size() != A.N();
+        if (rebuild) {
+            diagonalOffsets.resize(numRows);
+        }
+        std::atomic<bool> singular(false);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t row = 0; row < numRows; ++row) {
+            const auto& Arow = A[row];
+            const auto* cols = Arow.getindexptr();
+            const std::size_t size = Arow.size();
+            std::size_t& diag = diagonalOffsets[row];
+            if (rebuild) {
+                diag = std::lower_bound(cols, cols + size, static_cast<std::size_t>(row)) - cols;
+            }
+            assert(diag <= size && (diag == size || static_cast<std::ptrdiff_t>(cols[diag]) >= row)
+                   && (diag == 0 || static_cast<std::ptrdiff_t>(cols[diag - 1]) < row));
             MatrixBlockType diag_block(0.0);
-            for (auto j = (*i).begin(); j != endj; ++j) {
-                if (i.index() == j.index()) {
-                    diag_block = (*j);
-                    break;
-                }
+            if (diag < size && static_cast<std::ptrdiff_t>(cols[diag]) == row) {
+                diag_block = Arow.getptr()[diag];
             }
             VectorBlockType bweights;
-            if (transpose) {
-                diag_block.solve(bweights, rhs);
-            } else {
-                auto diag_block_transpose = Details::transposeDenseMatrix(diag_block);
-                diag_block_transpose.solve(bweights, rhs);
+            try {
+                if (transpose) {
+                    diag_block.solve(bweights, rhs);
+                } else {
+                    auto diag_block_transpose = Details::transposeDenseMatrix(diag_block);
+                    diag_block_transpose.solve(bweights, rhs);
+                }
+            }
+            catch (const Dune::FMatrixError&) {
+                singular = true;
+                continue;
             }
             double abs_max = *std::max_element(
                 bweights.begin(), bweights.end(), [](double a, double b) { return std::fabs(a) < std::fabs(b); });
             bweights /= std::fabs(abs_max);
-            weights[i.index()] = bweights;
+            weights[row] = bweights;
+        }
+        if (singular) {
+            DUNE_THROW(Dune::FMatrixError, "Singular diagonal block in quasi-IMPES weight computation");
         }
-        // return weights;
     }
 
     template <class Matrix, class Vector>
-    Vector getQuasiImpesWeights(const Matrix& matrix, const int pressureVarIndex, const bool transpose)
+    void getQuasiImpesWeights(const Matrix& matrix, const int pressureVarIndex, const bool transpose, Vector& weights)
     {
-        Vector weights(matrix.N());
-        getQuasiImpesWeights(matrix, pressureVarIndex, transpose, weights);
-        return weights;
+        std::vector<std::size_t> diagonalOffsets;
+        getQuasiImpesWeights(matrix, pressureVarIndex, transpose, weights, diagonalOffsets);
     }
 
     template<class Vector, class GridView, class ElementContext, class Model>
@@ -130,6 +188,78 @@ namespace Amg
         }
         OPM_END_PARALLEL_TRY_CATCH("getTrueImpesWeights() failed: ", elemCtx.simulator().vanguard().grid().comm());
     }
+
+    /// \brief True-IMPES weights from the cached intensive quantities.
+    ///
+    /// Same weights as getTrueImpesWeights(), but the local residual
+    /// evaluates the storage terms on the intensive quantities cached by the
+    /// model during linearization. Hence neither element stencils nor fluid
+    /// states are re-evaluated, and the cells are processed in one pass
+    /// distributed among the OpenMP threads. The local residual must compute
+    /// the storage from the intensive quantities alone, see
+    /// Details::HasIntensiveQuantitiesStorage.
+    ///
+    /// Errors are collective on the communicator, so that all ranks throw
+    /// if one of them fails.
+    ///
+    /// \param dt   The time step size.
+    /// \param comm The communicator of the grid.
+    template<class LocalResidual, class Vector, class Model>
+    void getTrueImpesWeightsFromCache(int pressureVarIndex, Vector& weights, const Model& model, const double dt,
+                                      const Parallel::Communication& comm)
+    {
+        using VectorBlockType = typename Vector::block_type;
+        using MatrixBlockType = Dune::FieldMatrix<double, VectorBlockType::dimension, VectorBlockType::dimension>;
+        constexpr int numEq = VectorBlockType::dimension;
+        VectorBlockType rhs(0.0);
+        rhs[pressureVarIndex] = 1.0;
+        const std::ptrdiff_t numCells = weights.size();
+        std::atomic<bool> missing(false);
+        std::atomic<bool> singular(false);
+        OPM_BEGIN_PARALLEL_TRY_CATCH();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t cell = 0; cell < numCells; ++cell) {
+            const auto* intQuants = model.cachedIntensiveQuantities(cell, /*timeIdx=*/0);
+            if (!intQuants) {
+                missing = true;
+                continue;
+            }
+            using Evaluation = std::decay_t<decltype(intQuants->porosity())>;
+            Dune::FieldVector<Evaluation, numEq> storage;
+            LocalResidual::computeStorage(storage, *intQuants);
+            const double storage_scale = model.dofTotalVolume(cell) / dt;
+            MatrixBlockType block;
+            double pressure_scale = 50e5;
+            for (int ii = 0; ii < numEq; ++ii) {
+                for (int jj = 0; jj < numEq; ++jj) {
+                    block[ii][jj] = storage[ii].derivative(jj)/storage_scale;
+                    if (jj == pressureVarIndex) {
+                        block[ii][jj] *= pressure_scale;
+                    }
+                }
+            }
+            VectorBlockType bweights;
+            MatrixBlockType block_transpose = Details::transposeDenseMatrix(block);
+            try {
+                block_transpose.solve(bweights, rhs);
+            }
+            catch (const Dune::FMatrixError&) {
+                singular = true;
+                continue;
+            }
+            bweights /= 1000.0; // given normal densities this scales weights to about 1.
+            weights[cell] = bweights;
+        }
+        if (missing) {
+            OPM_THROW(std::logic_error, "getTrueImpesWeightsFromCache() requires the intensive quantity cache.");
+        }
+        if (singular) {
+            DUNE_THROW(Dune::FMatrixError, "Singular storage derivative block in true-IMPES weight computation");
+        }
+        OPM_END_PARALLEL_TRY_CATCH("getTrueImpesWeightsFromCache() failed: ", comm);
+    }
 } // namespace Amg
 
 } // namespace Opm
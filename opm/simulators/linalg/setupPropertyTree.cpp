@@ -114,6 +114,7 @@ setupCPRW(const std::string& /*conf*/, const FlowLinearSolverParameters& p)
     PropertyTree prm;
     prm.put("maxiter", p.linear_solver_maxiter_);
     prm.put("tol", p.linear_solver_reduction_);
+    prm.put("precision", p.linear_solver_precision_);
     prm.put("verbosity", p.linear_solver_verbosity_);
     prm.put("solver", "bicgstab"s);
     prm.put("preconditioner.type", "cprw"s);
@@ -122,6 +123,7 @@ setupCPRW(const std::string& /*conf*/, const FlowLinearSolverParameters& p)
     prm.put("preconditioner.weight_type", "trueimpes"s);
     prm.put("preconditioner.finesmoother.type", "ParOverILU0"s);
     prm.put("preconditioner.finesmoother.relaxation", 1.0);
+    prm.put("preconditioner.finesmoother.overlap_communication", p.linear_solver_overlap_communication_ ? "true"s : "false"s);
     prm.put("preconditioner.verbosity", 0);
     prm.put("preconditioner.coarsesolver.maxiter", 1);
     prm.put("preconditioner.coarsesolver.tol", 1e-1);
@@ -158,6 +160,7 @@ setupCPR(const std::string& conf, const FlowLinearSolverParameters& p)
     PropertyTree prm;
     prm.put("maxiter", p.linear_solver_maxiter_);
     prm.put("tol", p.linear_solver_reduction_);
+    prm.put("precision", p.linear_solver_precision_);
     prm.put("verbosity", p.linear_solver_verbosity_);
     prm.put("solver", "bicgstab"s);
     prm.put("preconditioner.type", "cpr"s);
@@ -168,6 +171,7 @@ setupCPR(const std::string& conf, const FlowLinearSolverParameters& p)
     }
     prm.put("preconditioner.finesmoother.type", "ParOverILU0"s);
     prm.put("preconditioner.finesmoother.relaxation", 1.0);
+    prm.put("preconditioner.finesmoother.overlap_communication", p.linear_solver_overlap_communication_ ? "true"s : "false"s);
     prm.put("preconditioner.verbosity", 0);
     prm.put("preconditioner.coarsesolver.maxiter", 1);
     prm.put("preconditioner.coarsesolver.tol", 1e-1);
@@ -204,6 +208,7 @@ setupAMG([[maybe_unused]] const std::string& conf, const FlowLinearSolverParamet
     using namespace std::string_literals;
     PropertyTree prm;
     prm.put("tol", p.linear_solver_reduction_);
+    prm.put("precision", p.linear_solver_precision_);
     prm.put("maxiter", p.linear_solver_maxiter_);
     prm.put("verbosity", p.linear_solver_verbosity_);
     prm.put("solver", "bicgstab"s);
@@ -238,12 +243,14 @@ setupILU([[maybe_unused]] const std::string& conf, const FlowLinearSolverParamet
     using namespace std::string_literals;
     PropertyTree prm;
     prm.put("tol", p.linear_solver_reduction_);
+    prm.put("precision", p.linear_solver_precision_);
     prm.put("maxiter", p.linear_solver_maxiter_);
     prm.put("verbosity", p.linear_solver_verbosity_);
     prm.put("solver", "bicgstab"s);
     prm.put("preconditioner.type", "ParOverILU0"s);
     prm.put("preconditioner.relaxation", p.ilu_relaxation_);
     prm.put("preconditioner.ilulevel", p.ilu_fillin_level_);
+    prm.put("preconditioner.overlap_communication", p.linear_solver_overlap_communication_ ? "true"s : "false"s);
     return prm;
 }
 
@@ -254,12 +261,14 @@ setupISAI([[maybe_unused]] const std::string& conf, const FlowLinearSolverParame
     using namespace std::string_literals;
     PropertyTree prm;
     prm.put("tol", p.linear_solver_reduction_);
+    prm.put("precision", p.linear_solver_precision_);
     prm.put("maxiter", p.linear_solver_maxiter_);
     prm.put("verbosity", p.linear_solver_verbosity_);
     prm.put("solver", "bicgstab"s);
     prm.put("preconditioner.type", "ParOverILU0"s);
     prm.put("preconditioner.relaxation", p.ilu_relaxation_);
     prm.put("preconditioner.ilulevel", p.ilu_fillin_level_);
+    prm.put("preconditioner.overlap_communication", p.linear_solver_overlap_communication_ ? "true"s : "false"s);
     return prm;
 }
 
@@ -316,6 +316,19 @@ namespace Opm {
 
             // a vector of all the wells.
             std::vector<WellInterfacePtr > well_container_{};
+
+            // the Schur complements of the standard wells, packed in linearize() for apply(x, Ax),
+            // and the wells that are applied on their own
+            typename StandardWell<TypeTag>::PackedWells packed_wells_{};
+            std::vector<const WellInterface<TypeTag>*> unpacked_wells_{};
+            bool packed_wells_valid_ = false;
+
+            // the symbolic factorizations of the multisegment wells, kept across time steps
+            // until the segments or connections of a well change
+            std::map<std::string, std::shared_ptr<const UMFPackSymbolic>> msw_symbolic_{};
+
+            // pack the Schur complements of the standard wells after they were assembled
+            void packWells();
  
             // map from logically cartesian cell indices to compressed ones
             std::vector<int> cartesian_to_compressed_;
@@ -410,6 +423,16 @@ namespace Opm {
 
             void assembleWellEq(const double dt, DeferredLogger& deferred_logger);
 
+            // Calls f(well, deferred_logger) for every well. With --parallel-well-assembly,
+            // the wells that do not depend on other wells run on several threads,
+            // each with its own logger, and the other wells follow serially.
+            template <class Func>
+            void forEachWell(Func&& f, DeferredLogger& deferred_logger);
+
+            // Whether the assembly of the well reads the state of other wells or
+            // communicates, so that it cannot run at the same time as other wells.
+            bool dependsOnOtherWells(const WellInterface<TypeTag>& well) const;
+
             bool maybeDoGasLiftOptimize(DeferredLogger& deferred_logger);
 
             void gasLiftOptimizationStage1(DeferredLogger& deferred_logger,
@@ -28,6 +28,8 @@
 #include <opm/simulators/wells/VFPProperties.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <utility>
 
 #include <fmt/format.h>
@@ -157,6 +159,7 @@ namespace Opm {
                     // r = r - duneC_^T * invDuneD_ * resWell_
                     well->apply(res);
                 }
+                packWells();
             }
             OPM_END_PARALLEL_TRY_CATCH("BlackoilWellModel::linearize failed: ",
                                        ebosSimulator_.gridView().comm());
@@ -592,7 +595,29 @@ namespace Opm {
 
         const int nw = numLocalWells();
 
+        // keep the symbolic factorizations of the multisegment wells for the new well objects
+        for (const auto& well : well_container_) {
+            const auto* ms_well = dynamic_cast<const MultisegmentWell<TypeTag>*>(well.get());
+            if (ms_well && ms_well->umfpackSymbolic()) {
+                msw_symbolic_[well->name()] = ms_well->umfpackSymbolic();
+            }
+        }
+        if (report_step_starts_) {
+            const uint64_t structure_events = ScheduleEvents::NEW_WELL
+                + ScheduleEvents::COMPLETION_CHANGE
+                + ScheduleEvents::WELL_WELSPECS_UPDATE;
+            const auto& events = this->schedule()[time_step].wellgroup_events();
+            for (auto it = msw_symbolic_.begin(); it != msw_symbolic_.end();) {
+                if (events.hasEvent(it->first, structure_events)) {
+                    it = msw_symbolic_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
         well_container_.clear();
+        packed_wells_valid_ = false;
 
         if (nw > 0) {
             well_container_.reserve(nw);
@@ -715,6 +740,13 @@ namespace Opm {
 
                 well_container_.emplace_back(this->createWellPointer(w, time_step));
 
+                if (auto* ms_well = dynamic_cast<MultisegmentWell<TypeTag>*>(well_container_.back().get())) {
+                    const auto symbolic = msw_symbolic_.find(well_name);
+                    if (symbolic != msw_symbolic_.end()) {
+                        ms_well->setUMFPackSymbolic(symbolic->second);
+                    }
+                }
+
                 if (wellIsStopped)
                     well_container_.back()->stopWell();
             }
@@ -831,6 +863,7 @@ namespace Opm {
         last_report_ = SimulatorReportSingle();
         Dune::Timer perfTimer;
         perfTimer.start();
+        packed_wells_valid_ = false;
 
         if ( ! wellsActive() ) {
             return;
@@ -1095,8 +1128,104 @@ namespace Opm {
     BlackoilWellModel<TypeTag>::
     assembleWellEq(const double dt, DeferredLogger& deferred_logger)
     {
+        forEachWell([this, dt](WellInterface<TypeTag>& well, DeferredLogger& well_logger) {
+            well.assembleWellEq(ebosSimulator_, dt, this->wellState(), this->groupState(), well_logger);
+        }, deferred_logger);
+    }
+
+    template<typename TypeTag>
+    template<class Func>
+    void
+    BlackoilWellModel<TypeTag>::
+    forEachWell(Func&& f, DeferredLogger& deferred_logger)
+    {
+        if (!param_.parallel_well_assembly_) {
+            for (auto& well : well_container_) {
+                f(*well, deferred_logger);
+            }
+            return;
+        }
+
+        std::vector<WellInterface<TypeTag>*> independent_wells;
+        std::vector<WellInterface<TypeTag>*> dependent_wells;
         for (auto& well : well_container_) {
-            well->assembleWellEq(ebosSimulator_, dt, this->wellState(), this->groupState(), deferred_logger);
+            if (dependsOnOtherWells(*well)) {
+                dependent_wells.push_back(well.get());
+            } else {
+                independent_wells.push_back(well.get());
+            }
+        }
+
+        // One logger per well keeps the messages in the order of the wells.
+        // Exceptions must not leave the parallel region, they are rethrown after it.
+        const std::ptrdiff_t num_independent = independent_wells.size();
+        std::vector<DeferredLogger> well_loggers(num_independent);
+        std::vector<std::exception_ptr> failures(num_independent);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (std::ptrdiff_t w = 0; w < num_independent; ++w) {
+            try {
+                f(*independent_wells[w], well_loggers[w]);
+            }
+            catch (...) {
+                failures[w] = std::current_exception();
+            }
+        }
+        for (const auto& well_logger : well_loggers) {
+            deferred_logger.append(well_logger);
+        }
+        for (const auto& failure : failures) {
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        for (auto* well : dependent_wells) {
+            f(*well, deferred_logger);
+        }
+    }
+
+    template<typename TypeTag>
+    bool
+    BlackoilWellModel<TypeTag>::
+    dependsOnOtherWells(const WellInterface<TypeTag>& well) const
+    {
+        // Distributed wells communicate, which must happen in the same order on all processes.
+        if (well.parallelWellInfo().communication().size() > 1) {
+            return true;
+        }
+        // Recomputing negative potentials, and the iterative fallback of the
+        // operability check under the THP limit, copy the state of all wells.
+        if (well.hasNegativePotentials()) {
+            return true;
+        }
+        if (param_.check_well_operability_iter_
+            && well.wellHasTHPConstraints(ebosSimulator_.vanguard().summaryState())) {
+            return true;
+        }
+        // The share of a group target depends on the rates and controls of the
+        // other wells of the group, so any group control above the well couples it.
+        const int reportStepIdx = ebosSimulator_.episodeIndex();
+        const auto& group_state = this->groupState();
+        std::string group_name = well.wellEcl().groupName();
+        while (true) {
+            if (well.isProducer() && group_state.has_production_control(group_name)
+                && group_state.production_control(group_name) != Group::ProductionCMode::NONE) {
+                return true;
+            }
+            if (well.isInjector()) {
+                for (const Phase phase : {Phase::WATER, Phase::OIL, Phase::GAS}) {
+                    if (group_state.has_injection_control(group_name, phase)
+                        && group_state.injection_control(group_name, phase) != Group::InjectionCMode::NONE) {
+                        return true;
+                    }
+                }
+            }
+            if (group_name == "FIELD") {
+                return false;
+            }
+            group_name = schedule().getGroup(group_name, reportStepIdx).parent();
         }
     }
 
@@ -1126,11 +1255,38 @@ namespace Opm {
             return;
         }
 
+        if (packed_wells_valid_) {
+            packed_wells_.apply(x, Ax);
+            for (const auto* well : unpacked_wells_) {
+                well->apply(x, Ax);
+            }
+            return;
+        }
+
         for (auto& well : well_container_) {
             well->apply(x, Ax);
         }
     }
 
+    template<typename TypeTag>
+    void
+    BlackoilWellModel<TypeTag>::
+    packWells()
+    {
+        packed_wells_.clear();
+        unpacked_wells_.clear();
+        for (const auto& well : well_container_) {
+            const auto* std_well = dynamic_cast<const StandardWell<TypeTag>*>(well.get());
+            // wells that are neither operable nor stopped are not applied at all
+            const bool applied = well->isOperableAndSolvable() || well->wellIsStopped();
+            if (std_well && (!applied || std_well->addToPackedWells(packed_wells_))) {
+                continue;
+            }
+            unpacked_wells_.push_back(well.get());
+        }
+        packed_wells_valid_ = true;
+    }
+
 #if HAVE_CUDA || HAVE_OPENCL
     template<typename TypeTag>
     void
@@ -1613,26 +1769,26 @@ namespace Opm {
     BlackoilWellModel<TypeTag>::
     prepareTimeStep(DeferredLogger& deferred_logger)
     {
-        for (const auto& well : well_container_) {
-            auto& events = this->wellState().well(well->indexOfWell()).events;
+        forEachWell([this](WellInterface<TypeTag>& well, DeferredLogger& well_logger) {
+            auto& events = this->wellState().well(well.indexOfWell()).events;
             if (events.hasEvent(WellState::event_mask)) {
-                well->updateWellStateWithTarget(ebosSimulator_, this->groupState(), this->wellState(), deferred_logger);
-                well->updatePrimaryVariables(this->wellState(), deferred_logger);
-                well->initPrimaryVariablesEvaluation();
+                well.updateWellStateWithTarget(ebosSimulator_, this->groupState(), this->wellState(), well_logger);
+                well.updatePrimaryVariables(this->wellState(), well_logger);
+                well.initPrimaryVariablesEvaluation();
                 // There is no new well control change input within a report step,
                 // so next time step, the well does not consider to have effective events anymore.
                 events.clearEvent(WellState::event_mask);
             }
             // solve the well equation initially to improve the initial solution of the well model
-            if (param_.solve_welleq_initially_ && well->isOperableAndSolvable()) {
+            if (param_.solve_welleq_initially_ && well.isOperableAndSolvable()) {
                 try {
-                    well->solveWellEquation(ebosSimulator_, this->wellState(), this->groupState(), deferred_logger);
+                    well.solveWellEquation(ebosSimulator_, this->wellState(), this->groupState(), well_logger);
                 } catch (const std::exception& e) {
-                    const std::string msg = "Compute initial well solution for " + well->name() + " initially failed. Continue with the privious rates";
-                    deferred_logger.warning("WELL_INITIAL_SOLVE_FAILED", msg);
+                    const std::string msg = "Compute initial well solution for " + well.name() + " initially failed. Continue with the privious rates";
+                    well_logger.warning("WELL_INITIAL_SOLVE_FAILED", msg);
                 }
             }
-        }
+        }, deferred_logger);
         updatePrimaryVariables(deferred_logger);
     }
 
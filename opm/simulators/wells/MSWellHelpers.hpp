@@ -33,9 +33,6 @@
 #include <dune/istl/preconditioners.hh>
 #include <dune/istl/solvers.hh>
 
-#if HAVE_UMFPACK
-#include <dune/istl/umfpack.hh>
-#endif // HAVE_UMFPACK
 #include <cmath>
 
 namespace Opm {
@@ -43,86 +40,6 @@ namespace Opm {
 namespace mswellhelpers
 {
 
-    /// Applies umfpack and checks for singularity
-    template <typename MatrixType, typename VectorType>
-    VectorType
-    applyUMFPack(const MatrixType& D, std::shared_ptr<Dune::UMFPack<MatrixType> >& linsolver, VectorType x)
-    {
-#if HAVE_UMFPACK
-        if (!linsolver)
-        {
-            linsolver.reset(new Dune::UMFPack<MatrixType>(D, 0));
-        }
-
-        // The copy of x seems mandatory for calling UMFPack!
-        VectorType y(x.size());
-        y = 0.;
-
-        // Object storing some statistics about the solving process
-        Dune::InverseOperatorResult res;
-
-        // Solve
-        linsolver->apply(y, x, res);
-
-        // Checking if there is any inf or nan in y
-        // it will be the solution before we find a way to catch the singularity of the matrix
-        for (size_t i_block = 0; i_block < y.size(); ++i_block) {
-            for (size_t i_elem = 0; i_elem < y[i_block].size(); ++i_elem) {
-                if (std::isinf(y[i_block][i_elem]) || std::isnan(y[i_block][i_elem]) ) {
-                    const std::string msg{"nan or inf value found after UMFPack solve due to singular matrix"};
-                    OpmLog::debug(msg);
-                    OPM_THROW_NOLOG(NumericalIssue, msg);
-                }
-            }
-        }
-        return y;
-#else
-        // this is not thread safe
-        OPM_THROW(std::runtime_error, "Cannot use applyUMFPack() without UMFPACK. "
-                  "Reconfigure opm-simulators with SuiteSparse/UMFPACK support and recompile.");
-#endif // HAVE_UMFPACK
-    }
-
-
-
-    /// Applies umfpack and checks for singularity
-    template <typename MatrixType, typename VectorType>
-    Dune::Matrix<typename MatrixType::block_type>
-    invertWithUMFPack(const MatrixType& D, std::shared_ptr<Dune::UMFPack<MatrixType> >& linsolver)
-    {
-#if HAVE_UMFPACK
-        const int sz = D.M();
-        const int bsz = D[0][0].M();
-        VectorType e(sz);
-        e = 0.0;
-
-        // Make a full block matrix.
-        Dune::Matrix<typename MatrixType::block_type> inv(sz, sz);
-
-        // Create inverse by passing basis vectors to the solver.
-        for (int ii = 0; ii < sz; ++ii) {
-            for (int jj = 0; jj < bsz; ++jj) {
-                e[ii][jj] = 1.0;
-                auto col = applyUMFPack(D, linsolver, e);
-                for (int cc = 0; cc < sz; ++cc) {
-                    for (int dd = 0; dd < bsz; ++dd) {
-                        inv[cc][ii][dd][jj] = col[cc][dd];
-                    }
-                }
-                e[ii][jj] = 0.0;
-            }
-        }
-
-        return inv;
-#else
-        // this is not thread safe
-        OPM_THROW(std::runtime_error, "Cannot use invertWithUMFPack() without UMFPACK. "
-                  "Reconfigure opm-simulators with SuiteSparse/UMFPACK support and recompile.");
-#endif // HAVE_UMFPACK
-    }
-
-
-
     // obtain y = D^-1 * x with a BICSSTAB iterative solver
     template <typename MatrixType, typename VectorType>
     VectorType
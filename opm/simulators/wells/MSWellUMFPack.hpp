@@ -0,0 +1,311 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_MSWELLUMFPACK_HEADER_INCLUDED
+#define OPM_MSWELLUMFPACK_HEADER_INCLUDED
+
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/common/Exceptions.hpp>
+#include <opm/common/OpmLog/OpmLog.hpp>
+
+#if HAVE_UMFPACK
+#include <umfpack.h>
+#endif // HAVE_UMFPACK
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief The symbolic UMFPack factorization of a sparsity pattern.
+///
+/// The symbolic analysis only depends on the pattern, which for the D
+/// matrix of a multisegment well only changes with the segments of the
+/// well. It is therefore shared by all objects that solve with the same
+/// pattern, also by the well objects of later time steps. It is not
+/// changed after construction, so it can be used from several threads.
+class UMFPackSymbolic
+{
+public:
+    /// \brief Analyze a compressed column pattern, with the values used for the choice of strategy.
+    UMFPackSymbolic(const std::vector<int>& colStart,
+                    const std::vector<int>& rowIndex,
+                    const std::vector<double>& values)
+        : colStart_(colStart)
+        , rowIndex_(rowIndex)
+    {
+#if HAVE_UMFPACK
+        const int n = static_cast<int>(colStart_.size()) - 1;
+        const int status = umfpack_di_symbolic(n, n, colStart_.data(), rowIndex_.data(), values.data(),
+                                               &symbolic_, nullptr, nullptr);
+        if (status != UMFPACK_OK) {
+            symbolic_ = nullptr;
+            const std::string msg = "UMFPack symbolic factorization failed with status " + std::to_string(status);
+            OpmLog::debug(msg);
+            OPM_THROW_NOLOG(NumericalIssue, msg);
+        }
+#else
+        static_cast<void>(values);
+        OPM_THROW(std::runtime_error, "Cannot use UMFPackSymbolic without UMFPACK. "
+                  "Reconfigure opm-simulators with SuiteSparse/UMFPACK support and recompile.");
+#endif // HAVE_UMFPACK
+    }
+
+    UMFPackSymbolic(const UMFPackSymbolic&) = delete;
+    UMFPackSymbolic& operator=(const UMFPackSymbolic&) = delete;
+
+    ~UMFPackSymbolic()
+    {
+#if HAVE_UMFPACK
+        if (symbolic_) {
+            umfpack_di_free_symbolic(&symbolic_);
+        }
+#endif // HAVE_UMFPACK
+    }
+
+    /// \brief True if the factorization was made for this pattern.
+    bool matches(const std::vector<int>& colStart, const std::vector<int>& rowIndex) const
+    {
+        return colStart == colStart_ && rowIndex == rowIndex_;
+    }
+
+    void* handle() const
+    {
+        return symbolic_;
+    }
+
+private:
+    std::vector<int> colStart_;
+    std::vector<int> rowIndex_;
+    void* symbolic_ = nullptr;
+};
+
+/// \brief UMFPack solver for the D matrix of a multisegment well.
+///
+/// Unlike Dune::UMFPack, which redoes the symbolic analysis whenever it
+/// is created for a new matrix, the pattern and its symbolic factorization
+/// are kept as long as the sparsity of D stays the same, and only the
+/// numeric factorization is redone after every assembly. Copies share the
+/// symbolic factorization, but each makes its own numeric factorization.
+class MSWellUMFPack
+{
+public:
+    MSWellUMFPack() = default;
+
+    MSWellUMFPack(const MSWellUMFPack& other)
+        : colStart_(other.colStart_)
+        , rowIndex_(other.rowIndex_)
+        , position_(other.position_)
+        , values_(other.values_)
+        , symbolic_(other.symbolic_)
+    {
+    }
+
+    MSWellUMFPack& operator=(const MSWellUMFPack& other)
+    {
+        if (this != &other) {
+            freeNumeric();
+            colStart_ = other.colStart_;
+            rowIndex_ = other.rowIndex_;
+            position_ = other.position_;
+            values_ = other.values_;
+            symbolic_ = other.symbolic_;
+        }
+        return *this;
+    }
+
+    ~MSWellUMFPack()
+    {
+        freeNumeric();
+    }
+
+    /// \brief Set up the compressed column pattern of the block matrix D.
+    ///
+    /// All entries of the blocks are part of the pattern. A symbolic
+    /// factorization made for another pattern is dropped.
+    template <class Matrix>
+    void analyze(const Matrix& D)
+    {
+        freeNumeric();
+        constexpr int bs = Matrix::block_type::rows;
+        const int n = static_cast<int>(D.N()) * bs;
+        colStart_.assign(n + 1, 0);
+        for (std::size_t row = 0; row < D.N(); ++row) {
+            for (auto col = D[row].begin(); col != D[row].end(); ++col) {
+                for (int j = 0; j < bs; ++j) {
+                    colStart_[col.index() * bs + j + 1] += bs;
+                }
+            }
+        }
+        for (int c = 0; c < n; ++c) {
+            colStart_[c + 1] += colStart_[c];
+        }
+
+        // Going through the block rows in order gives sorted row indices in every column.
+        std::vector<int> next(colStart_.begin(), colStart_.end() - 1);
+        rowIndex_.resize(colStart_.back());
+        position_.clear();
+        position_.reserve(colStart_.back());
+        for (std::size_t row = 0; row < D.N(); ++row) {
+            for (auto col = D[row].begin(); col != D[row].end(); ++col) {
+                for (int i = 0; i < bs; ++i) {
+                    for (int j = 0; j < bs; ++j) {
+                        const int k = next[col.index() * bs + j]++;
+                        rowIndex_[k] = static_cast<int>(row) * bs + i;
+                        position_.push_back(k);
+                    }
+                }
+            }
+        }
+        values_.assign(colStart_.back(), 0.0);
+
+        if (symbolic_ && !symbolic_->matches(colStart_, rowIndex_)) {
+            symbolic_.reset();
+        }
+    }
+
+    /// \brief Reuse a symbolic factorization, unless it was made for another pattern.
+    void setSymbolic(std::shared_ptr<const UMFPackSymbolic> symbolic)
+    {
+        if (symbolic && (colStart_.empty() || symbolic->matches(colStart_, rowIndex_))) {
+            symbolic_ = std::move(symbolic);
+        }
+    }
+
+    /// \brief The symbolic factorization, empty before the first factorization.
+    const std::shared_ptr<const UMFPackSymbolic>& symbolic() const
+    {
+        return symbolic_;
+    }
+
+    /// \brief Mark the numeric factorization as outdated, after the entries of D changed.
+    void invalidate()
+    {
+        freeNumeric();
+    }
+
+    /// \brief True if D must be factorized before the next solve.
+    bool pending() const
+    {
+        return numeric_ == nullptr;
+    }
+
+    /// \brief Factorize D numerically, with the pattern given to analyze().
+    template <class Matrix>
+    void factorize(const Matrix& D)
+    {
+#if HAVE_UMFPACK
+        freeNumeric();
+        std::size_t k = 0;
+        for (std::size_t row = 0; row < D.N(); ++row) {
+            for (auto col = D[row].begin(); col != D[row].end(); ++col) {
+                for (const auto& blockRow : *col) {
+                    for (const auto& value : blockRow) {
+                        values_[position_[k++]] = value;
+                    }
+                }
+            }
+        }
+        if (!symbolic_) {
+            symbolic_ = std::make_shared<const UMFPackSymbolic>(colStart_, rowIndex_, values_);
+        }
+        const int status = umfpack_di_numeric(colStart_.data(), rowIndex_.data(), values_.data(),
+                                              symbolic_->handle(), &numeric_, nullptr, nullptr);
+        // A singular matrix is only a warning, and is caught after the solve.
+        if (status < UMFPACK_OK) {
+            freeNumeric();
+            const std::string msg = "UMFPack numeric factorization failed with status " + std::to_string(status);
+            OpmLog::debug(msg);
+            OPM_THROW_NOLOG(NumericalIssue, msg);
+        }
+#else
+        static_cast<void>(D);
+        OPM_THROW(std::runtime_error, "Cannot use MSWellUMFPack without UMFPACK. "
+                  "Reconfigure opm-simulators with SuiteSparse/UMFPACK support and recompile.");
+#endif // HAVE_UMFPACK
+    }
+
+    /// \brief x = D^-1 x, with the last factorization of D.
+    template <class Vector>
+    void solve(Vector& x) const
+    {
+#if HAVE_UMFPACK
+        const std::size_t n = colStart_.size() - 1;
+        rhs_.resize(n);
+        std::size_t k = 0;
+        for (const auto& block : x) {
+            for (const auto& value : block) {
+                rhs_[k++] = value;
+            }
+        }
+        solution_.resize(n);
+        umfpack_di_solve(UMFPACK_A, colStart_.data(), rowIndex_.data(), values_.data(),
+                         solution_.data(), rhs_.data(), numeric_, nullptr, nullptr);
+
+        // Checking if there is any inf or nan in the solution
+        // it will be the solution before we find a way to catch the singularity of the matrix
+        k = 0;
+        for (auto& block : x) {
+            for (auto& value : block) {
+                value = solution_[k++];
+                if (std::isinf(value) || std::isnan(value)) {
+                    const std::string msg{"nan or inf value found after UMFPack solve due to singular matrix"};
+                    OpmLog::debug(msg);
+                    OPM_THROW_NOLOG(NumericalIssue, msg);
+                }
+            }
+        }
+#else
+        static_cast<void>(x);
+        OPM_THROW(std::runtime_error, "Cannot use MSWellUMFPack without UMFPACK. "
+                  "Reconfigure opm-simulators with SuiteSparse/UMFPACK support and recompile.");
+#endif // HAVE_UMFPACK
+    }
+
+private:
+    void freeNumeric()
+    {
+#if HAVE_UMFPACK
+        if (numeric_) {
+            umfpack_di_free_numeric(&numeric_);
+        }
+#endif // HAVE_UMFPACK
+        numeric_ = nullptr;
+    }
+
+    //! \brief The compressed column pattern of D, with all entries of the blocks.
+    std::vector<int> colStart_;
+    std::vector<int> rowIndex_;
+    //! \brief Position in the compressed columns of every entry of D, in the order of its rows and blocks.
+    std::vector<int> position_;
+    std::vector<double> values_;
+    std::shared_ptr<const UMFPackSymbolic> symbolic_;
+    void* numeric_ = nullptr;
+    mutable std::vector<double> rhs_;
+    mutable std::vector<double> solution_;
+};
+
+} // namespace Opm
+
+#endif // OPM_MSWELLUMFPACK_HEADER_INCLUDED
@@ -138,6 +138,13 @@ namespace Opm
                                              DeferredLogger& deferred_logger) const override;
 
         virtual void  addWellContributions(SparseMatrixAdapter& jacobian) const override;
+
+        /// the symbolic factorization of the UMFPack solver for D, empty until it was needed
+        std::shared_ptr<const UMFPackSymbolic> umfpackSymbolic() const;
+
+        /// reuse the symbolic factorization from an earlier well object of this well,
+        /// it is dropped if the sparsity of D changed
+        void setUMFPackSymbolic(std::shared_ptr<const UMFPackSymbolic> symbolic);
         
         virtual void addWellPressureEquations(PressureMatrix& mat,
                                               const BVector& x,
@@ -122,6 +122,9 @@ initMatrixAndVectors(const int num_cells) const
 
     resWell_.resize(this->numberOfSegments());
 
+    duneDTreeSolver_.analyze(duneD_);
+    duneDSolver_.analyze(duneD_);
+
     primary_variables_.resize(this->numberOfSegments());
     primary_variables_evaluation_.resize(this->numberOfSegments());
 }
@@ -512,11 +515,59 @@ recoverSolutionWell(const BVector& x, BVectorWell& xw) const
 {
     if (!baseif_.isOperableAndSolvable() && !baseif_.wellIsStopped()) return;
 
-    BVectorWell resWell = resWell_;
-    // resWell = resWell - B * x
-    duneB_.mmv(x, resWell);
-    // xw = D^-1 * resWell
-    xw = mswellhelpers::applyUMFPack(duneD_, duneDSolver_, resWell);
+    xw = resWell_;
+    // xw = resWell - B * x
+    duneB_.mmv(x, xw);
+    // xw = D^-1 * xw
+    solveD(xw);
+}
+
+template<typename FluidSystem, typename Indices, typename Scalar>
+void
+MultisegmentWellEval<FluidSystem,Indices,Scalar>::
+solveD(BVectorWell& x) const
+{
+    if (duneDTreeSolver_.pending()) {
+        duneDTreeSolver_.factorize(duneD_);
+    }
+    if (duneDTreeSolver_.factorized()) {
+        duneDTreeSolver_.solve(x);
+    } else {
+        if (duneDSolver_.pending()) {
+            duneDSolver_.factorize(duneD_);
+        }
+        duneDSolver_.solve(x);
+    }
+}
+
+template<typename FluidSystem, typename Indices, typename Scalar>
+Dune::Matrix<typename MultisegmentWellEval<FluidSystem,Indices,Scalar>::DiagMatrixBlockWellType>
+MultisegmentWellEval<FluidSystem,Indices,Scalar>::
+invertD() const
+{
+    const int sz = duneD_.M();
+    Dune::Matrix<DiagMatrixBlockWellType> inv(sz, sz);
+    inv = 0.0;
+
+    // Only the columns of the segments coupled to cells by B are needed.
+    BVectorWell e(sz);
+    for (int ii = 0; ii < sz; ++ii) {
+        if (duneB_[ii].size() == 0) {
+            continue;
+        }
+        for (int jj = 0; jj < numWellEq; ++jj) {
+            e = 0.0;
+            e[ii][jj] = 1.0;
+            solveD(e);
+            for (int cc = 0; cc < sz; ++cc) {
+                for (int dd = 0; dd < numWellEq; ++dd) {
+                    inv[cc][ii][dd][jj] = e[cc][dd];
+                }
+            }
+        }
+    }
+
+    return inv;
 }
 
 template<typename FluidSystem, typename Indices, typename Scalar>
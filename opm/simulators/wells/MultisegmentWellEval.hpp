@@ -22,7 +22,9 @@
 #ifndef OPM_MULTISEGMENTWELL_EVAL_HEADER_INCLUDED
 #define OPM_MULTISEGMENTWELL_EVAL_HEADER_INCLUDED
 
+#include <opm/simulators/wells/MSWellUMFPack.hpp>
 #include <opm/simulators/wells/MultisegmentWellGeneric.hpp>
+#include <opm/simulators/wells/SegmentTreeSolver.hpp>
 
 #include <opm/material/densead/Evaluation.hpp>
 
@@ -32,6 +34,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/bvector.hh>
+#include <dune/istl/matrix.hh>
 #include <dune/istl/umfpack.hh>
 
 #include <array>
@@ -168,6 +171,12 @@ protected:
     void recoverSolutionWell(const BVector& x,
                              BVectorWell& xw) const;
 
+    // x = inv(D)*x, with the tree solver if it can factorize D and UMFPack otherwise
+    void solveD(BVectorWell& x) const;
+
+    // the columns of inv(D) for the segments with perforations, the other columns are zero
+    Dune::Matrix<DiagMatrixBlockWellType> invertD() const;
+
     void updatePrimaryVariables(const WellState& well_state) const;
 
     void updateUpwindingSegments();
@@ -262,8 +271,16 @@ protected:
 
     /// \brief solver for diagonal matrix
     ///
-    /// This is a shared_ptr as MultisegmentWell is copied in computeWellPotentials...
-    mutable std::shared_ptr<Dune::UMFPack<DiagMatWell> > duneDSolver_;
+    /// Keeps the symbolic factorization for the sparsity of duneD_, which is shared
+    /// with the copies made in computeWellPotentials and with the well objects of later
+    /// time steps. Only the numeric factorization is redone after every assembly.
+    mutable MSWellUMFPack duneDSolver_;
+
+    /// \brief solver for diagonal matrix, following the tree of the segments
+    ///
+    /// Used instead of duneDSolver_ unless D is not a tree or has a singular pivot block.
+    /// It has to be invalidated whenever duneD_ changes.
+    mutable SegmentTreeSolver<Scalar, numWellEq> duneDTreeSolver_;
 
     // residuals of the well equations
     mutable BVectorWell resWell_;
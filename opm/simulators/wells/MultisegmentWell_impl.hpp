@@ -204,11 +204,11 @@ namespace Opm
 
         this->duneB_.mv(x, Bx);
 
-        // invDBx = duneD^-1 * Bx_
-        const BVectorWell invDBx = mswellhelpers::applyUMFPack(this->duneD_, this->duneDSolver_, Bx);
+        // Bx = duneD^-1 * Bx
+        this->solveD(Bx);
 
-        // Ax = Ax - duneC_^T * invDBx
-        this->duneC_.mmtv(invDBx,Ax);
+        // Ax = Ax - duneC_^T * Bx
+        this->duneC_.mmtv(Bx,Ax);
     }
 
 
@@ -223,7 +223,8 @@ namespace Opm
         if (!this->isOperableAndSolvable() && !this->wellIsStopped()) return;
 
         // invDrw_ = duneD^-1 * resWell_
-        const BVectorWell invDrw = mswellhelpers::applyUMFPack(this->duneD_, this->duneDSolver_, this->resWell_);
+        BVectorWell invDrw = this->resWell_;
+        this->solveD(invDrw);
         // r = r - duneC_^T * invDrw
         this->duneC_.mmtv(invDrw, r);
     }
@@ -523,7 +524,8 @@ namespace Opm
 
         // We assemble the well equations, then we check the convergence,
         // which is why we do not put the assembleWellEq here.
-        const BVectorWell dx_well = mswellhelpers::applyUMFPack(this->duneD_, this->duneDSolver_, this->resWell_);
+        BVectorWell dx_well = this->resWell_;
+        this->solveD(dx_well);
 
         updateWellState(dx_well, well_state, deferred_logger);
     }
@@ -719,12 +721,36 @@ namespace Opm
 
 
 
+    template<typename TypeTag>
+    std::shared_ptr<const UMFPackSymbolic>
+    MultisegmentWell<TypeTag>::
+    umfpackSymbolic() const
+    {
+        return this->duneDSolver_.symbolic();
+    }
+
+
+
+
+
+    template<typename TypeTag>
+    void
+    MultisegmentWell<TypeTag>::
+    setUMFPackSymbolic(std::shared_ptr<const UMFPackSymbolic> symbolic)
+    {
+        this->duneDSolver_.setSymbolic(std::move(symbolic));
+    }
+
+
+
+
+
     template<typename TypeTag>
     void
     MultisegmentWell<TypeTag>::
     addWellContributions(SparseMatrixAdapter& jacobian) const
     {
-        const auto invDuneD = mswellhelpers::invertWithUMFPack<DiagMatWell, BVectorWell>(this->duneD_, this->duneDSolver_);
+        const auto invDuneD = this->invertD();
 
         // We need to change matrix A as follows
         // A -= C^T D^-1 B
@@ -1478,7 +1504,8 @@ namespace Opm
 
             assembleWellEqWithoutIteration(ebosSimulator, dt, inj_controls, prod_controls, well_state, group_state, deferred_logger);
 
-            const BVectorWell dx_well = mswellhelpers::applyUMFPack(this->duneD_, this->duneDSolver_, this->resWell_);
+            BVectorWell dx_well = this->resWell_;
+            this->solveD(dx_well);
 
             if (it > this->param_.strict_inner_iter_wells_) {
                 relax_convergence = true;
@@ -1611,7 +1638,8 @@ namespace Opm
         this->duneD_ = 0.0;
         this->resWell_ = 0.0;
 
-        this->duneDSolver_.reset();
+        this->duneDSolver_.invalidate();
+        this->duneDTreeSolver_.invalidate();
 
         auto& ws = well_state.well(this->index_of_well_);
         ws.dissolved_gas_rate = 0;
@@ -0,0 +1,220 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PACKEDSTANDARDWELLS_HEADER_INCLUDED
+#define OPM_PACKEDSTANDARDWELLS_HEADER_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief The Schur complements of many standard wells, stored contiguously.
+///
+/// Applying the wells one by one, through StandardWell::apply(), goes
+/// through a virtual call and three sparse matrices with dynamic blocks
+/// per well. Here the B, C and inverse D blocks of all wells are stored
+/// in flat arrays with fixed block sizes, together with the cells of the
+/// perforations, and apply() does Ax -= C^T D^-1 B x for all wells in one
+/// loop. The arithmetic is done in the same order as the Dune matrices.
+/// A single StandardWell also keeps its own system in this form, for the
+/// fixed-size kernels of its linear algebra.
+///
+/// \tparam Scalar     The scalar type of the blocks.
+/// \tparam numEq      Number of reservoir equations per cell.
+/// \tparam numWellEq  Number of equations per well.
+template <class Scalar, int numEq, int numWellEq>
+class PackedStandardWells
+{
+public:
+    static constexpr int offDiagBlockSize = numWellEq * numEq;
+    static constexpr int diagBlockSize = numWellEq * numWellEq;
+
+    /// \brief Remove all wells, keeping the allocated memory.
+    void clear()
+    {
+        wellStart_.assign(1, 0);
+        cells_.clear();
+        B_.clear();
+        C_.clear();
+        invD_.clear();
+    }
+
+    /// \brief Start a new well.
+    /// \param invD  The inverse of the diagonal block D of the well.
+    template <class DiagBlock>
+    void addWell(const DiagBlock& invD)
+    {
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numWellEq; ++j) {
+                invD_.push_back(invD[i][j]);
+            }
+        }
+        wellStart_.push_back(wellStart_.back());
+    }
+
+    /// \brief Add a perforation to the last well.
+    /// \param cell  The perforated cell.
+    /// \param B     The block of B in the column of the cell.
+    /// \param C     The block of C in the column of the cell.
+    template <class OffDiagBlock>
+    void addPerforation(const int cell, const OffDiagBlock& B, const OffDiagBlock& C)
+    {
+        cells_.push_back(cell);
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numEq; ++j) {
+                B_.push_back(B[i][j]);
+                C_.push_back(C[i][j]);
+            }
+        }
+        ++wellStart_.back();
+    }
+
+    /// \brief Add all wells of another object.
+    void append(const PackedStandardWells& other)
+    {
+        const std::size_t offset = wellStart_.back();
+        for (std::size_t w = 1; w < other.wellStart_.size(); ++w) {
+            wellStart_.push_back(offset + other.wellStart_[w]);
+        }
+        cells_.insert(cells_.end(), other.cells_.begin(), other.cells_.end());
+        B_.insert(B_.end(), other.B_.begin(), other.B_.end());
+        C_.insert(C_.end(), other.C_.begin(), other.C_.end());
+        invD_.insert(invD_.end(), other.invD_.begin(), other.invD_.end());
+    }
+
+    std::size_t numWells() const
+    {
+        return wellStart_.size() - 1;
+    }
+
+    /// \brief Ax -= C^T D^-1 B x for all wells.
+    template <class X, class Y>
+    void apply(const X& x, Y& Ax) const
+    {
+        const std::size_t nw = numWells();
+        for (std::size_t w = 0; w < nw; ++w) {
+            WellBlock Bx{};
+            multB(w, x, Bx);
+            WellBlock invDBx{};
+            multInvD(w, Bx, invDBx);
+            multmCT(w, invDBx, Ax);
+        }
+    }
+
+    /// \brief r -= C^T D^-1 resWell for well w.
+    template <class WellVector, class Y>
+    void applyResidual(const std::size_t w, const WellVector& resWell, Y& r) const
+    {
+        WellBlock invDr{};
+        multInvD(w, resWell, invDr);
+        multmCT(w, invDr, r);
+    }
+
+    /// \brief xw = D^-1 resWell for well w.
+    template <class WellVector, class WellSolution>
+    void solveWell(const std::size_t w, const WellVector& resWell, WellSolution& xw) const
+    {
+        WellBlock invDr{};
+        multInvD(w, resWell, invDr);
+        for (int i = 0; i < numWellEq; ++i) {
+            xw[i] = invDr[i];
+        }
+    }
+
+    /// \brief xw = D^-1 (resWell - B x) for well w.
+    template <class X, class WellVector, class WellSolution>
+    void recoverSolution(const std::size_t w, const X& x, const WellVector& resWell, WellSolution& xw) const
+    {
+        WellBlock r;
+        for (int i = 0; i < numWellEq; ++i) {
+            r[i] = resWell[i];
+        }
+        for (std::size_t perf = wellStart_[w]; perf < wellStart_[w + 1]; ++perf) {
+            const auto& xc = x[cells_[perf]];
+            const Scalar* B = &B_[perf * offDiagBlockSize];
+            for (int i = 0; i < numWellEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    r[i] -= B[i * numEq + j] * xc[j];
+                }
+            }
+        }
+        solveWell(w, r, xw);
+    }
+
+private:
+    using WellBlock = std::array<Scalar, numWellEq>;
+
+    //! \brief Bx += B x for well w.
+    template <class X>
+    void multB(const std::size_t w, const X& x, WellBlock& Bx) const
+    {
+        for (std::size_t perf = wellStart_[w]; perf < wellStart_[w + 1]; ++perf) {
+            const auto& xc = x[cells_[perf]];
+            const Scalar* B = &B_[perf * offDiagBlockSize];
+            for (int i = 0; i < numWellEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    Bx[i] += B[i * numEq + j] * xc[j];
+                }
+            }
+        }
+    }
+
+    //! \brief y += D^-1 v for well w.
+    template <class WellVector>
+    void multInvD(const std::size_t w, const WellVector& v, WellBlock& y) const
+    {
+        const Scalar* invD = &invD_[w * diagBlockSize];
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numWellEq; ++j) {
+                y[i] += invD[i * numWellEq + j] * v[j];
+            }
+        }
+    }
+
+    //! \brief y -= C^T v for well w.
+    template <class Y>
+    void multmCT(const std::size_t w, const WellBlock& v, Y& y) const
+    {
+        for (std::size_t perf = wellStart_[w]; perf < wellStart_[w + 1]; ++perf) {
+            auto& yc = y[cells_[perf]];
+            const Scalar* C = &C_[perf * offDiagBlockSize];
+            for (int i = 0; i < numWellEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    yc[j] -= C[i * numEq + j] * v[i];
+                }
+            }
+        }
+    }
+
+    //! \brief The first perforation of every well, and the end of the last well.
+    std::vector<std::size_t> wellStart_{0};
+    std::vector<int> cells_;
+    //! \brief Row-major blocks, one per perforation.
+    std::vector<Scalar> B_;
+    std::vector<Scalar> C_;
+    //! \brief Row-major blocks, one per well.
+    std::vector<Scalar> invD_;
+};
+
+} // namespace Opm
+
+#endif // OPM_PACKEDSTANDARDWELLS_HEADER_INCLUDED
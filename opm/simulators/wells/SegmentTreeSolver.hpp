@@ -0,0 +1,320 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_SEGMENTTREESOLVER_HEADER_INCLUDED
+#define OPM_SEGMENTTREESOLVER_HEADER_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Opm
+{
+
+/// \brief Direct solver for block matrices whose sparsity pattern is a tree.
+///
+/// The segments of a multisegment well form a tree, and the matrix D of
+/// the well equations only couples every segment to its outlet and its
+/// inlets. Gaussian elimination of the segments from the leaves towards
+/// the top segment then creates no fill-in: eliminating a segment only
+/// changes the diagonal block of its parent, by the block Schur complement
+/// D_pp -= D_pc D_cc^-1 D_cp. Factorization and solves are thus linear in
+/// the number of segments. Pivoting is only done within the diagonal
+/// blocks, so factorize() fails if one of the pivot blocks is singular, and
+/// the caller should fall back to a general sparse solver then, as it
+/// should if analyze() finds a pattern that is not a tree.
+///
+/// \tparam Scalar     The scalar type of the blocks.
+/// \tparam blockSize  The number of rows and columns of the blocks.
+template <class Scalar, int blockSize>
+class SegmentTreeSolver
+{
+public:
+    /// \brief Find the elimination order from the sparsity pattern of D.
+    ///
+    /// The pattern is treated as symmetric. Every connected part of it
+    /// must be a tree, with the lowest row of the part as its root.
+    /// \return True if the pattern is a tree.
+    template <class Matrix>
+    bool analyze(const Matrix& D)
+    {
+        const std::size_t n = D.N();
+        std::vector<std::vector<int>> neighbours(n);
+        for (std::size_t row = 0; row < n; ++row) {
+            for (auto col = D[row].begin(); col != D[row].end(); ++col) {
+                const std::size_t j = col.index();
+                if (j != row) {
+                    neighbours[row].push_back(static_cast<int>(j));
+                    neighbours[j].push_back(static_cast<int>(row));
+                }
+            }
+        }
+        for (auto& adjacent : neighbours) {
+            std::sort(adjacent.begin(), adjacent.end());
+            adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+        }
+
+        // Breadth first search, so that every segment comes after its parent.
+        parent_.assign(n, -1);
+        order_.clear();
+        order_.reserve(n);
+        std::vector<bool> visited(n, false);
+        tree_ = true;
+        for (std::size_t root = 0; root < n && tree_; ++root) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            std::size_t next = order_.size();
+            order_.push_back(static_cast<int>(root));
+            for (; next < order_.size() && tree_; ++next) {
+                const int seg = order_[next];
+                for (const int adjacent : neighbours[seg]) {
+                    if (adjacent == parent_[seg]) {
+                        continue;
+                    }
+                    if (visited[adjacent]) {
+                        // A second path to the same segment.
+                        tree_ = false;
+                        break;
+                    }
+                    visited[adjacent] = true;
+                    parent_[adjacent] = seg;
+                    order_.push_back(adjacent);
+                }
+            }
+        }
+
+        invPivot_.resize(n);
+        lower_.resize(n);
+        upper_.resize(n);
+        status_ = tree_ ? Status::Pending : Status::Unusable;
+        return tree_;
+    }
+
+    /// \brief True if the last analyzed pattern is a tree.
+    bool isTree() const
+    {
+        return tree_;
+    }
+
+    /// \brief Mark the factorization as outdated, after the entries of D changed.
+    void invalidate()
+    {
+        if (tree_) {
+            status_ = Status::Pending;
+        }
+    }
+
+    /// \brief True if D must be factorized before the next solve.
+    bool pending() const
+    {
+        return status_ == Status::Pending;
+    }
+
+    /// \brief True if solve() can be used.
+    bool factorized() const
+    {
+        return status_ == Status::Factorized;
+    }
+
+    /// \brief Factorize D, which must have the pattern given to analyze().
+    /// \return False if the pattern is not a tree or a pivot block is singular.
+    template <class Matrix>
+    bool factorize(const Matrix& D)
+    {
+        if (!tree_) {
+            return false;
+        }
+        const std::size_t n = D.N();
+        // Diagonal blocks go to invPivot_, D_pc to lower_[c] and D_cp to upper_[c].
+        for (std::size_t seg = 0; seg < n; ++seg) {
+            invPivot_[seg] = Block{};
+            lower_[seg] = Block{};
+            upper_[seg] = Block{};
+        }
+        for (std::size_t row = 0; row < n; ++row) {
+            for (auto col = D[row].begin(); col != D[row].end(); ++col) {
+                const std::size_t j = col.index();
+                Block* target = nullptr;
+                if (j == row) {
+                    target = &invPivot_[row];
+                } else if (parent_[row] == static_cast<int>(j)) {
+                    target = &upper_[row];
+                } else {
+                    target = &lower_[j];
+                }
+                copyBlock(*col, *target);
+            }
+        }
+
+        // Children come after their parents in order_, so that the pivot of
+        // every segment is complete once it is reached backwards.
+        for (auto seg = order_.rbegin(); seg != order_.rend(); ++seg) {
+            if (!invert(invPivot_[*seg])) {
+                status_ = Status::Unusable;
+                return false;
+            }
+            const int parent = parent_[*seg];
+            if (parent >= 0) {
+                // lower = D_pc D_cc^-1, D_pp -= lower D_cp
+                const Block Dpc = lower_[*seg];
+                multiply(Dpc, invPivot_[*seg], lower_[*seg]);
+                Block update;
+                multiply(lower_[*seg], upper_[*seg], update);
+                for (int i = 0; i < blockSize; ++i) {
+                    for (int j = 0; j < blockSize; ++j) {
+                        invPivot_[parent][i][j] -= update[i][j];
+                    }
+                }
+            }
+        }
+        status_ = Status::Factorized;
+        return true;
+    }
+
+    /// \brief x = D^-1 x, with the last factorization of D.
+    template <class Vector>
+    void solve(Vector& x) const
+    {
+        // Forward elimination from the leaves to the roots.
+        for (auto seg = order_.rbegin(); seg != order_.rend(); ++seg) {
+            const int parent = parent_[*seg];
+            if (parent >= 0) {
+                const Block& L = lower_[*seg];
+                for (int i = 0; i < blockSize; ++i) {
+                    for (int j = 0; j < blockSize; ++j) {
+                        x[parent][i] -= L[i][j] * x[*seg][j];
+                    }
+                }
+            }
+        }
+        // Back substitution from the roots to the leaves.
+        for (const int seg : order_) {
+            std::array<Scalar, blockSize> rhs;
+            for (int i = 0; i < blockSize; ++i) {
+                rhs[i] = x[seg][i];
+            }
+            const int parent = parent_[seg];
+            if (parent >= 0) {
+                const Block& U = upper_[seg];
+                for (int i = 0; i < blockSize; ++i) {
+                    for (int j = 0; j < blockSize; ++j) {
+                        rhs[i] -= U[i][j] * x[parent][j];
+                    }
+                }
+            }
+            const Block& invPivot = invPivot_[seg];
+            for (int i = 0; i < blockSize; ++i) {
+                Scalar value = 0.0;
+                for (int j = 0; j < blockSize; ++j) {
+                    value += invPivot[i][j] * rhs[j];
+                }
+                x[seg][i] = value;
+            }
+        }
+    }
+
+private:
+    using Block = std::array<std::array<Scalar, blockSize>, blockSize>;
+
+    enum class Status { Pending, Factorized, Unusable };
+
+    template <class MatrixBlock>
+    static void copyBlock(const MatrixBlock& from, Block& to)
+    {
+        for (int i = 0; i < blockSize; ++i) {
+            for (int j = 0; j < blockSize; ++j) {
+                to[i][j] = from[i][j];
+            }
+        }
+    }
+
+    //! \brief c = a b
+    static void multiply(const Block& a, const Block& b, Block& c)
+    {
+        for (int i = 0; i < blockSize; ++i) {
+            for (int j = 0; j < blockSize; ++j) {
+                Scalar value = 0.0;
+                for (int k = 0; k < blockSize; ++k) {
+                    value += a[i][k] * b[k][j];
+                }
+                c[i][j] = value;
+            }
+        }
+    }
+
+    //! \brief Gauss-Jordan inversion with partial pivoting, false if a is singular.
+    static bool invert(Block& a)
+    {
+        Block inv{};
+        for (int i = 0; i < blockSize; ++i) {
+            inv[i][i] = 1.0;
+        }
+        for (int col = 0; col < blockSize; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < blockSize; ++row) {
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+                    pivot = row;
+                }
+            }
+            if (a[pivot][col] == 0.0 || !std::isfinite(a[pivot][col])) {
+                return false;
+            }
+            std::swap(a[pivot], a[col]);
+            std::swap(inv[pivot], inv[col]);
+            const Scalar scale = 1.0 / a[col][col];
+            for (int j = 0; j < blockSize; ++j) {
+                a[col][j] *= scale;
+                inv[col][j] *= scale;
+            }
+            for (int row = 0; row < blockSize; ++row) {
+                if (row == col || a[row][col] == 0.0) {
+                    continue;
+                }
+                const Scalar factor = a[row][col];
+                for (int j = 0; j < blockSize; ++j) {
+                    a[row][j] -= factor * a[col][j];
+                    inv[row][j] -= factor * inv[col][j];
+                }
+            }
+        }
+        a = inv;
+        return true;
+    }
+
+    //! \brief The segments, every one after its parent.
+    std::vector<int> order_;
+    //! \brief The parent of every segment in the tree, -1 for the roots.
+    std::vector<int> parent_;
+    //! \brief The inverted pivot block of every segment.
+    std::vector<Block> invPivot_;
+    //! \brief D_pc D_cc^-1 for every segment c with parent p.
+    std::vector<Block> lower_;
+    //! \brief D_cp for every segment c with parent p.
+    std::vector<Block> upper_;
+    bool tree_ = false;
+    Status status_ = Status::Unusable;
+};
+
+} // namespace Opm
+
+#endif // OPM_SEGMENTTREESOLVER_HEADER_INCLUDED
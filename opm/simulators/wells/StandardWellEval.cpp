@@ -1109,6 +1109,39 @@ init(std::vector<double>& perf_depth,
     }
 }
 
+template<class FluidSystem, class Indices, class Scalar>
+void
+StandardWellEval<FluidSystem,Indices,Scalar>::
+updateFixedSystem(const bool fixed_size)
+{
+    fixedSystem_.clear();
+    // B of a distributed well needs communication, see ParallelStandardWellB
+    if (!fixed_size || baseif_.parallelWellInfo().communication().size() > 1) {
+        return;
+    }
+    assert(numWellEq_ == numStaticWellEq);
+    fixedSystem_.addWell(this->invDuneD_[0][0]);
+    // B and C have the same sparsity pattern, the perforated cells
+    for (auto colB = this->duneB_[0].begin(), colC = this->duneC_[0].begin(),
+              endB = this->duneB_[0].end(); colB != endB; ++colB, ++colC)
+    {
+        assert(colB.index() == colC.index());
+        fixedSystem_.addPerforation(colB.index(), *colB, *colC);
+    }
+}
+
+template<class FluidSystem, class Indices, class Scalar>
+bool
+StandardWellEval<FluidSystem,Indices,Scalar>::
+addToPackedWells(PackedWells& packed) const
+{
+    if (fixedSystem_.numWells() == 0) {
+        return false;
+    }
+    packed.append(fixedSystem_);
+    return true;
+}
+
 #if HAVE_CUDA || HAVE_OPENCL
 template<class FluidSystem, class Indices, class Scalar>
 void
@@ -23,6 +23,7 @@
 #ifndef OPM_STANDARDWELL_EVAL_HEADER_INCLUDED
 #define OPM_STANDARDWELL_EVAL_HEADER_INCLUDED
 
+#include <opm/simulators/wells/PackedStandardWells.hpp>
 #include <opm/simulators/wells/StandardWellGeneric.hpp>
 
 #include <opm/material/densead/DynamicEvaluation.hpp>
@@ -95,6 +96,11 @@ public:
     using EvalWell = DenseAd::DynamicEvaluation<Scalar, numStaticWellEq + Indices::numEq + 1>;
     using Eval = DenseAd::Evaluation<Scalar, Indices::numEq>;
     using BVectorWell = typename StandardWellGeneric<Scalar>::BVectorWell;
+    using PackedWells = PackedStandardWells<Scalar, Indices::numEq, numStaticWellEq>;
+
+    /// add the C, D^-1 and B blocks of this well to the packed wells. Returns false, and adds
+    /// nothing, if the well has no fixed-size system and needs its own apply().
+    bool addToPackedWells(PackedWells& packed) const;
 
 #if HAVE_CUDA || HAVE_OPENCL
         /// add the contribution (C, D^-1, B matrices) of this Well to the WellContributions object
@@ -182,10 +188,18 @@ protected:
     void updateThp(WellState& well_state,
                    DeferredLogger& deferred_logger) const;
 
+    // copy C, D^-1 and B into fixedSystem_ after the assembly, if fixed_size is true and the
+    // well is not distributed, and otherwise leave it empty
+    void updateFixedSystem(const bool fixed_size);
+
     // total number of the well equations and primary variables
     // there might be extra equations be used, numWellEq will be updated during the initialization
     int numWellEq_ = numStaticWellEq;
 
+    // C, D^-1 and B in blocks of size numStaticWellEq x numEq, for the fixed-size kernels of
+    // apply() and the recovery of the well solution. Empty when the Dune matrices must be used.
+    PackedWells fixedSystem_;
+
     // the values for the primary varibles
     // based on different solutioin strategies, the wells can have different primary variables
     mutable std::vector<double> primary_variables_;
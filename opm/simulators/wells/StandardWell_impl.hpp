@@ -556,6 +556,13 @@ namespace Opm
         } catch( ... ) {
             OPM_DEFLOG_THROW(NumericalIssue,"Error when inverting local well equations for well " + name(), deferred_logger);
         }
+
+        // only the polymer injectivity adds well equations beyond numStaticWellEq
+        bool fixed_size = true;
+        if constexpr (has_polymermw) {
+            fixed_size = this->numWellEq_ == numStaticWellEq;
+        }
+        this->updateFixedSystem(fixed_size);
     }
 
 
@@ -1676,7 +1683,11 @@ namespace Opm
         // which is why we do not put the assembleWellEq here.
         BVectorWell dx_well(1);
         dx_well[0].resize(this->numWellEq_);
-        this->invDuneD_.mv(this->resWell_, dx_well);
+        if (this->fixedSystem_.numWells() > 0) {
+            this->fixedSystem_.solveWell(0, this->resWell_[0], dx_well[0]);
+        } else {
+            this->invDuneD_.mv(this->resWell_, dx_well);
+        }
 
         updateWellState(dx_well, well_state, deferred_logger);
     }
@@ -1712,6 +1723,11 @@ namespace Opm
             // Contributions are already in the matrix itself
             return;
         }
+        if (this->fixedSystem_.numWells() > 0) {
+            this->fixedSystem_.apply(x, Ax);
+            return;
+        }
+
         assert( this->Bx_.size() == this->duneB_.N() );
         assert( this->invDrw_.size() == this->invDuneD_.N() );
 
@@ -1738,6 +1754,12 @@ namespace Opm
     {
         if (!this->isOperableAndSolvable() && !this->wellIsStopped()) return;
 
+        if (this->fixedSystem_.numWells() > 0) {
+            // r = r - duneC_^T * invDuneD_ * resWell_
+            this->fixedSystem_.applyResidual(0, this->resWell_[0], r);
+            return;
+        }
+
         assert( this->invDrw_.size() == this->invDuneD_.N() );
 
         // invDrw_ = invDuneD_ * resWell_
@@ -1753,6 +1775,12 @@ namespace Opm
     {
         if (!this->isOperableAndSolvable() && !this->wellIsStopped()) return;
 
+        if (this->fixedSystem_.numWells() > 0) {
+            // xw = D^-1 * (resWell - B * x)
+            this->fixedSystem_.recoverSolution(0, x, this->resWell_[0], xw[0]);
+            return;
+        }
+
         BVectorWell resWell = this->resWell_;
         // resWell = resWell - B * x
         this->parallelB_.mmv(x, resWell);
@@ -89,6 +89,9 @@ public:
     // whether the well is operable
     bool isOperableAndSolvable() const;
 
+    // whether the last computed well potentials were negative
+    bool hasNegativePotentials() const;
+
     void initCompletions();
     void closeCompletions(const WellTestState& wellTestState);
 
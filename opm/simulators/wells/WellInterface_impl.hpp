@@ -452,15 +452,16 @@ namespace Opm
         if (!this->isOperableAndSolvable() && !this->wellIsStopped())
             return;
 
-        // keep a copy of the original well state
-        const WellState well_state0 = well_state;
+        // keep a copy of the original state of this well only, so that
+        // the wells can be solved at the same time
+        const SingleWellState ws0 = well_state.well(this->indexOfWell());
         const double dt = ebosSimulator.timeStepSize();
         const bool converged = iterateWellEquations(ebosSimulator, dt, well_state, group_state, deferred_logger);
         if (!converged) {
             const int max_iter = param_.max_welleq_iter_;
             deferred_logger.debug("Compute initial well solution for well " + this->name() + ". Failed to converge in "
                                   + std::to_string(max_iter) + " iterations");
-            well_state = well_state0;
+            well_state.well(this->indexOfWell()) = ws0;
         }
     }
 
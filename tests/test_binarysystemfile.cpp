@@ -0,0 +1,408 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/linalg/BinarySystemFile.hpp>
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/WriteSystemMatrixHelper.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#if HAVE_MPI
+#include <dune/istl/owneroverlapcopy.hh>
+#else
+#include <dune/istl/paamg/pinfo.hh>
+#endif
+
+#define BOOST_TEST_MODULE BinarySystemFileTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, 3, 3>>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 3>>;
+#if HAVE_MPI
+using Comm = Dune::OwnerOverlapCopyCommunication<int, int>;
+#else
+using Comm = Dune::Amg::SequentialInformation;
+#endif
+
+/// Tridiagonal matrix, with a well coupling the first and the last rows.
+Matrix testMatrix(const int n, const bool wells)
+{
+    Matrix matrix(n, n, 3, 0.4, Matrix::implicit);
+    for (int row = 0; row < n; ++row) {
+        if (wells) {
+            if (row == 0 || row == n - 1) {
+                matrix.entry(row, 0) = -0.5 - row;
+                matrix.entry(row, n - 1) = -0.25;
+            }
+            continue;
+        }
+        matrix.entry(row, row) = 4.0 + row;
+        if (row > 0) {
+            matrix.entry(row, row - 1) = -1.0;
+        }
+        if (row < n - 1) {
+            matrix.entry(row, row + 1) = -2.0;
+        }
+    }
+    matrix.compress();
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            (*col)[1][2] = 0.1 * row.index() + col.index();
+            (*col)[2][0] = -0.2 * (*col)[0][0];
+        }
+    }
+    return matrix;
+}
+
+void checkEqual(const Matrix& a, const Matrix& b)
+{
+    BOOST_REQUIRE_EQUAL(a.N(), b.N());
+    BOOST_REQUIRE_EQUAL(a.nonzeroes(), b.nonzeroes());
+    for (std::size_t row = 0; row < a.N(); ++row) {
+        BOOST_REQUIRE_EQUAL(a[row].size(), b[row].size());
+        for (auto ca = a[row].begin(), cb = b[row].begin(); ca != a[row].end(); ++ca, ++cb) {
+            BOOST_CHECK_EQUAL(ca.index(), cb.index());
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    BOOST_CHECK_EQUAL((*ca)[i][j], (*cb)[i][j]);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestBinarySystemRoundTrip)
+{
+    const int n = 17;
+    const auto matrix = testMatrix(n, false);
+    const auto wells = testMatrix(n, true);
+    Vector rhs(n);
+    for (int row = 0; row < n; ++row) {
+        rhs[row] = {1.0 * row, -2.0, 0.5 + row};
+    }
+    BOOST_CHECK(Opm::Details::isContiguous(matrix));
+
+    const std::string filename = "test_binarysystemfile.bin";
+    Opm::writeBinarySystem(filename, matrix, rhs, &wells, static_cast<const Comm*>(nullptr));
+    {
+        const Opm::MappedBinarySystem system(filename);
+        const auto& header = system.header();
+        BOOST_CHECK_EQUAL(header.blockSize, 3u);
+        BOOST_CHECK_EQUAL(header.numRows, static_cast<std::uint64_t>(n));
+        BOOST_CHECK_EQUAL(header.numRanks, 1);
+        BOOST_CHECK_EQUAL(header.values % Opm::BinarySystemHeader::alignment, 0u);
+        BOOST_REQUIRE(system.hasWells());
+
+        // The arrays can be used in place.
+        const auto* rowStart = system.array<std::uint64_t>(header.rowStart, n + 1);
+        BOOST_CHECK_EQUAL(rowStart[n], matrix.nonzeroes());
+        BOOST_CHECK_EQUAL(system.array<double>(header.values, 1)[0], matrix[0][0][0][0]);
+        BOOST_CHECK_THROW(system.array<double>(header.rhs, 3 * n + 1), std::runtime_error);
+        BOOST_CHECK_THROW(system.array<double>(header.rhs + 4, 1), std::runtime_error);
+
+        checkEqual(system.matrix<Matrix>(), matrix);
+        checkEqual(system.wells<Matrix>(), wells);
+        const auto rhsRead = system.rhs<Vector>();
+        BOOST_REQUIRE_EQUAL(rhsRead.size(), rhs.size());
+        for (int row = 0; row < n; ++row) {
+            for (int i = 0; i < 3; ++i) {
+                BOOST_CHECK_EQUAL(rhsRead[row][i], rhs[row][i]);
+            }
+        }
+    }
+    std::remove(filename.c_str());
+}
+
+/// Write a test system, change its bytes and write it back.
+void writeCorrupted(const std::string& filename, const std::function<void(std::vector<char>&)>& corrupt)
+{
+    const int n = 5;
+    const auto matrix = testMatrix(n, false);
+    Vector rhs(n);
+    rhs = 1.0;
+    Opm::writeBinarySystem(filename, matrix, rhs, static_cast<const Matrix*>(nullptr),
+                           static_cast<const Comm*>(nullptr));
+    std::vector<char> bytes;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    corrupt(bytes);
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+Opm::BinarySystemHeader readHeader(const std::vector<char>& bytes)
+{
+    Opm::BinarySystemHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return header;
+}
+
+void writeHeader(const Opm::BinarySystemHeader& header, std::vector<char>& bytes)
+{
+    std::memcpy(bytes.data(), &header, sizeof(header));
+}
+
+BOOST_AUTO_TEST_CASE(TestCorruptBinarySystem)
+{
+    const std::string filename = "test_binarysystemfile_corrupt.bin";
+
+    // The last array is cut off.
+    writeCorrupted(filename, [](std::vector<char>& bytes) { bytes.resize(bytes.size() - 8); });
+    BOOST_CHECK_THROW(Opm::MappedBinarySystem system(filename), std::runtime_error);
+
+    // Offsets beyond the end of the file, and misaligned.
+    writeCorrupted(filename, [](std::vector<char>& bytes) {
+        auto header = readHeader(bytes);
+        header.values = bytes.size();
+        writeHeader(header, bytes);
+    });
+    BOOST_CHECK_THROW(Opm::MappedBinarySystem system(filename), std::runtime_error);
+    writeCorrupted(filename, [](std::vector<char>& bytes) {
+        auto header = readHeader(bytes);
+        header.columns += 4;
+        writeHeader(header, bytes);
+    });
+    BOOST_CHECK_THROW(Opm::MappedBinarySystem system(filename), std::runtime_error);
+
+    // Sizes that overflow the offsets.
+    writeCorrupted(filename, [](std::vector<char>& bytes) {
+        auto header = readHeader(bytes);
+        header.nonzeroes = ~std::uint64_t(0) / 8;
+        writeHeader(header, bytes);
+    });
+    BOOST_CHECK_THROW(Opm::MappedBinarySystem system(filename), std::runtime_error);
+
+    // A column index out of range is found when building the matrix.
+    writeCorrupted(filename, [](std::vector<char>& bytes) {
+        const auto header = readHeader(bytes);
+        const std::uint64_t column = 1000;
+        std::memcpy(bytes.data() + header.columns, &column, sizeof(column));
+    });
+    {
+        const Opm::MappedBinarySystem system(filename);
+        BOOST_CHECK_THROW(system.matrix<Matrix>(), std::runtime_error);
+        BOOST_CHECK_NO_THROW(system.rhs<Vector>());
+    }
+    std::remove(filename.c_str());
+}
+
+namespace
+{
+
+using WellBlock = Dune::FieldMatrix<double, 3, 3>;
+
+/// A well in the Schur complement form of the simulator, with one block
+/// of well equations and a block of B and C for every perforated cell.
+struct TestWell
+{
+    std::vector<int> perforatedCells;
+    std::vector<WellBlock> B;
+    std::vector<WellBlock> C;
+    WellBlock invD;
+
+    const std::vector<int>& cells() const
+    {
+        return perforatedCells;
+    }
+
+    // Ax -= C^T D^-1 B x, which accumulates into Ax as in the simulator.
+    void apply(const Vector& x, Vector& Ax) const
+    {
+        Dune::FieldVector<double, 3> Bx(0.0);
+        for (std::size_t perf = 0; perf < perforatedCells.size(); ++perf) {
+            B[perf].umv(x[perforatedCells[perf]], Bx);
+        }
+        Dune::FieldVector<double, 3> invDBx(0.0);
+        invD.mv(Bx, invDBx);
+        for (std::size_t perf = 0; perf < perforatedCells.size(); ++perf) {
+            C[perf].mmtv(invDBx, Ax[perforatedCells[perf]]);
+        }
+    }
+
+    template <class SparseMatrixAdapter>
+    void addWellContributions(SparseMatrixAdapter& jacobian) const
+    {
+        for (std::size_t i = 0; i < perforatedCells.size(); ++i) {
+            for (std::size_t j = 0; j < perforatedCells.size(); ++j) {
+                Matrix::block_type block(0.0);
+                for (int row = 0; row < 3; ++row) {
+                    for (int col = 0; col < 3; ++col) {
+                        for (int p = 0; p < 3; ++p) {
+                            for (int q = 0; q < 3; ++q) {
+                                block[row][col] -= C[i][p][row] * invD[p][q] * B[j][q][col];
+                            }
+                        }
+                    }
+                }
+                jacobian.addToBlock(perforatedCells[i], perforatedCells[j], block);
+            }
+        }
+    }
+};
+
+struct TestWellModel
+{
+    std::vector<std::shared_ptr<TestWell>> wells;
+
+    const std::vector<std::shared_ptr<TestWell>>& localNonshutWells() const
+    {
+        return wells;
+    }
+
+    void apply(const Vector& x, Vector& Ax) const
+    {
+        for (const auto& well : wells) {
+            well->apply(x, Ax);
+        }
+    }
+
+    template <class SparseMatrixAdapter>
+    void addWellContributions(SparseMatrixAdapter& jacobian) const
+    {
+        for (const auto& well : wells) {
+            well->addWellContributions(jacobian);
+        }
+    }
+};
+
+/// The parts of the sparse matrix adapter of the simulator used for the wells.
+class TestSparseMatrixAdapter
+{
+public:
+    template <class Set>
+    void reserve(const std::vector<Set>& sparsityList)
+    {
+        const std::size_t numRows = sparsityList.size();
+        matrix_ = std::make_unique<Matrix>(numRows, numRows, Matrix::random);
+        for (std::size_t row = 0; row < numRows; ++row) {
+            matrix_->setrowsize(row, sparsityList[row].size());
+        }
+        matrix_->endrowsizes();
+        for (std::size_t row = 0; row < numRows; ++row) {
+            for (const auto col : sparsityList[row]) {
+                matrix_->addindex(row, col);
+            }
+        }
+        matrix_->endindices();
+    }
+
+    void clear()
+    {
+        *matrix_ = 0.0;
+    }
+
+    void addToBlock(const int row, const int col, const Matrix::block_type& block)
+    {
+        (*matrix_)[row][col] += block;
+    }
+
+    const Matrix& istlMatrix() const
+    {
+        return *matrix_;
+    }
+
+private:
+    std::unique_ptr<Matrix> matrix_;
+};
+
+std::shared_ptr<TestWell> makeWell(const std::vector<int>& cells, double value)
+{
+    auto next = [&value]() {
+        value = value * 1.37 - 0.61;
+        if (value > 2.0 || value < -2.0) {
+            value *= 0.1;
+        }
+        return value;
+    };
+    auto well = std::make_shared<TestWell>();
+    well->perforatedCells = cells;
+    well->B.resize(cells.size());
+    well->C.resize(cells.size());
+    for (std::size_t perf = 0; perf < cells.size(); ++perf) {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                well->B[perf][i][j] = next();
+                well->C[perf][i][j] = next();
+            }
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            well->invD[i][j] = next() + (i == j ? 2.0 : 0.0);
+        }
+    }
+    return well;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestAssembleWellMatrix)
+{
+    // Two wells that share cell 5, so that their contributions add up there.
+    const int n = 12;
+    TestWellModel wellModel;
+    wellModel.wells.push_back(makeWell({0, 5, 11}, 0.4));
+    wellModel.wells.push_back(makeWell({7, 5}, -0.3));
+
+    TestSparseMatrixAdapter wells;
+    Opm::Helper::assembleWellMatrix(wellModel, n, wells);
+    const Matrix& matrix = wells.istlMatrix();
+    BOOST_REQUIRE_EQUAL(matrix.N(), static_cast<std::size_t>(n));
+    BOOST_CHECK_EQUAL(matrix[0].size(), 3u);
+    BOOST_CHECK_EQUAL(matrix[5].size(), 4u);
+    BOOST_CHECK_EQUAL(matrix[7].size(), 2u);
+    BOOST_CHECK_EQUAL(matrix[3].size(), 0u);
+
+    // The matrix must act like the accumulating well operator.
+    Vector x(n);
+    for (int row = 0; row < n; ++row) {
+        x[row] = {1.0 + row, -0.5 * row, 2.0};
+    }
+    Vector expected(n);
+    expected = 0.0;
+    wellModel.apply(x, expected);
+    Vector y(n);
+    y = 0.0;
+    matrix.umv(x, y);
+    for (int row = 0; row < n; ++row) {
+        for (int i = 0; i < 3; ++i) {
+            BOOST_CHECK_SMALL(y[row][i] - expected[row][i], 1e-9);
+        }
+    }
+    BOOST_CHECK_GT(expected[5].two_norm(), 0.0);
+}
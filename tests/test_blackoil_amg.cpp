@@ -300,8 +300,8 @@ void runBlackoilAmgLaplace()
     using namespace std::string_literals;
     Opm::PropertyTree prm;
     prm.put("type", "amg"s);
-    std::function<Vector()> weights = [&mat]() {
-        return Opm::Amg::getQuasiImpesWeights<BCRSMat, Vector>(mat, 0, false);
+    std::function<void(Vector&)> weights = [&mat](Vector& w) {
+        Opm::Amg::getQuasiImpesWeights(mat, 0, false, w);
     };
     auto amg = Opm::PreconditionerFactory<Operator, Communication>::create(fop, prm, weights, comm);
 
@@ -0,0 +1,135 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/linalg/BlockSpMV.hpp>
+
+#define BOOST_TEST_MODULE BlockSpMVTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+namespace
+{
+
+/// A 5-point stencil matrix on an n x n grid with non-symmetric blocks.
+template <int N>
+Dune::BCRSMatrix<Dune::FieldMatrix<double, N, N>> buildMatrix(const int n)
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, N, N>>;
+    const int numCells = n * n;
+    Matrix A(numCells, numCells, 5 * numCells, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const int cell = row.index();
+        const int i = cell % n;
+        const int j = cell / n;
+        if (j > 0) row.insert(cell - n);
+        if (i > 0) row.insert(cell - 1);
+        row.insert(cell);
+        if (i < n - 1) row.insert(cell + 1);
+        if (j < n - 1) row.insert(cell + n);
+    }
+    for (auto row = A.begin(); row != A.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            for (int ii = 0; ii < N; ++ii) {
+                for (int jj = 0; jj < N; ++jj) {
+                    (*col)[ii][jj] = (col.index() == row.index() ? 4.0 : -1.0)
+                        + 0.01 * (ii - 2 * jj) + 1e-3 * (row.index() % 13);
+                }
+            }
+        }
+    }
+    return A;
+}
+
+template <int N>
+void testAgainstDune(const int n)
+{
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, N>>;
+    const auto A = buildMatrix<N>(n);
+    Vector x(A.N());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        for (int j = 0; j < N; ++j) {
+            x[i][j] = 1.0 + 1e-2 * ((i + 3 * j) % 17);
+        }
+    }
+
+    Vector expected(A.N()), y(A.N());
+    A.mv(x, expected);
+    y = 42.0;
+    Opm::blockSpMV(A, x, y, A.N());
+    for (std::size_t i = 0; i < A.N(); ++i) {
+        for (int j = 0; j < N; ++j) {
+            BOOST_CHECK_CLOSE(y[i][j], expected[i][j], 1e-12);
+        }
+    }
+
+    const double alpha = -0.7;
+    expected = 1.5;
+    A.usmv(alpha, x, expected);
+    y = 1.5;
+    Opm::blockSpMVScaleAdd(alpha, A, x, y, A.N());
+    for (std::size_t i = 0; i < A.N(); ++i) {
+        for (int j = 0; j < N; ++j) {
+            BOOST_CHECK_CLOSE(y[i][j], expected[i][j], 1e-12);
+        }
+    }
+
+    // Rows after numRows are left alone.
+    y = 3.0;
+    Opm::blockSpMV(A, x, y, A.N() / 2);
+    for (std::size_t i = A.N() / 2; i < A.N(); ++i) {
+        for (int j = 0; j < N; ++j) {
+            BOOST_CHECK_EQUAL(y[i][j], 3.0);
+        }
+    }
+}
+
+} // anonymous namespace
+
+// The small grids stay below the threshold for threading, the large ones above it.
+BOOST_AUTO_TEST_CASE(BlockSize1)
+{
+    testAgainstDune<1>(4);
+    testAgainstDune<1>(40);
+}
+
+BOOST_AUTO_TEST_CASE(BlockSize2)
+{
+    testAgainstDune<2>(4);
+    testAgainstDune<2>(40);
+}
+
+BOOST_AUTO_TEST_CASE(BlockSize3)
+{
+    testAgainstDune<3>(4);
+    testAgainstDune<3>(40);
+}
+
+BOOST_AUTO_TEST_CASE(BlockSize4)
+{
+    testAgainstDune<4>(4);
+    testAgainstDune<4>(40);
+}
@@ -31,14 +31,20 @@
 #include <opm/simulators/linalg/FlexibleSolver.hpp>
 #include <opm/simulators/linalg/getQuasiImpesWeights.hpp>
 #include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/PreconditionerReusePolicy.hpp>
 #include <opm/simulators/linalg/PropertyTree.hpp>
+#include <opm/simulators/linalg/RecyclingGMResSolver.hpp>
 
 #include <dune/common/fmatrix.hh>
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/matrixmarket.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 
 template <int bz>
@@ -69,9 +75,9 @@ testSolver(const Opm::PropertyTree& prm, const std::string& matrix_filename, con
     if(prm.get<std::string>("preconditioner.type") == "cprt"){
         transpose = true;
     }
-    auto wc = [&matrix, transpose]()
+    auto wc = [&matrix, transpose](Vector& weights)
     {
-        return Opm::Amg::getQuasiImpesWeights<Matrix, Vector>(matrix, 1, transpose);
+        Opm::Amg::getQuasiImpesWeights(matrix, 1, transpose, weights);
     };
 
     using SeqOperatorType = Dune::MatrixAdapter<Matrix, Vector, Vector>;
@@ -125,6 +131,293 @@ BOOST_AUTO_TEST_CASE(TestFlexibleSolver)
     }
 }
 
+BOOST_AUTO_TEST_CASE(TestKrylovVariants)
+{
+    // The pipelined and recycling solvers must reproduce the solution of the standard ones.
+    const int bz = 3;
+    Opm::PropertyTree prm;
+    prm.put("tol", 1e-12);
+    prm.put("maxiter", 200);
+    prm.put("verbosity", 0);
+    prm.put("restart", 5);
+    prm.put("preconditioner.type", std::string("ILU0"));
+    prm.put("solver", std::string("bicgstab"));
+    const auto reference = testSolver<bz>(prm, "matr33.txt", "rhs3.txt");
+    double scale = 0.0;
+    for (const auto& block : reference) {
+        scale = std::max(scale, block.infinity_norm());
+    }
+
+    for (const std::string solver : {"pipelined_bicgstab", "pipelined_gmres", "recycling_gmres"}) {
+        prm.put("solver", solver);
+        const auto sol = testSolver<bz>(prm, "matr33.txt", "rhs3.txt");
+        BOOST_REQUIRE_EQUAL(sol.size(), reference.size());
+        for (size_t i = 0; i < sol.size(); ++i) {
+            for (int row = 0; row < bz; ++row) {
+                BOOST_CHECK_SMALL(sol[i][row] - reference[i][row], 1e-8 * scale);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestRecyclingAcrossSolves)
+{
+    // Consecutive solves sharing one recycled subspace, as with the
+    // Jacobians of successive Newton iterations, must give correct
+    // solutions without more iterations than the first solve.
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, 1, 1>>;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 1>>;
+    const int n = 12;
+    Matrix matrix(n * n, n * n, 5 * n * n, Matrix::row_wise);
+    for (auto row = matrix.createbegin(); row != matrix.createend(); ++row) {
+        const int i = row.index() % n;
+        const int j = row.index() / n;
+        if (j > 0) {
+            row.insert(row.index() - n);
+        }
+        if (i > 0) {
+            row.insert(row.index() - 1);
+        }
+        row.insert(row.index());
+        if (i + 1 < n) {
+            row.insert(row.index() + 1);
+        }
+        if (j + 1 < n) {
+            row.insert(row.index() + n);
+        }
+    }
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            // Convection-diffusion, so that the matrix is not symmetric.
+            const double offDiagonal = col.index() + 1 == row.index() ? -1.3 : -0.7;
+            *col = col.index() == row.index() ? 6.0 : offDiagonal;
+        }
+    }
+    Vector expected(matrix.N());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = 1.0 + std::sin(0.1 * i);
+    }
+
+    Opm::PropertyTree prm;
+    prm.put("tol", 1e-10);
+    prm.put("maxiter", 400);
+    prm.put("verbosity", 0);
+    prm.put("restart", 5);
+    prm.put("recycle", 10);
+    prm.put("preconditioner.type", std::string("Jac"));
+    prm.put("solver", std::string("recycling_gmres"));
+    using SeqOperatorType = Dune::MatrixAdapter<Matrix, Vector, Vector>;
+    SeqOperatorType op(matrix);
+
+    // Solve with a new solver, as the simulator does after a rebuild.
+    const auto solve = [&](const std::shared_ptr<Dune::RecycleSpace<Vector>>& space) {
+        Dune::FlexibleSolver<SeqOperatorType> solver(op, prm, std::function<void(Vector&)>(), 0);
+        solver.setRecycleSpace(space);
+        Vector b(matrix.N());
+        matrix.mv(expected, b);
+        Vector x(matrix.N());
+        x = 0.0;
+        Dune::InverseOperatorResult res;
+        solver.apply(x, b, res);
+        BOOST_CHECK(res.converged);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            BOOST_CHECK_CLOSE(x[i][0], expected[i][0], 1e-6);
+        }
+        return res.iterations;
+    };
+
+    const auto space = std::make_shared<Dune::RecycleSpace<Vector>>();
+    const int first = solve(space);
+    BOOST_CHECK(!space->directions.empty());
+    const int second = solve(space);
+    BOOST_CHECK_LE(second, first);
+
+    // New values in the same pattern, as after the next assembly.
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        (*row)[row.index()] *= 1.02;
+    }
+    const int changed = solve(space);
+    BOOST_CHECK_LE(changed, first);
+    const int fresh = solve(std::make_shared<Dune::RecycleSpace<Vector>>());
+    BOOST_CHECK_LE(changed, fresh);
+}
+
+BOOST_AUTO_TEST_CASE(TestMixedPrecision)
+{
+    // Iterative refinement around a single precision solve must reach the double precision solution.
+    const int bz = 3;
+    Opm::PropertyTree prm;
+    prm.put("tol", 1e-10);
+    prm.put("maxiter", 200);
+    prm.put("verbosity", 0);
+    prm.put("preconditioner.type", std::string("ILU0"));
+    prm.put("solver", std::string("bicgstab"));
+    const auto reference = testSolver<bz>(prm, "matr33.txt", "rhs3.txt");
+    double scale = 0.0;
+    for (const auto& block : reference) {
+        scale = std::max(scale, block.infinity_norm());
+    }
+
+    prm.put("precision", std::string("mixed"));
+    const auto sol = testSolver<bz>(prm, "matr33.txt", "rhs3.txt");
+    BOOST_REQUIRE_EQUAL(sol.size(), reference.size());
+    for (size_t i = 0; i < sol.size(); ++i) {
+        for (int row = 0; row < bz; ++row) {
+            BOOST_CHECK_SMALL(sol[i][row] - reference[i][row], 1e-6 * scale);
+        }
+    }
+}
+
+template <int bz>
+void readSystem(Dune::BCRSMatrix<Opm::MatrixBlock<double, bz, bz>>& matrix,
+                Dune::BlockVector<Dune::FieldVector<double, bz>>& rhs)
+{
+    std::ifstream mfile("matr33.txt");
+    if (!mfile) {
+        throw std::runtime_error("Could not read matrix file");
+    }
+    using M = Dune::BCRSMatrix<Dune::FieldMatrix<double, bz, bz>>;
+    readMatrixMarket(reinterpret_cast<M&>(matrix), mfile); // Hack to avoid hassle
+    std::ifstream rhsfile("rhs3.txt");
+    if (!rhsfile) {
+        throw std::runtime_error("Could not read rhs file");
+    }
+    readMatrixMarket(rhs, rhsfile);
+}
+
+BOOST_AUTO_TEST_CASE(TestMixedPrecisionChangedMatrix)
+{
+    // The single precision copy of the matrix must follow new matrix
+    // values, also when the preconditioner is not updated.
+    const int bz = 3;
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, bz, bz>>;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bz>>;
+    Matrix matrix;
+    Vector rhs;
+    readSystem<bz>(matrix, rhs);
+
+    Opm::PropertyTree prm;
+    prm.put("tol", 1e-10);
+    prm.put("maxiter", 200);
+    prm.put("verbosity", 0);
+    prm.put("preconditioner.type", std::string("ILU0"));
+    prm.put("solver", std::string("bicgstab"));
+    prm.put("precision", std::string("mixed"));
+    using SeqOperatorType = Dune::MatrixAdapter<Matrix, Vector, Vector>;
+    SeqOperatorType op(matrix);
+    Dune::FlexibleSolver<SeqOperatorType> solver(op, prm, std::function<void(Vector&)>(), 1);
+
+    Vector reference(rhs.size());
+    reference = 0.0;
+    Vector b = rhs;
+    Dune::InverseOperatorResult res;
+    solver.apply(reference, b, res);
+    BOOST_CHECK(res.converged);
+    double scale = 0.0;
+    for (const auto& block : reference) {
+        scale = std::max(scale, block.infinity_norm());
+    }
+
+    matrix *= 2.0;
+    Vector x(rhs.size());
+    x = 0.0;
+    b = rhs;
+    solver.apply(x, b, res);
+    BOOST_CHECK(res.converged);
+    for (size_t i = 0; i < x.size(); ++i) {
+        for (int row = 0; row < bz; ++row) {
+            BOOST_CHECK_SMALL(x[i][row] - 0.5 * reference[i][row], 1e-6 * scale);
+        }
+    }
+}
+
+/// Collective communication of a single process.
+struct SerialComm
+{
+    template <class T>
+    int sum(T*, int) const
+    {
+        return 0;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(TestMixedPrecisionReusePolicy)
+{
+    // Drive the mixed precision solver by the reuse policy, as the
+    // simulator does: a new solver at a rebuild, a numeric update of the
+    // preconditioner, or the preconditioner of an earlier matrix as it is.
+    const int bz = 3;
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, bz, bz>>;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bz>>;
+    using SeqOperatorType = Dune::MatrixAdapter<Matrix, Vector, Vector>;
+    using Action = Opm::PreconditionerReusePolicy::Action;
+    Matrix original;
+    Vector rhs;
+    readSystem<bz>(original, rhs);
+
+    Opm::PropertyTree prm;
+    prm.put("tol", 1e-10);
+    prm.put("maxiter", 200);
+    prm.put("verbosity", 0);
+    prm.put("preconditioner.type", std::string("ILU0"));
+    prm.put("solver", std::string("bicgstab"));
+    prm.put("precision", std::string("mixed"));
+
+    // The solution of the unscaled system.
+    Vector reference(rhs.size());
+    {
+        Matrix matrix = original;
+        SeqOperatorType op(matrix);
+        Dune::FlexibleSolver<SeqOperatorType> solver(op, prm, std::function<void(Vector&)>(), 1);
+        reference = 0.0;
+        Vector b = rhs;
+        Dune::InverseOperatorResult res;
+        solver.apply(reference, b, res);
+        BOOST_REQUIRE(res.converged);
+    }
+    double scale = 0.0;
+    for (const auto& block : reference) {
+        scale = std::max(scale, block.infinity_norm());
+    }
+
+    Opm::PreconditionerReusePolicy policy(0.02, 0.2);
+    const SerialComm comm;
+    Matrix matrix = original;
+    SeqOperatorType op(matrix);
+    std::unique_ptr<Dune::FlexibleSolver<SeqOperatorType>> solver;
+    const std::vector<double> factors = {1.0, 1.01, 1.05, 1.06, 2.0, 2.01};
+    const std::vector<Action> expected = {Action::Rebuild, Action::Reuse, Action::Update,
+                                          Action::Reuse, Action::Rebuild, Action::Reuse};
+    double previous = 1.0;
+    for (std::size_t step = 0; step < factors.size(); ++step) {
+        // Scale in place, so that the operator keeps seeing the same matrix.
+        matrix *= factors[step] / previous;
+        previous = factors[step];
+        std::vector<std::vector<double>> samples(1);
+        Opm::PreconditionerReusePolicy::sampleDiagonal(matrix, 1000, samples[0]);
+        const Action action = policy.decide(samples, !solver, comm);
+        BOOST_CHECK(action == expected[step]);
+        if (action == Action::Rebuild) {
+            solver = std::make_unique<Dune::FlexibleSolver<SeqOperatorType>>(op, prm, std::function<void(Vector&)>(), 1);
+        } else if (action == Action::Update) {
+            solver->preconditioner().update();
+        }
+
+        Vector x(rhs.size());
+        x = 0.0;
+        Vector b = rhs;
+        Dune::InverseOperatorResult res;
+        solver->apply(x, b, res);
+        BOOST_CHECK(res.converged);
+        policy.record(res.iterations, res.converged);
+        for (size_t i = 0; i < x.size(); ++i) {
+            for (int row = 0; row < bz; ++row) {
+                BOOST_CHECK_SMALL(x[i][row] - reference[i][row] / factors[step], 1e-6 * scale);
+            }
+        }
+    }
+}
+
 #else
 
 // Do nothing if we do not have at least Dune 2.6.
@@ -0,0 +1,116 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/linalg/LinearSolverAutoTuner.hpp>
+
+#define BOOST_TEST_MODULE LinearSolverAutoTunerTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<Opm::LinearSolverAutoTuner::Candidate> candidates()
+{
+    std::vector<Opm::LinearSolverAutoTuner::Candidate> result;
+    for (const std::string name : {"ilu0", "cpr_quasiimpes", "amg"}) {
+        Opm::PropertyTree prm;
+        prm.put("preconditioner.type", name);
+        result.push_back({name, prm});
+    }
+    return result;
+}
+
+/// Solve with the candidate chosen for every report step, using the given times.
+std::vector<std::string> run(Opm::LinearSolverAutoTuner& tuner,
+                             const std::map<std::string, double>& times,
+                             const std::vector<int>& reportSteps,
+                             const std::string& failing = "")
+{
+    std::vector<std::string> used;
+    for (const int step : reportSteps) {
+        tuner.select(step);
+        const auto& name = tuner.current().name;
+        used.push_back(name);
+        tuner.record(times.at(name), name != failing);
+    }
+    return used;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestTrialsAndLockIn)
+{
+    Opm::LinearSolverAutoTuner tuner(candidates(), 2, 0);
+    const std::map<std::string, double> times{{"ilu0", 3.0}, {"cpr_quasiimpes", 1.0}, {"amg", 2.0}};
+    const auto used = run(tuner, times, {0, 0, 0, 0, 0, 0, 1, 1, 5});
+
+    // Every candidate is tried on consecutive solves, then the fastest is kept.
+    const std::vector<std::string> expected{"ilu0", "ilu0", "cpr_quasiimpes",
+                                            "cpr_quasiimpes", "amg", "amg",
+                                            "cpr_quasiimpes", "cpr_quasiimpes", "cpr_quasiimpes"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(used.begin(), used.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!tuner.trialing());
+    BOOST_CHECK_EQUAL(tuner.candidates()[1].solves, 2);
+    BOOST_CHECK_EQUAL(tuner.current().prm.get<std::string>("preconditioner.type"), "cpr_quasiimpes");
+}
+
+BOOST_AUTO_TEST_CASE(TestFailureEndsTrial)
+{
+    Opm::LinearSolverAutoTuner tuner(candidates(), 3, 0);
+    const std::map<std::string, double> times{{"ilu0", 3.0}, {"cpr_quasiimpes", 1.0}, {"amg", 2.0}};
+    const auto used = run(tuner, times, {0, 0, 0, 0, 0, 0, 0, 0}, "ilu0");
+
+    // Only one solve is spent on a candidate that does not converge.
+    const std::vector<std::string> expected{"ilu0", "cpr_quasiimpes", "cpr_quasiimpes", "cpr_quasiimpes",
+                                            "amg", "amg", "amg", "cpr_quasiimpes"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(used.begin(), used.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!tuner.trialing());
+}
+
+BOOST_AUTO_TEST_CASE(TestFailureAndReevaluation)
+{
+    Opm::LinearSolverAutoTuner tuner(candidates(), 1, 3);
+    std::map<std::string, double> times{{"ilu0", 3.0}, {"cpr_quasiimpes", 1.0}, {"amg", 2.0}};
+
+    // The fastest candidate does not converge and is disqualified.
+    auto used = run(tuner, times, {0, 0, 0, 1}, "cpr_quasiimpes");
+    BOOST_CHECK_EQUAL(used.back(), "amg");
+    BOOST_CHECK(tuner.justLockedIn());
+    run(tuner, times, {2});
+    BOOST_CHECK(!tuner.justLockedIn());
+
+    // Three report steps after the choice the trials are repeated,
+    // starting with the candidate in use.
+    times["amg"] = 5.0;
+    used = run(tuner, times, {4, 4, 4});
+    BOOST_CHECK(tuner.trialing());
+    const std::vector<std::string> expected{"amg", "ilu0", "cpr_quasiimpes"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(used.begin(), used.end(), expected.begin(), expected.end());
+    used = run(tuner, times, {4});
+    BOOST_CHECK(!tuner.trialing());
+    BOOST_CHECK_EQUAL(used.back(), "cpr_quasiimpes");
+}
@@ -9,8 +9,15 @@
 #include<dune/istl/bvector.hh>
 #include<dune/common/fmatrix.hh>
 #include<dune/common/fvector.hh>
+#include<opm/simulators/linalg/BISAI.hpp>
+#include<opm/simulators/linalg/BlockJacobiILU0.hpp>
+#include<opm/simulators/linalg/ChowPatelILU0.hpp>
 #include<opm/simulators/linalg/ParallelOverlappingILU0.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <boost/test/unit_test.hpp>
 #include <boost/version.hpp>
 #if BOOST_VERSION / 100000 == 1 && BOOST_VERSION / 100 % 1000 < 71
@@ -200,3 +207,371 @@ BOOST_AUTO_TEST_CASE(MILULaplace4)
 {
     test<4>();
 }
+
+template<int bsize>
+void testLevelScheduling()
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, bsize, bsize> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bsize> >;
+    // The levels of the Laplacian are its anti-diagonals, so with N = 200
+    // most of them have more than the 64 rows needed for threading.
+    std::size_t N = 200;
+    Matrix A;
+    setupLaplacian(A, N);
+#ifdef _OPENMP
+    const int numThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> ilu(A, 0, 1.0, Opm::MILU_VARIANT::ILU);
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> levelIlu(A, 0, 1.0, Opm::MILU_VARIANT::ILU,
+                                                                  false, true, true);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 7);
+    }
+    v1 = 0;
+    v2 = 0;
+    ilu.apply(v1, d);
+    levelIlu.apply(v2, d);
+#ifdef _OPENMP
+    omp_set_num_threads(numThreads);
+#endif
+
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        for (int j = 0; j < bsize; ++j)
+        {
+            BOOST_CHECK_CLOSE(v1[i][j], v2[i][j], 1e-12);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ILULevelScheduling1)
+{
+    testLevelScheduling<1>();
+}
+
+BOOST_AUTO_TEST_CASE(ILULevelScheduling3)
+{
+    testLevelScheduling<3>();
+}
+
+template<int bsize>
+void testFloatStorage(Opm::ILUStorage storage)
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, bsize, bsize> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bsize> >;
+    std::size_t N = 32;
+    Matrix A;
+    setupLaplacian(A, N);
+
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> ilu(A, 0, 1.0, Opm::MILU_VARIANT::ILU);
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> floatIlu(A, 0, 1.0, Opm::MILU_VARIANT::ILU,
+                                                                  false, true, false, storage);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 7);
+    }
+    v1 = 0;
+    v2 = 0;
+    ilu.apply(v1, d);
+    floatIlu.apply(v2, d);
+
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        for (int j = 0; j < bsize; ++j)
+        {
+            // Only the factors are rounded to single precision.
+            BOOST_CHECK_CLOSE(v1[i][j], v2[i][j], 1e-3);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ILUFloatStorage1)
+{
+    testFloatStorage<1>(Opm::ILUStorage::Float);
+    testFloatStorage<1>(Opm::ILUStorage::FloatAll);
+}
+
+BOOST_AUTO_TEST_CASE(ILUFloatStorage3)
+{
+    testFloatStorage<3>(Opm::ILUStorage::Float);
+    testFloatStorage<3>(Opm::ILUStorage::FloatAll);
+}
+
+template<int bsize>
+void testChowPatel()
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, bsize, bsize> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bsize> >;
+    // On a small grid enough sweeps reproduce the exact ILU0 factorization
+    // and triangular solves.
+    std::size_t N = 8;
+    Matrix A;
+    setupLaplacian(A, N);
+
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> ilu(A, 0, 1.0, Opm::MILU_VARIANT::ILU);
+    Opm::ChowPatelILU0<Matrix, Vector, Vector> chowPatel(A, 4*N, 2*N, 1.0);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 7);
+    }
+    v1 = 0;
+    v2 = 0;
+    ilu.apply(v1, d);
+    chowPatel.apply(v2, d);
+
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        for (int j = 0; j < bsize; ++j)
+        {
+            BOOST_CHECK_CLOSE(v1[i][j], v2[i][j], 1e-8);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ChowPatelILU1)
+{
+    testChowPatel<1>();
+}
+
+BOOST_AUTO_TEST_CASE(ChowPatelILU3)
+{
+    testChowPatel<3>();
+}
+
+template<int bsize>
+void testBISAI()
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, bsize, bsize> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bsize> >;
+    // With a full sparsity pattern both the ILU0 decomposition and the
+    // approximate inverses of its factors are exact.
+    const std::size_t N = 6;
+    Matrix A(N, N, N*N, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row)
+    {
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            row.insert(j);
+        }
+    }
+    for (auto row = A.begin(); row != A.end(); ++row)
+    {
+        for (auto col = row->begin(); col != row->end(); ++col)
+        {
+            for (int ii = 0; ii < bsize; ++ii)
+            {
+                for (int jj = 0; jj < bsize; ++jj)
+                {
+                    (*col)[ii][jj] = 1.0 / (1.0 + row.index() + 2*col.index() + ii + jj);
+                    if (row.index() == col.index() && ii == jj)
+                    {
+                        (*col)[ii][jj] += 2.0*N*bsize;
+                    }
+                }
+            }
+        }
+    }
+
+    Opm::BISAI<Matrix, Vector, Vector> bisai(A, 1.0);
+    Vector d(A.N()), v(A.N()), r(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 4);
+    }
+    v = 0;
+    bisai.apply(v, d);
+    r = d;
+    A.mmv(v, r);
+    BOOST_CHECK_SMALL(r.two_norm(), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(BISAI1)
+{
+    testBISAI<1>();
+}
+
+BOOST_AUTO_TEST_CASE(BISAI3)
+{
+    testBISAI<3>();
+}
+
+template<int bsize>
+void testBlockJacobiILU0()
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, bsize, bsize> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, bsize> >;
+    // Block-Jacobi ILU0 equals ILU0 of the matrix without the couplings
+    // between the blocks, which are not contiguous here.
+    std::size_t N = 8;
+    Matrix A;
+    setupLaplacian(A, N);
+    std::vector<int> partition(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        partition[i] = (i / 5) % 3;
+    }
+    Matrix decoupled = A;
+    for (auto row = decoupled.begin(); row != decoupled.end(); ++row)
+    {
+        for (auto col = row->begin(); col != row->end(); ++col)
+        {
+            if (partition[row.index()] != partition[col.index()])
+            {
+                *col = 0.0;
+            }
+        }
+    }
+
+    Opm::ParallelOverlappingILU0<Matrix, Vector, Vector> ilu(decoupled, 0, 0.9, Opm::MILU_VARIANT::ILU);
+    Opm::BlockJacobiILU0<Matrix, Vector, Vector> blockJacobi(A, partition, 0.9);
+    BOOST_CHECK_EQUAL(blockJacobi.numBlocks(), 3u);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 7);
+    }
+    v1 = 0;
+    v2 = 0;
+    ilu.apply(v1, d);
+    blockJacobi.apply(v2, d);
+
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        for (int j = 0; j < bsize; ++j)
+        {
+            BOOST_CHECK_CLOSE(v1[i][j], v2[i][j], 1e-8);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BlockJacobiILU1)
+{
+    testBlockJacobiILU0<1>();
+}
+
+BOOST_AUTO_TEST_CASE(BlockJacobiILU3)
+{
+    testBlockJacobiILU0<3>();
+}
+
+// Move the coupling of the first row from its right neighbour to the next
+// cell, which changes the pattern but keeps the number of nonzeros.
+template<class Matrix>
+Matrix moveFirstCoupling(const Matrix& A)
+{
+    Matrix B(A.N(), A.N(), A.nonzeroes(), Matrix::row_wise);
+    for (auto row = B.createbegin(); row != B.createend(); ++row)
+    {
+        for (auto col = A[row.index()].begin(); col != A[row.index()].end(); ++col)
+        {
+            row.insert(row.index() == 0 && col.index() == 1 ? 2 : col.index());
+        }
+    }
+    for (auto row = B.begin(); row != B.end(); ++row)
+    {
+        for (auto col = row->begin(); col != row->end(); ++col)
+        {
+            *col = col.index() == row.index() ? 4.0 + 0.1 * row.index() : -1.0 - 0.01 * col.index();
+        }
+    }
+    BOOST_REQUIRE_EQUAL(B.nonzeroes(), A.nonzeroes());
+    return B;
+}
+
+BOOST_AUTO_TEST_CASE(BlockJacobiILU0PatternChange)
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 1> >;
+    std::size_t N = 6;
+    Matrix A;
+    setupLaplacian(A, N);
+    std::vector<int> partition(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        partition[i] = i < A.N() / 2 ? 0 : 1;
+    }
+    Opm::BlockJacobiILU0<Matrix, Vector, Vector> blockJacobi(A, partition, 1.0);
+
+    A = moveFirstCoupling(A);
+    blockJacobi.update();
+
+    Opm::BlockJacobiILU0<Matrix, Vector, Vector> fresh(A, partition, 1.0);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 5);
+    }
+    v1 = 0;
+    v2 = 0;
+    blockJacobi.apply(v1, d);
+    fresh.apply(v2, d);
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        BOOST_CHECK_CLOSE(v1[i][0], v2[i][0], 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BISAIPatternChange)
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 1> >;
+    std::size_t N = 6;
+    Matrix A;
+    setupLaplacian(A, N);
+    Opm::BISAI<Matrix, Vector, Vector> bisai(A, 1.0);
+
+    A = moveFirstCoupling(A);
+    bisai.update();
+
+    Opm::BISAI<Matrix, Vector, Vector> fresh(A, 1.0);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 5);
+    }
+    v1 = 0;
+    v2 = 0;
+    bisai.apply(v1, d);
+    fresh.apply(v2, d);
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        BOOST_CHECK_CLOSE(v1[i][0], v2[i][0], 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ChowPatelILU0PatternChange)
+{
+    using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1> >;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 1> >;
+    std::size_t N = 6;
+    Matrix A;
+    setupLaplacian(A, N);
+    Opm::ChowPatelILU0<Matrix, Vector, Vector> chowPatel(A, 4*N, 2*N, 1.0);
+
+    A = moveFirstCoupling(A);
+    chowPatel.update();
+
+    Opm::ChowPatelILU0<Matrix, Vector, Vector> fresh(A, 4*N, 2*N, 1.0);
+    Vector d(A.N()), v1(A.N()), v2(A.N());
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        d[i] = 1.0 + static_cast<double>(i % 5);
+    }
+    v1 = 0;
+    v2 = 0;
+    // The result is written into the storage of the caller.
+    const auto* storage = &v1[0];
+    chowPatel.apply(v1, d);
+    fresh.apply(v2, d);
+    BOOST_CHECK(&v1[0] == storage);
+    for (std::size_t i = 0; i < A.N(); ++i)
+    {
+        BOOST_CHECK_CLOSE(v1[i][0], v2[i][0], 1e-12);
+    }
+}
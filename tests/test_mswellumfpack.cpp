@@ -0,0 +1,208 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#define BOOST_TEST_MODULE MSWellUMFPackTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#if HAVE_UMFPACK
+
+#include <opm/simulators/wells/MSWellUMFPack.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr int blockSize = 3;
+
+using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, blockSize, blockSize>>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, blockSize>>;
+
+/// The D matrix of a well with the given outlet of every segment, and the
+/// extra couplings of a looped well.
+Matrix makeWellMatrix(const std::vector<int>& outlets,
+                      const std::vector<std::pair<int, int>>& loops,
+                      double value)
+{
+    const std::size_t n = outlets.size();
+    std::vector<std::vector<std::size_t>> columns(n);
+    for (std::size_t seg = 0; seg < n; ++seg) {
+        columns[seg].push_back(seg);
+        if (outlets[seg] >= 0) {
+            columns[seg].push_back(outlets[seg]);
+            columns[outlets[seg]].push_back(seg);
+        }
+    }
+    for (const auto& [first, second] : loops) {
+        columns[first].push_back(second);
+        columns[second].push_back(first);
+    }
+
+    Matrix D(n, n, Matrix::row_wise);
+    for (auto row = D.createbegin(); row != D.createend(); ++row) {
+        for (const auto col : columns[row.index()]) {
+            row.insert(col);
+        }
+    }
+    for (auto row = D.begin(); row != D.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            const double diagonal = col.index() == row.index() ? 8.0 : 0.0;
+            for (int i = 0; i < blockSize; ++i) {
+                for (int j = 0; j < blockSize; ++j) {
+                    value = value * 1.37 - 0.61;
+                    if (value > 2.0 || value < -2.0) {
+                        value *= 0.1;
+                    }
+                    (*col)[i][j] = value + (i == j ? diagonal : 0.0);
+                }
+            }
+        }
+    }
+    return D;
+}
+
+Vector makeSolution(const std::size_t n)
+{
+    Vector x(n);
+    for (std::size_t seg = 0; seg < n; ++seg) {
+        x[seg] = {1.0 + seg, -0.5 * seg - 1.0, 2.0};
+    }
+    return x;
+}
+
+void checkSolution(const Vector& x, const Vector& expected)
+{
+    BOOST_REQUIRE_EQUAL(x.size(), expected.size());
+    for (std::size_t seg = 0; seg < x.size(); ++seg) {
+        for (int i = 0; i < blockSize; ++i) {
+            BOOST_CHECK_CLOSE(x[seg][i], expected[seg][i], 1e-10);
+        }
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestSolveLoopedWell)
+{
+    const Matrix D = makeWellMatrix({-1, 0, 1, 1, 0}, {{2, 3}}, 0.4);
+    const Vector expected = makeSolution(D.N());
+    Vector x(D.N());
+    D.mv(expected, x);
+
+    Opm::MSWellUMFPack solver;
+    solver.analyze(D);
+    BOOST_CHECK(solver.pending());
+    BOOST_CHECK(!solver.symbolic());
+    solver.factorize(D);
+    BOOST_CHECK(!solver.pending());
+    BOOST_CHECK(solver.symbolic());
+    solver.solve(x);
+    checkSolution(x, expected);
+}
+
+BOOST_AUTO_TEST_CASE(TestReuseSymbolicFactorization)
+{
+    const std::vector<int> outlets = {-1, 0, 1, 1, 0};
+    const std::vector<std::pair<int, int>> loops = {{2, 3}};
+    const Matrix D = makeWellMatrix(outlets, loops, 0.4);
+    const Vector expected = makeSolution(D.N());
+
+    Opm::MSWellUMFPack solver;
+    solver.analyze(D);
+    solver.factorize(D);
+    const auto symbolic = solver.symbolic();
+
+    // New values in the same pattern, as after the next assembly.
+    const Matrix changed = makeWellMatrix(outlets, loops, -0.9);
+    Vector rhs(changed.N());
+    changed.mv(expected, rhs);
+
+    solver.invalidate();
+    BOOST_CHECK(solver.pending());
+    solver.factorize(changed);
+    BOOST_CHECK(solver.symbolic() == symbolic);
+    Vector reused = rhs;
+    solver.solve(reused);
+    checkSolution(reused, expected);
+
+    // A new well object for the same pattern, as in a later time step.
+    Opm::MSWellUMFPack shared;
+    shared.setSymbolic(symbolic);
+    shared.analyze(changed);
+    shared.factorize(changed);
+    BOOST_CHECK(shared.symbolic() == symbolic);
+    Vector sharedSolution = rhs;
+    shared.solve(sharedSolution);
+
+    Opm::MSWellUMFPack fresh;
+    fresh.analyze(changed);
+    fresh.factorize(changed);
+    BOOST_CHECK(fresh.symbolic() != symbolic);
+    Vector freshSolution = rhs;
+    fresh.solve(freshSolution);
+
+    checkSolution(reused, freshSolution);
+    checkSolution(sharedSolution, freshSolution);
+}
+
+BOOST_AUTO_TEST_CASE(TestPatternChangeDropsSymbolicFactorization)
+{
+    const Matrix D = makeWellMatrix({-1, 0, 1}, {}, 0.4);
+    Opm::MSWellUMFPack solver;
+    solver.analyze(D);
+    solver.factorize(D);
+    const auto symbolic = solver.symbolic();
+
+    // A new segment changes the pattern.
+    const Matrix extended = makeWellMatrix({-1, 0, 1, 1}, {}, 0.4);
+    solver.analyze(extended);
+    BOOST_CHECK(!solver.symbolic());
+
+    // A symbolic factorization of another pattern is not taken.
+    solver.setSymbolic(symbolic);
+    BOOST_CHECK(!solver.symbolic());
+
+    const Vector expected = makeSolution(extended.N());
+    Vector x(extended.N());
+    extended.mv(expected, x);
+    solver.factorize(extended);
+    solver.solve(x);
+    checkSolution(x, expected);
+}
+
+#else
+
+// Do nothing without UMFPack.
+BOOST_AUTO_TEST_CASE(DummyTest)
+{
+    BOOST_REQUIRE(true);
+}
+
+#endif // HAVE_UMFPACK
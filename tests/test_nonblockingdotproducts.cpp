@@ -0,0 +1,101 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#define BOOST_TEST_MODULE TestNonBlockingDotProducts
+#define BOOST_TEST_NO_MAIN
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <opm/simulators/linalg/PipelinedSolvers.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/owneroverlapcopy.hh>
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+#if HAVE_MPI
+
+using Scalars = boost::mpl::list<double, float>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(OwnedRowsOnly, Scalar, Scalars)
+{
+    using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, 2>>;
+    using Comm = Dune::OwnerOverlapCopyCommunication<int, int>;
+    using LocalIndex = Comm::ParallelIndexSet::LocalIndex;
+
+    // Every process owns n consecutive global rows, and has a copy of the
+    // first row of the next process.
+    const int n = 10;
+    Comm comm(MPI_COMM_WORLD);
+    const int rank = comm.communicator().rank();
+    const int size = comm.communicator().size();
+    const bool hasCopy = rank + 1 < size;
+    auto& indexSet = comm.indexSet();
+    indexSet.beginResize();
+    for (int i = 0; i < n; ++i) {
+        indexSet.add(rank * n + i, LocalIndex(i, Dune::OwnerOverlapCopyAttributeSet::owner, true));
+    }
+    if (hasCopy) {
+        indexSet.add((rank + 1) * n, LocalIndex(n, Dune::OwnerOverlapCopyAttributeSet::copy, true));
+    }
+    indexSet.endResize();
+
+    const int local = hasCopy ? n + 1 : n;
+    Vector x(local);
+    Vector y(local);
+    for (int i = 0; i < local; ++i) {
+        const Scalar global = rank * n + i;
+        x[i] = {global + 1, 0.5};
+        y[i] = {1.0, global};
+    }
+
+    Dune::NonBlockingDotProducts<Vector> dots(comm);
+    dots.start({{&x, &y}, {&x, &x}});
+    const auto& values = dots.wait();
+
+    // Sums over all global rows, with every row counted once.
+    const double m = n * size;
+    BOOST_REQUIRE_EQUAL(values.size(), 2u);
+    BOOST_CHECK_CLOSE(values[0], 0.75 * m * (m - 1) + m, 1e-4);
+    BOOST_CHECK_CLOSE(values[1], m * (m + 1) * (2 * m + 1) / 6 + 0.25 * m, 1e-4);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(DummyTest)
+{
+    BOOST_REQUIRE(true);
+}
+
+#endif // HAVE_MPI
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    return boost::unit_test::unit_test_main(&init_unit_test_func, argc, argv);
+}
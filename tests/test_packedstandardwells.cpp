@@ -0,0 +1,211 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/wells/PackedStandardWells.hpp>
+
+#define BOOST_TEST_MODULE PackedStandardWellsTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <vector>
+
+namespace
+{
+
+constexpr int numEq = 3;
+constexpr int numWellEq = 4;
+
+using CellBlock = std::array<double, numEq>;
+using OffDiagBlock = std::array<std::array<double, numEq>, numWellEq>;
+using DiagBlock = std::array<std::array<double, numWellEq>, numWellEq>;
+
+struct Well
+{
+    std::vector<int> cells;
+    std::vector<OffDiagBlock> B;
+    std::vector<OffDiagBlock> C;
+    DiagBlock invD;
+};
+
+Well makeWell(const std::vector<int>& cells, const double seed)
+{
+    Well well;
+    well.cells = cells;
+    double value = seed;
+    auto next = [&value]() {
+        value = value * 1.37 - 0.61;
+        if (value > 5.0 || value < -5.0) {
+            value *= 0.1;
+        }
+        return value;
+    };
+    for (std::size_t perf = 0; perf < cells.size(); ++perf) {
+        OffDiagBlock B, C;
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numEq; ++j) {
+                B[i][j] = next();
+                C[i][j] = next();
+            }
+        }
+        well.B.push_back(B);
+        well.C.push_back(C);
+    }
+    for (int i = 0; i < numWellEq; ++i) {
+        for (int j = 0; j < numWellEq; ++j) {
+            well.invD[i][j] = next();
+        }
+    }
+    return well;
+}
+
+/// Ax -= C^T invD B x for a single well, written out directly.
+void applyWell(const Well& well, const std::vector<CellBlock>& x, std::vector<CellBlock>& Ax)
+{
+    std::array<double, numWellEq> Bx{};
+    for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numEq; ++j) {
+                Bx[i] += well.B[perf][i][j] * x[well.cells[perf]][j];
+            }
+        }
+    }
+    std::array<double, numWellEq> invDBx{};
+    for (int i = 0; i < numWellEq; ++i) {
+        for (int j = 0; j < numWellEq; ++j) {
+            invDBx[i] += well.invD[i][j] * Bx[j];
+        }
+    }
+    for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+        for (int j = 0; j < numEq; ++j) {
+            for (int i = 0; i < numWellEq; ++i) {
+                Ax[well.cells[perf]][j] -= well.C[perf][i][j] * invDBx[i];
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestApplyMatchesSingleWells)
+{
+    // The last two wells share cell 4.
+    const std::vector<Well> wells = {makeWell({0, 2, 3}, 0.3),
+                                     makeWell({4}, -1.1),
+                                     makeWell({5, 4, 7}, 2.2)};
+    const int numCells = 8;
+    std::vector<CellBlock> x(numCells);
+    for (int cell = 0; cell < numCells; ++cell) {
+        for (int j = 0; j < numEq; ++j) {
+            x[cell][j] = 1.0 + 0.5 * cell - 0.25 * j;
+        }
+    }
+
+    Opm::PackedStandardWells<double, numEq, numWellEq> packed;
+    for (const auto& well : wells) {
+        packed.addWell(well.invD);
+        for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+            packed.addPerforation(well.cells[perf], well.B[perf], well.C[perf]);
+        }
+    }
+    BOOST_CHECK_EQUAL(packed.numWells(), wells.size());
+
+    std::vector<CellBlock> expected(numCells, CellBlock{1.0, 2.0, 3.0});
+    std::vector<CellBlock> Ax = expected;
+    for (const auto& well : wells) {
+        applyWell(well, x, expected);
+    }
+    packed.apply(x, Ax);
+    for (int cell = 0; cell < numCells; ++cell) {
+        for (int j = 0; j < numEq; ++j) {
+            BOOST_CHECK_CLOSE(Ax[cell][j], expected[cell][j], 1e-10);
+        }
+    }
+
+    // Nothing is applied after clearing.
+    packed.clear();
+    BOOST_CHECK_EQUAL(packed.numWells(), 0u);
+    const auto before = Ax;
+    packed.apply(x, Ax);
+    BOOST_CHECK(Ax == before);
+}
+
+BOOST_AUTO_TEST_CASE(TestSingleWellKernels)
+{
+    const Well well = makeWell({1, 3}, 0.7);
+    Opm::PackedStandardWells<double, numEq, numWellEq> single;
+    single.addWell(well.invD);
+    for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+        single.addPerforation(well.cells[perf], well.B[perf], well.C[perf]);
+    }
+    // Appending keeps the well apart from the ones before it.
+    Opm::PackedStandardWells<double, numEq, numWellEq> packed;
+    packed.addWell(well.invD);
+    packed.append(single);
+    BOOST_CHECK_EQUAL(packed.numWells(), 2u);
+
+    const std::array<double, numWellEq> resWell = {0.5, -1.5, 2.0, 0.25};
+    std::vector<CellBlock> x(4, CellBlock{0.3, -0.2, 1.1});
+
+    // xw = D^-1 (resWell - B x)
+    std::array<double, numWellEq> Bx{};
+    for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+        for (int i = 0; i < numWellEq; ++i) {
+            for (int j = 0; j < numEq; ++j) {
+                Bx[i] += well.B[perf][i][j] * x[well.cells[perf]][j];
+            }
+        }
+    }
+    std::array<double, numWellEq> expected{};
+    std::array<double, numWellEq> solved{};
+    for (int i = 0; i < numWellEq; ++i) {
+        for (int j = 0; j < numWellEq; ++j) {
+            expected[i] += well.invD[i][j] * (resWell[j] - Bx[j]);
+            solved[i] += well.invD[i][j] * resWell[j];
+        }
+    }
+    std::array<double, numWellEq> xw{};
+    packed.recoverSolution(1, x, resWell, xw);
+    for (int i = 0; i < numWellEq; ++i) {
+        BOOST_CHECK_CLOSE(xw[i], expected[i], 1e-10);
+    }
+    packed.solveWell(1, resWell, xw);
+    for (int i = 0; i < numWellEq; ++i) {
+        BOOST_CHECK_CLOSE(xw[i], solved[i], 1e-10);
+    }
+
+    // r -= C^T D^-1 resWell only touches the cells of the well.
+    std::vector<CellBlock> r(4, CellBlock{1.0, 1.0, 1.0});
+    packed.applyResidual(1, resWell, r);
+    for (int cell : {0, 2}) {
+        BOOST_CHECK(r[cell] == (CellBlock{1.0, 1.0, 1.0}));
+    }
+    for (std::size_t perf = 0; perf < well.cells.size(); ++perf) {
+        for (int j = 0; j < numEq; ++j) {
+            double value = 1.0;
+            for (int i = 0; i < numWellEq; ++i) {
+                value -= well.C[perf][i][j] * solved[i];
+            }
+            BOOST_CHECK_CLOSE(r[well.cells[perf]][j], value, 1e-10);
+        }
+    }
+}
@@ -0,0 +1,183 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#define BOOST_TEST_MODULE TestPersistentHaloExchange
+#define BOOST_TEST_NO_MAIN
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <opm/simulators/linalg/PersistentHaloExchange.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/owneroverlapcopy.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+#if HAVE_MPI
+
+namespace
+{
+
+using Comm = Dune::OwnerOverlapCopyCommunication<int, int>;
+
+/// Every process owns n consecutive global rows, and has copies of the
+/// last row of the previous process and the first two rows of the next.
+/// Returns the number of local rows.
+int setupIndices(Comm& comm, const int n)
+{
+    using LocalIndex = Comm::ParallelIndexSet::LocalIndex;
+    const int rank = comm.communicator().rank();
+    const int size = comm.communicator().size();
+    auto& indexSet = comm.indexSet();
+    indexSet.beginResize();
+    for (int i = 0; i < n; ++i) {
+        indexSet.add(rank * n + i, LocalIndex(i, Dune::OwnerOverlapCopyAttributeSet::owner, true));
+    }
+    int local = n;
+    if (rank > 0) {
+        indexSet.add(rank * n - 1, LocalIndex(local++, Dune::OwnerOverlapCopyAttributeSet::copy, true));
+    }
+    if (rank + 1 < size) {
+        indexSet.add((rank + 1) * n, LocalIndex(local++, Dune::OwnerOverlapCopyAttributeSet::copy, true));
+        indexSet.add((rank + 1) * n + 1, LocalIndex(local++, Dune::OwnerOverlapCopyAttributeSet::copy, true));
+    }
+    indexSet.endResize();
+    comm.remoteIndices().rebuild<false>();
+    return local;
+}
+
+/// Values of the owner rows from their global index, -1 in the copies.
+template <class Vector>
+void fill(const Comm& comm, const double shift, Vector& x)
+{
+    using Scalar = typename Vector::field_type;
+    x = -1.0;
+    for (const auto& index : comm.indexSet()) {
+        if (index.local().attribute() == Dune::OwnerOverlapCopyAttributeSet::owner) {
+            x[index.local().local()] = {static_cast<Scalar>(index.global() + shift),
+                                        static_cast<Scalar>(2.0 * index.global() - shift)};
+        }
+    }
+}
+
+template <class Vector>
+void checkEqual(const Vector& x, const Vector& y)
+{
+    BOOST_REQUIRE_EQUAL(x.size(), y.size());
+    for (std::size_t row = 0; row < x.size(); ++row) {
+        for (std::size_t i = 0; i < x[row].size(); ++i) {
+            BOOST_CHECK_EQUAL(x[row][i], y[row][i]);
+        }
+    }
+}
+
+} // anonymous namespace
+
+using Scalars = boost::mpl::list<double, float>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(SameAsCopyOwnerToAll, Scalar, Scalars)
+{
+    using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, 2>>;
+    const int n = 5;
+    Comm comm(MPI_COMM_WORLD);
+    const int local = setupIndices(comm, n);
+
+    Opm::PersistentHaloExchange<Vector> exchange(comm);
+    const auto sendRows = exchange.sendRows();
+    for (const auto row : sendRows) {
+        BOOST_CHECK_LT(row, static_cast<std::size_t>(n));
+    }
+    if (comm.communicator().size() > 1) {
+        BOOST_CHECK(!sendRows.empty());
+    }
+
+    // The persistent requests are reused for every exchange.
+    for (const double shift : {0.5, 7.0, -3.0}) {
+        Vector expected(local);
+        fill(comm, shift, expected);
+        comm.copyOwnerToAll(expected, expected);
+
+        Vector x(local);
+        fill(comm, shift, x);
+        exchange.start(x);
+        exchange.finish(x);
+        checkEqual(x, expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RenumberedRows)
+{
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, 2>>;
+    const int n = 5;
+    Comm comm(MPI_COMM_WORLD);
+    const int local = setupIndices(comm, n);
+
+    Vector expected(local);
+    fill(comm, 1.5, expected);
+    comm.copyOwnerToAll(expected, expected);
+
+    // The rows in reverse order, as in a reordered copy of the vectors.
+    std::vector<std::size_t> ordering(local);
+    for (int row = 0; row < local; ++row) {
+        ordering[row] = local - 1 - row;
+    }
+    Opm::PersistentHaloExchange<Vector> exchange(comm);
+    exchange.renumber(ordering);
+
+    Vector x(local);
+    fill(comm, 1.5, x);
+    Vector reordered(local);
+    for (int row = 0; row < local; ++row) {
+        reordered[ordering[row]] = x[row];
+    }
+    exchange.start(reordered);
+    exchange.finish(reordered);
+    for (int row = 0; row < local; ++row) {
+        x[row] = reordered[ordering[row]];
+    }
+    checkEqual(x, expected);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(DummyTest)
+{
+    BOOST_REQUIRE(true);
+}
+
+#endif // HAVE_MPI
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    return boost::unit_test::unit_test_main(&init_unit_test_func, argc, argv);
+}
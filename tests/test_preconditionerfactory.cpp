@@ -31,6 +31,7 @@
 #include <opm/simulators/linalg/matrixblock.hh>
 #include <opm/simulators/linalg/ilufirstelement.hh>
 
+#include <opm/simulators/linalg/BlockJacobiILU0.hpp>
 #include <opm/simulators/linalg/PreconditionerFactory.hpp>
 #include <opm/simulators/linalg/PropertyTree.hpp>
 #include <opm/simulators/linalg/FlexibleSolver.hpp>
@@ -42,8 +43,13 @@
 #include <dune/istl/matrixmarket.hh>
 #include <dune/istl/solvers.hh>
 
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 
 template <class X>
@@ -101,9 +107,9 @@ testPrec(const Opm::PropertyTree& prm, const std::string& matrix_filename, const
     if(prm.get<std::string>("preconditioner.type") == "cprt"){
         transpose = true;
     }
-    auto wc = [&matrix, transpose]()
+    auto wc = [&matrix, transpose](Vector& weights)
     {
-        return Opm::Amg::getQuasiImpesWeights<Matrix, Vector>(matrix, 1, transpose);
+        Opm::Amg::getQuasiImpesWeights(matrix, 1, transpose, weights);
     };
 
     auto prec = PrecFactory::create(op, prm.get_child("preconditioner"), wc, 1);
@@ -194,7 +200,7 @@ BOOST_AUTO_TEST_CASE(TestAddingPreconditioner)
 
 
     // Add preconditioner to factory for block size 1.
-    PF<1>::addCreator("nothing", [](const O<1>&, const Opm::PropertyTree&, const std::function<V<1>()>&,
+    PF<1>::addCreator("nothing", [](const O<1>&, const Opm::PropertyTree&, const std::function<void(V<1>&)>&,
                                     std::size_t) {
             return Dune::wrapPreconditioner<NothingPreconditioner<V<1>>>();
         });
@@ -210,7 +216,7 @@ BOOST_AUTO_TEST_CASE(TestAddingPreconditioner)
     }
 
     // Add preconditioner to factory for block size 3.
-    PF<3>::addCreator("nothing", [](const O<3>&, const Opm::PropertyTree&, const std::function<V<3>()>&,
+    PF<3>::addCreator("nothing", [](const O<3>&, const Opm::PropertyTree&, const std::function<void(V<3>&)>&,
                                     std::size_t) {
             return Dune::wrapPreconditioner<NothingPreconditioner<V<3>>>();
         });
@@ -307,7 +313,7 @@ testPrecRepeating(const Opm::PropertyTree& prm, const std::string& matrix_filena
     using PrecFactory = Opm::PreconditionerFactory<Operator>;
 
     // Add no-oppreconditioner to factory for block size 1.
-    PrecFactory::addCreator("nothing", [](const Operator&, const Opm::PropertyTree&, const std::function<Vector()>&,
+    PrecFactory::addCreator("nothing", [](const Operator&, const Opm::PropertyTree&, const std::function<void(Vector&)>&,
                                           std::size_t) {
         return Dune::wrapPreconditioner<NothingPreconditioner<Vector>>();
     });
@@ -372,6 +378,169 @@ BOOST_AUTO_TEST_CASE(TestWithRepeatingOperator)
 }
 
 
+// A 3x3 block matrix on an nx by ny grid, with the first unknown of every
+// block playing the role of the pressure. The couplings in x and y
+// direction are scaled by cx and cy.
+M<3> anisotropicMatrix(const int nx, const int ny, const double cx, const double cy)
+{
+    const int n = nx * ny;
+    M<3> matrix(n, n, 5 * n, M<3>::row_wise);
+    for (auto row = matrix.createbegin(); row != matrix.createend(); ++row) {
+        const int i = row.index() % nx;
+        const int j = row.index() / nx;
+        if (j > 0) {
+            row.insert(row.index() - nx);
+        }
+        if (i > 0) {
+            row.insert(row.index() - 1);
+        }
+        row.insert(row.index());
+        if (i < nx - 1) {
+            row.insert(row.index() + 1);
+        }
+        if (j < ny - 1) {
+            row.insert(row.index() + nx);
+        }
+    }
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            const int dist = std::abs(static_cast<int>(col.index()) - static_cast<int>(row.index()));
+            auto& block = *col;
+            block = 0.0;
+            if (dist == 0) {
+                block[0][0] = 2.0 * (cx + cy) + 0.1;
+                block[0][1] = 0.2;
+                block[1][0] = 0.3;
+                block[1][1] = 3.0;
+                block[1][2] = 0.2;
+                block[2][0] = 0.1;
+                block[2][2] = 3.0;
+            } else {
+                const double c = dist == 1 ? cx : cy;
+                block[0][0] = -c;
+                block[1][0] = -0.2 * c;
+                block[1][1] = -0.3 * c;
+                block[2][0] = -0.1 * c;
+                block[2][2] = -0.3 * c;
+            }
+        }
+    }
+    return matrix;
+}
+
+V<3> applyPrec(Dune::PreconditionerWithUpdate<V<3>, V<3>>& prec, const V<3>& d)
+{
+    V<3> v(d.size());
+    v = 0.0;
+    prec.apply(v, d);
+    return v;
+}
+
+BOOST_AUTO_TEST_CASE(TestNumericUpdateOfCpr)
+{
+    // With a single loop solver iteration on the coarse level the CPR
+    // preconditioner is a linear map, which depends on the AMG hierarchy.
+    Opm::PropertyTree prm;
+    prm.put("type", std::string("cpr"));
+    prm.put("verbosity", 0);
+    prm.put("finesmoother.type", std::string("ILU0"));
+    prm.put("coarsesolver.solver", std::string("loopsolver"));
+    prm.put("coarsesolver.tol", 1e-12);
+    prm.put("coarsesolver.maxiter", 1);
+    prm.put("coarsesolver.verbosity", 0);
+    prm.put("coarsesolver.preconditioner.type", std::string("amg"));
+    prm.put("coarsesolver.preconditioner.smoother", std::string("ILU0"));
+    prm.put("coarsesolver.preconditioner.coarsenTarget", 20);
+    prm.put("coarsesolver.preconditioner.verbosity", 0);
+
+    const int nx = 20;
+    const int ny = 20;
+    M<3> matrix = anisotropicMatrix(nx, ny, 1.0, 0.01);
+    O<3> op(matrix);
+    auto wc = [&matrix](V<3>& weights) { Opm::Amg::getQuasiImpesWeights(matrix, 0, false, weights); };
+    auto prec = PF<3>::create(op, prm, wc, 0);
+
+    V<3> d(matrix.N());
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        d[i] = {1.0 + 0.01 * i, -0.5, 0.002 * i};
+    }
+    const V<3> before = applyPrec(*prec, d);
+
+    // Scaling the matrix changes its values, but not the strength of the
+    // connections, so the kept hierarchy is also the one a new setup makes.
+    matrix *= 2.0;
+    prec->update();
+    const V<3> scaled = applyPrec(*prec, d);
+    const V<3> scaledFresh = applyPrec(*PF<3>::create(op, prm, wc, 0), d);
+    const double scale = before.infinity_norm();
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            BOOST_CHECK_SMALL(scaled[i][k] - scaledFresh[i][k], 1e-10 * scale);
+            BOOST_CHECK_SMALL(scaled[i][k] - 0.5 * before[i][k], 1e-10 * scale);
+        }
+    }
+
+    // Turning the anisotropy around changes the strong connections. A new
+    // setup aggregates along y, while update() keeps the aggregates along
+    // x and only recomputes the coarse matrices and smoothers.
+    matrix = 0.0;
+    matrix += anisotropicMatrix(nx, ny, 0.01, 1.0);
+    prec->update();
+    const V<3> turned = applyPrec(*prec, d);
+    const V<3> turnedFresh = applyPrec(*PF<3>::create(op, prm, wc, 0), d);
+    V<3> diff = turned;
+    diff -= turnedFresh;
+    BOOST_CHECK(std::isfinite(turned.two_norm()));
+    BOOST_CHECK_GT(diff.two_norm(), 1e-6 * turnedFresh.two_norm());
+}
+
+
+BOOST_AUTO_TEST_CASE(TestBlockJacobiPartition)
+{
+    // The partition named by the parameter is used instead of blocks of
+    // consecutive rows.
+    const int nx = 8;
+    const int ny = 6;
+    M<3> matrix = anisotropicMatrix(nx, ny, 1.0, 0.5);
+    O<3> op(matrix);
+    std::vector<int> partition(matrix.N());
+    for (std::size_t i = 0; i < partition.size(); ++i) {
+        partition[i] = (i % nx) < nx / 2 ? 0 : 1;
+    }
+    using BlockJacobi = Opm::BlockJacobiILU0<M<3>, V<3>, V<3>>;
+    const auto shared = std::make_shared<const std::vector<int>>(partition);
+    Opm::BlockJacobiPartitions::add("halves", shared);
+    BOOST_CHECK(Opm::BlockJacobiPartitions::get("halves") == shared);
+    BOOST_CHECK_THROW(Opm::BlockJacobiPartitions::get("unknown"), std::invalid_argument);
+
+    Opm::PropertyTree prm;
+    prm.put("type", std::string("BlockJacobiILU0"));
+    prm.put("relaxation", 0.9);
+    prm.put("blocks", 2);
+    const auto contiguous = PF<3>::create(op, prm);
+    prm.put("partition", std::string("halves"));
+    const auto partitioned = PF<3>::create(op, prm);
+    // The preconditioner shares the partition instead of copying it.
+    BOOST_CHECK_GT(shared.use_count(), 2);
+    BlockJacobi expected(matrix, partition, 0.9);
+
+    V<3> d(matrix.N());
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        d[i] = {1.0 + 0.1 * i, -0.5, 0.02 * i};
+    }
+    const V<3> v = applyPrec(*partitioned, d);
+    const V<3> reference = applyPrec(expected, d);
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            BOOST_CHECK_CLOSE(v[i][k], reference[i][k], 1e-10);
+        }
+    }
+    V<3> diff = applyPrec(*contiguous, d);
+    diff -= v;
+    BOOST_CHECK_GT(diff.two_norm(), 1e-6 * v.two_norm());
+}
+
+
 
 #else
 
@@ -0,0 +1,111 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/linalg/PreconditionerReusePolicy.hpp>
+
+#define BOOST_TEST_MODULE PreconditionerReusePolicyTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace
+{
+
+using Action = Opm::PreconditionerReusePolicy::Action;
+
+/// Collective communication of a single process.
+struct SerialComm
+{
+    template <class T>
+    int sum(T*, int) const
+    {
+        return 0;
+    }
+};
+
+/// A diagonal sample, and a well sample scaled differently.
+std::vector<std::vector<double>> samples(const double diagonalScale, const double wellScale)
+{
+    return {{4.0 * diagonalScale, -1.0 * diagonalScale, 2.5 * diagonalScale},
+            {1e-8 * wellScale, 3e-8 * wellScale}};
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestMatrixChanges)
+{
+    Opm::PreconditionerReusePolicy policy(0.02, 0.2);
+    const SerialComm comm;
+    BOOST_CHECK(policy.decide(samples(1.0, 1.0), false, comm) == Action::Rebuild);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(samples(1.0, 1.0), false, comm) == Action::Reuse);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(samples(1.01, 1.0), false, comm) == Action::Reuse);
+    policy.record(10, true);
+    // The changes add up since the last update.
+    BOOST_CHECK(policy.decide(samples(1.03, 1.0), false, comm) == Action::Update);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(samples(1.04, 1.0), false, comm) == Action::Reuse);
+    policy.record(10, true);
+    // Every sample counts on its own scale.
+    BOOST_CHECK(policy.decide(samples(1.04, 1.1), false, comm) == Action::Update);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(samples(1.3, 1.1), false, comm) == Action::Rebuild);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(samples(1.3, 1.1), true, comm) == Action::Rebuild);
+    policy.record(10, true);
+    // A new layout of the samples, e.g. after wells were opened.
+    BOOST_CHECK(policy.decide({{1.0}, {}}, false, comm) == Action::Rebuild);
+
+    const auto& counts = policy.counts();
+    BOOST_CHECK_EQUAL(counts[static_cast<int>(Action::Rebuild)], 4);
+    BOOST_CHECK_EQUAL(counts[static_cast<int>(Action::Update)], 2);
+    BOOST_CHECK_EQUAL(counts[static_cast<int>(Action::Reuse)], 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestIterationGrowth)
+{
+    Opm::PreconditionerReusePolicy policy(0.02, 0.2);
+    const SerialComm comm;
+    const auto unchanged = samples(1.0, 1.0);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Rebuild);
+    policy.record(10, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Reuse);
+    policy.record(16, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Update);
+    policy.record(12, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Reuse);
+    policy.record(16, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Update);
+    // The update did not help.
+    policy.record(17, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Rebuild);
+    policy.record(4, true);
+    // Small iteration counts are not compared.
+    policy.record(7, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Reuse);
+    policy.record(40, true);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Rebuild);
+    policy.record(10, false);
+    BOOST_CHECK(policy.decide(unchanged, false, comm) == Action::Rebuild);
+}
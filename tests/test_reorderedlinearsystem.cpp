@@ -0,0 +1,150 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/linalg/MatrixBlock.hpp>
+#include <opm/simulators/linalg/ReorderedLinearSystem.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#define BOOST_TEST_MODULE ReorderedLinearSystemTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, 2, 2>>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 2>>;
+
+/// 5-point stencil on an N x N grid, with the cells numbered in a scattered order.
+Matrix scatteredLaplacian(const int N)
+{
+    const int size = N * N;
+    const auto number = [size](const int cell) { return (cell * 97) % size; };
+    Matrix matrix(size, size, 5, 0.4, Matrix::implicit);
+    for (int j = 0; j < N; ++j) {
+        for (int i = 0; i < N; ++i) {
+            const int cell = j * N + i;
+            const int row = number(cell);
+            matrix.entry(row, row) = 4.0;
+            if (i > 0) {
+                matrix.entry(row, number(cell - 1)) = -1.0 - 0.01 * row;
+            }
+            if (i < N - 1) {
+                matrix.entry(row, number(cell + 1)) = -1.0;
+            }
+            if (j > 0) {
+                matrix.entry(row, number(cell - N)) = -1.0 + 0.02;
+            }
+            if (j < N - 1) {
+                matrix.entry(row, number(cell + N)) = -1.0;
+            }
+        }
+    }
+    matrix.compress();
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            (*col)[0][1] = 0.1 * (*col)[0][0];
+            (*col)[1][0] = 0.2 * (*col)[0][0] + row.index();
+        }
+    }
+    return matrix;
+}
+
+std::size_t bandwidth(const Matrix& matrix, const std::size_t numRows)
+{
+    std::size_t result = 0;
+    for (std::size_t row = 0; row < numRows; ++row) {
+        for (auto col = matrix[row].begin(); col != matrix[row].end(); ++col) {
+            if (col.index() < numRows) {
+                const std::size_t distance = col.index() > row ? col.index() - row : row - col.index();
+                result = std::max(result, distance);
+            }
+        }
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(TestReverseCuthillMcKee)
+{
+    const int N = 12;
+    const auto matrix = scatteredLaplacian(N);
+    const std::size_t numReordered = matrix.N() - 10;
+    Opm::ReorderedLinearSystem<Matrix, Vector> system(matrix, numReordered);
+
+    // A permutation of the first rows that leaves the last ones in place.
+    const auto& perm = system.permutation();
+    std::vector<int> counters(perm.size(), 0);
+    for (std::size_t row = 0; row < perm.size(); ++row) {
+        ++counters[perm[row]];
+        if (row < numReordered) {
+            BOOST_CHECK(perm[row] < numReordered);
+        } else {
+            BOOST_CHECK_EQUAL(perm[row], row);
+        }
+    }
+    for (const auto count : counters) {
+        BOOST_CHECK_EQUAL(count, 1);
+    }
+
+    // The bandwidth of a grid numbered in a scattered order is much reduced.
+    BOOST_CHECK_LE(bandwidth(system.matrix(), numReordered), 2 * N);
+    BOOST_CHECK_GT(bandwidth(matrix, numReordered), 2 * N);
+}
+
+BOOST_AUTO_TEST_CASE(TestReorderedProduct)
+{
+    const auto matrix = scatteredLaplacian(9);
+    Opm::ReorderedLinearSystem<Matrix, Vector> system(matrix, matrix.N());
+
+    // Update with new values, then check P A x == (P A P^T) P x.
+    auto changed = matrix;
+    changed *= 2.0;
+    system.updateMatrix(changed);
+
+    Vector x(matrix.N());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i][0] = 1.0 + i;
+        x[i][1] = 0.5 * i - 3.0;
+    }
+    Vector y(matrix.N());
+    changed.mv(x, y);
+
+    Vector xReordered, yReordered(matrix.N()), yExpected;
+    system.toReordered(x, xReordered);
+    system.matrix().mv(xReordered, yReordered);
+    system.toReordered(y, yExpected);
+    for (std::size_t i = 0; i < y.size(); ++i) {
+        BOOST_CHECK_CLOSE(yReordered[i][0], yExpected[i][0], 1e-12);
+        BOOST_CHECK_CLOSE(yReordered[i][1], yExpected[i][1], 1e-12);
+    }
+
+    Vector back;
+    system.fromReordered(xReordered, back);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        BOOST_CHECK_EQUAL(back[i][0], x[i][0]);
+        BOOST_CHECK_EQUAL(back[i][1], x[i][1]);
+    }
+}
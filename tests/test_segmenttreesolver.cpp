@@ -0,0 +1,238 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/simulators/wells/SegmentTreeSolver.hpp>
+
+#define BOOST_TEST_MODULE SegmentTreeSolverTest
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr int blockSize = 3;
+
+using Block = std::array<std::array<double, blockSize>, blockSize>;
+using Vector = std::vector<std::array<double, blockSize>>;
+
+/// A block matrix in compressed rows, with the row interface of Dune::BCRSMatrix.
+class Matrix
+{
+public:
+    using Entry = std::pair<std::size_t, Block>;
+
+    class ConstIterator
+    {
+    public:
+        explicit ConstIterator(const Entry* entry)
+            : entry_(entry)
+        {
+        }
+        std::size_t index() const
+        {
+            return entry_->first;
+        }
+        const Block& operator*() const
+        {
+            return entry_->second;
+        }
+        ConstIterator& operator++()
+        {
+            ++entry_;
+            return *this;
+        }
+        bool operator!=(const ConstIterator& other) const
+        {
+            return entry_ != other.entry_;
+        }
+
+    private:
+        const Entry* entry_;
+    };
+
+    struct Row
+    {
+        std::vector<Entry> entries;
+        ConstIterator begin() const
+        {
+            return ConstIterator(entries.data());
+        }
+        ConstIterator end() const
+        {
+            return ConstIterator(entries.data() + entries.size());
+        }
+    };
+
+    explicit Matrix(const std::size_t n)
+        : rows_(n)
+    {
+    }
+
+    std::size_t N() const
+    {
+        return rows_.size();
+    }
+
+    const Row& operator[](const std::size_t row) const
+    {
+        return rows_[row];
+    }
+
+    void add(const std::size_t row, const std::size_t col, const Block& block)
+    {
+        rows_[row].entries.emplace_back(col, block);
+    }
+
+    Vector mv(const Vector& x) const
+    {
+        Vector y(rows_.size(), {0.0, 0.0, 0.0});
+        for (std::size_t row = 0; row < rows_.size(); ++row) {
+            for (const auto& [col, block] : rows_[row].entries) {
+                for (int i = 0; i < blockSize; ++i) {
+                    for (int j = 0; j < blockSize; ++j) {
+                        y[row][i] += block[i][j] * x[col][j];
+                    }
+                }
+            }
+        }
+        return y;
+    }
+
+private:
+    std::vector<Row> rows_;
+};
+
+Block makeBlock(double& value, const double diagonal)
+{
+    Block block;
+    for (int i = 0; i < blockSize; ++i) {
+        for (int j = 0; j < blockSize; ++j) {
+            value = value * 1.37 - 0.61;
+            if (value > 2.0 || value < -2.0) {
+                value *= 0.1;
+            }
+            block[i][j] = value + (i == j ? diagonal : 0.0);
+        }
+    }
+    return block;
+}
+
+/// The D matrix of a well with the given outlet of every segment.
+Matrix makeWellMatrix(const std::vector<int>& outlets)
+{
+    const std::size_t n = outlets.size();
+    Matrix D(n);
+    double value = 0.4;
+    for (std::size_t seg = 0; seg < n; ++seg) {
+        if (outlets[seg] >= 0) {
+            D.add(seg, outlets[seg], makeBlock(value, 0.0));
+        }
+        D.add(seg, seg, makeBlock(value, 8.0));
+        for (std::size_t inlet = 0; inlet < n; ++inlet) {
+            if (outlets[inlet] == static_cast<int>(seg)) {
+                D.add(seg, inlet, makeBlock(value, 0.0));
+            }
+        }
+    }
+    return D;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestSolveBranchedWell)
+{
+    // A main bore 0-1-2, with a lateral 3-4 from segment 1 and another
+    // lateral 5-6 from the top segment.
+    const Matrix D = makeWellMatrix({-1, 0, 1, 1, 3, 0, 5});
+    Vector expected(D.N());
+    for (std::size_t seg = 0; seg < D.N(); ++seg) {
+        expected[seg] = {1.0 + seg, -0.5 * seg - 1.0, 2.0};
+    }
+    Vector x = D.mv(expected);
+
+    Opm::SegmentTreeSolver<double, blockSize> solver;
+    BOOST_CHECK(!solver.factorized());
+    BOOST_CHECK(solver.analyze(D));
+    BOOST_CHECK(solver.pending());
+    BOOST_CHECK(solver.factorize(D));
+    BOOST_CHECK(solver.factorized());
+    solver.solve(x);
+    for (std::size_t seg = 0; seg < D.N(); ++seg) {
+        for (int i = 0; i < blockSize; ++i) {
+            BOOST_CHECK_CLOSE(x[seg][i], expected[seg][i], 1e-10);
+        }
+    }
+
+    solver.invalidate();
+    BOOST_CHECK(solver.pending());
+}
+
+BOOST_AUTO_TEST_CASE(TestPivotingWithinBlocks)
+{
+    // The diagonal blocks need row exchanges, like the control equation of
+    // a rate controlled top segment.
+    Matrix D(2);
+    D.add(0, 0, Block{{{0.0, 1.0, 0.0}, {2.0, 0.0, 1.0}, {0.0, 0.0, 3.0}}});
+    D.add(0, 1, Block{{{0.5, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 1.0, 0.0}}});
+    D.add(1, 0, Block{{{0.0, 0.0, 1.0}, {0.0, 0.0, 0.0}, {0.3, 0.0, 0.0}}});
+    D.add(1, 1, Block{{{0.0, 0.0, 4.0}, {1.0, 2.0, 0.0}, {0.0, 5.0, 0.0}}});
+    const Vector expected = {{1.0, 2.0, 3.0}, {-1.0, 0.5, 0.25}};
+    Vector x = D.mv(expected);
+
+    Opm::SegmentTreeSolver<double, blockSize> solver;
+    BOOST_CHECK(solver.analyze(D));
+    BOOST_CHECK(solver.factorize(D));
+    solver.solve(x);
+    for (std::size_t seg = 0; seg < D.N(); ++seg) {
+        for (int i = 0; i < blockSize; ++i) {
+            BOOST_CHECK_CLOSE(x[seg][i], expected[seg][i], 1e-10);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestFallbackCases)
+{
+    Opm::SegmentTreeSolver<double, blockSize> solver;
+
+    // Segments 1 and 2 both couple to 0 and to each other.
+    Matrix loop = makeWellMatrix({-1, 0, 0});
+    double value = 0.1;
+    loop.add(1, 2, makeBlock(value, 0.0));
+    BOOST_CHECK(!solver.analyze(loop));
+    BOOST_CHECK(!solver.pending());
+    BOOST_CHECK(!solver.factorize(loop));
+    solver.invalidate();
+    BOOST_CHECK(!solver.pending());
+
+    // A singular pivot block.
+    Matrix singular(1);
+    singular.add(0, 0, Block{{{1.0, 2.0, 0.0}, {2.0, 4.0, 0.0}, {0.0, 0.0, 1.0}}});
+    BOOST_CHECK(solver.analyze(singular));
+    BOOST_CHECK(!solver.factorize(singular));
+    BOOST_CHECK(!solver.factorized());
+    BOOST_CHECK(!solver.pending());
+}
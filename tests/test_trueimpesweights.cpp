@@ -0,0 +1,462 @@
+/*
+  Copyright 2022 Equinor ASA
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#define BOOST_TEST_MODULE TrueImpesWeightsTest
+#define BOOST_TEST_NO_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <opm/material/densead/Evaluation.hpp>
+#include <opm/simulators/linalg/getQuasiImpesWeights.hpp>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+constexpr int numEq = 3;
+constexpr int waterIdx = 0;
+constexpr int oilIdx = 1;
+constexpr int gasIdx = 2;
+
+using Evaluation = Opm::DenseAd::Evaluation<double, numEq>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, numEq>>;
+
+/// The parts of the black-oil intensive quantities used for the storage
+/// terms, with pressure, water and gas saturation as primary variables.
+struct IntensiveQuantities
+{
+    Evaluation saturation[numEq];
+    Evaluation invB[numEq];
+    Evaluation Rs;
+    Evaluation Rv;
+    Evaluation Rvw;
+    Evaluation poro;
+
+    explicit IntensiveQuantities(const std::size_t cell)
+    {
+        const double shift = 0.01 * cell;
+        const Evaluation p = Evaluation::createVariable(2.0e7 + 1.0e5 * cell, 0);
+        saturation[waterIdx] = Evaluation::createVariable(0.2 + shift, 1);
+        saturation[gasIdx] = Evaluation::createVariable(0.3 - shift, 2);
+        saturation[oilIdx] = 1.0 - saturation[waterIdx] - saturation[gasIdx];
+        invB[waterIdx] = 1.0 + 4.0e-10 * p;
+        invB[oilIdx] = 0.8 + 1.0e-9 * p;
+        invB[gasIdx] = 1.0e-5 * p;
+        Rs = 50.0 + 2.0e-6 * p;
+        Rv = 1.0e-4 + 1.0e-12 * p;
+        Rvw = 2.0e-5 + 3.0e-12 * p;
+        poro = 0.25 * (1.0 + 1.0e-9 * (p - 2.0e7));
+    }
+
+    const Evaluation& porosity() const
+    {
+        return poro;
+    }
+
+    double extrusionFactor() const
+    {
+        return 1.0;
+    }
+};
+
+/// Black-oil storage terms in surface volumes, optionally with water
+/// vaporized into the gas phase.
+template <bool enableVaporizedWater>
+struct LocalResidual
+{
+    template <class LhsEval>
+    static void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                               const IntensiveQuantities& intQuants)
+    {
+        const auto& phi = intQuants.porosity();
+        storage = 0.0;
+        for (int phase = 0; phase < numEq; ++phase) {
+            storage[phase] += phi * intQuants.saturation[phase] * intQuants.invB[phase];
+        }
+        const auto oil = phi * intQuants.saturation[oilIdx] * intQuants.invB[oilIdx];
+        const auto gas = phi * intQuants.saturation[gasIdx] * intQuants.invB[gasIdx];
+        storage[gasIdx] += oil * intQuants.Rs;
+        storage[oilIdx] += gas * intQuants.Rv;
+        if (enableVaporizedWater) {
+            storage[waterIdx] += gas * intQuants.Rvw;
+        }
+    }
+
+    template <class LhsEval, class ElementContext>
+    void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                        const ElementContext& elemCtx,
+                        unsigned dofIdx,
+                        unsigned timeIdx) const
+    {
+        computeStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx));
+    }
+
+    Dune::FieldVector<Evaluation, numEq> residual(unsigned) const
+    {
+        return {};
+    }
+};
+
+/// The cells with their cached intensive quantities and volumes.
+struct Cells
+{
+    std::vector<IntensiveQuantities> intQuants;
+    std::vector<double> volumes;
+    double dt = 86400.0;
+
+    explicit Cells(const std::size_t n)
+    {
+        for (std::size_t cell = 0; cell < n; ++cell) {
+            intQuants.emplace_back(cell);
+            volumes.push_back(1000.0 + 10.0 * cell);
+        }
+    }
+};
+
+// Element iteration and element context, as needed by getTrueImpesWeights().
+
+struct ElementIterator
+{
+    std::size_t element;
+
+    std::size_t operator*() const
+    {
+        return element;
+    }
+
+    ElementIterator& operator++()
+    {
+        ++element;
+        return *this;
+    }
+
+    bool operator!=(const ElementIterator& other) const
+    {
+        return element != other.element;
+    }
+};
+
+struct GridView
+{
+    std::size_t size;
+
+    template <int codim>
+    ElementIterator begin() const
+    {
+        return {0};
+    }
+
+    template <int codim>
+    ElementIterator end() const
+    {
+        return {size};
+    }
+};
+
+struct Simulator
+{
+    const Cells& cells;
+
+    double timeStepSize() const
+    {
+        return cells.dt;
+    }
+
+    const Simulator& vanguard() const
+    {
+        return *this;
+    }
+
+    const Simulator& grid() const
+    {
+        return *this;
+    }
+
+    Opm::Parallel::Communication comm() const
+    {
+        return Dune::MPIHelper::getCollectiveCommunication();
+    }
+};
+
+struct SubControlVolume
+{
+    double vol;
+
+    double volume() const
+    {
+        return vol;
+    }
+};
+
+struct Stencil
+{
+    double vol;
+
+    SubControlVolume subControlVolume(unsigned) const
+    {
+        return {vol};
+    }
+};
+
+struct ElementContext
+{
+    Simulator sim;
+    std::size_t cell = 0;
+
+    void updatePrimaryStencil(const std::size_t element)
+    {
+        cell = element;
+    }
+
+    void updatePrimaryIntensiveQuantities(unsigned)
+    {
+    }
+
+    const IntensiveQuantities& intensiveQuantities(unsigned, unsigned) const
+    {
+        return sim.cells.intQuants[cell];
+    }
+
+    Stencil stencil(unsigned) const
+    {
+        return {sim.cells.volumes[cell]};
+    }
+
+    const Simulator& simulator() const
+    {
+        return sim;
+    }
+};
+
+template <bool enableVaporizedWater>
+struct Model
+{
+    using Residual = LocalResidual<enableVaporizedWater>;
+
+    struct Jacobian
+    {
+        using MatrixBlock = Dune::FieldMatrix<double, numEq, numEq>;
+    };
+
+    struct Linearizer
+    {
+        Residual residual;
+        Jacobian matrix;
+
+        const Residual& localResidual() const
+        {
+            return residual;
+        }
+
+        const Jacobian& jacobian() const
+        {
+            return matrix;
+        }
+    };
+
+    const Cells& cells;
+    Linearizer lin;
+
+    const Linearizer& localLinearizer(std::size_t) const
+    {
+        return lin;
+    }
+
+    const Linearizer& linearizer() const
+    {
+        return lin;
+    }
+
+    const IntensiveQuantities* cachedIntensiveQuantities(const std::size_t cell, unsigned) const
+    {
+        return &cells.intQuants[cell];
+    }
+
+    double dofTotalVolume(const std::size_t cell) const
+    {
+        return cells.volumes[cell];
+    }
+};
+
+template <bool enableVaporizedWater>
+Vector checkCachedWeights(const Cells& cells)
+{
+    using Residual = LocalResidual<enableVaporizedWater>;
+    static_assert(Opm::Details::HasIntensiveQuantitiesStorage<Residual, IntensiveQuantities,
+                                                              Dune::FieldVector<Evaluation, numEq>>::value);
+    const std::size_t n = cells.volumes.size();
+    const Model<enableVaporizedWater> model{cells, {}};
+
+    // The weights evaluated on an element context.
+    Vector expected(n);
+    ElementContext elemCtx{Simulator{cells}};
+    Opm::Amg::getTrueImpesWeights(0, expected, GridView{n}, elemCtx, model, 0);
+
+    Vector weights(n);
+    Opm::Amg::getTrueImpesWeightsFromCache<Residual>(0, weights, model, cells.dt,
+                                                     Dune::MPIHelper::getCollectiveCommunication());
+    for (std::size_t cell = 0; cell < n; ++cell) {
+        for (int eq = 0; eq < numEq; ++eq) {
+            BOOST_CHECK_CLOSE(weights[cell][eq], expected[cell][eq], 1e-10);
+        }
+    }
+    return weights;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestCachedWeightsMatchElementContext)
+{
+    const Cells cells(10);
+    const Vector plain = checkCachedWeights<false>(cells);
+    const Vector vaporizedWater = checkCachedWeights<true>(cells);
+
+    // Vaporized water changes the weights, so both cases are checked.
+    Vector diff = vaporizedWater;
+    diff -= plain;
+    BOOST_CHECK_GT(diff.infinity_norm(), 1e-8 * plain.infinity_norm());
+}
+
+/// A model without cached intensive quantities for the last cell.
+struct PartlyCachedModel : Model<false>
+{
+    const IntensiveQuantities* cachedIntensiveQuantities(const std::size_t cell, unsigned timeIdx) const
+    {
+        return cell + 1 < cells.volumes.size() ? Model<false>::cachedIntensiveQuantities(cell, timeIdx) : nullptr;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(TestMissingCachedQuantitiesThrow)
+{
+    const Cells cells(10);
+    const PartlyCachedModel model{{cells, {}}};
+    Vector weights(cells.volumes.size());
+    BOOST_CHECK_THROW(Opm::Amg::getTrueImpesWeightsFromCache<LocalResidual<false>>(
+                          0, weights, model, cells.dt, Dune::MPIHelper::getCollectiveCommunication()),
+                      std::logic_error);
+}
+
+/// A local residual that can only evaluate the storage on an element context.
+struct ElementContextResidual
+{
+    template <class LhsEval, class ElementContext>
+    void computeStorage(Dune::FieldVector<LhsEval, numEq>&, const ElementContext&, unsigned, unsigned) const
+    {
+    }
+};
+
+BOOST_AUTO_TEST_CASE(TestStorageFromIntensiveQuantities)
+{
+    using Storage = Dune::FieldVector<Evaluation, numEq>;
+    BOOST_CHECK((Opm::Details::HasIntensiveQuantitiesStorage<LocalResidual<true>, IntensiveQuantities, Storage>::value));
+    BOOST_CHECK(!(Opm::Details::HasIntensiveQuantitiesStorage<ElementContextResidual, IntensiveQuantities, Storage>::value));
+}
+
+namespace
+{
+
+using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, numEq, numEq>>;
+
+/// A tridiagonal matrix, with an extra coupling of every row to the first
+/// row if requested, which moves the diagonal blocks within the rows.
+Matrix makeMatrix(const std::size_t n, const bool coupleFirstRow)
+{
+    Matrix A(n, n, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const std::size_t i = row.index();
+        if (coupleFirstRow) {
+            row.insert(0);
+        }
+        if (i > 0) {
+            row.insert(i - 1);
+        }
+        row.insert(i);
+        if (i + 1 < n) {
+            row.insert(i + 1);
+        }
+    }
+    double value = 0.3;
+    for (auto row = A.begin(); row != A.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col) {
+            for (int ii = 0; ii < numEq; ++ii) {
+                for (int jj = 0; jj < numEq; ++jj) {
+                    value = value * 1.37 - 0.61;
+                    if (value > 2.0 || value < -2.0) {
+                        value *= 0.1;
+                    }
+                    (*col)[ii][jj] = value + (ii == jj && col.index() == row.index() ? 5.0 : 0.0);
+                }
+            }
+        }
+    }
+    return A;
+}
+
+void checkQuasiImpesWeights(const Matrix& A, std::vector<std::size_t>& diagonalOffsets)
+{
+    Vector expected(A.N());
+    Opm::Amg::getQuasiImpesWeights(A, 1, false, expected);
+    Vector weights(A.N());
+    Opm::Amg::getQuasiImpesWeights(A, 1, false, weights, diagonalOffsets);
+    BOOST_REQUIRE_EQUAL(diagonalOffsets.size(), A.N());
+    for (std::size_t row = 0; row < A.N(); ++row) {
+        BOOST_CHECK_EQUAL(A[row].getindexptr()[diagonalOffsets[row]], row);
+        for (int eq = 0; eq < numEq; ++eq) {
+            BOOST_CHECK_EQUAL(weights[row][eq], expected[row][eq]);
+        }
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(TestQuasiImpesDiagonalOffsets)
+{
+    const std::size_t n = 8;
+    std::vector<std::size_t> diagonalOffsets;
+    const Matrix A = makeMatrix(n, false);
+    checkQuasiImpesWeights(A, diagonalOffsets);
+    checkQuasiImpesWeights(A, diagonalOffsets);
+
+    // A new pattern with the same number of rows needs a cleared cache.
+    const Matrix B = makeMatrix(n, true);
+    diagonalOffsets.clear();
+    checkQuasiImpesWeights(B, diagonalOffsets);
+}
+
+bool init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    return boost::unit_test::unit_test_main(&init_unit_test_func, argc, argv);
+}